@@ -0,0 +1,261 @@
+/*
+ * Operaciones atómicas de lectura-modificación-escritura sobre palabras
+ * de 32 bits compartidas entre main y las ISR, sin deshabilitar
+ * interrupciones.
+ *
+ * Con la extensión A de RISC-V (__riscv_atomic) cada operación es una
+ * sola instrucción AMO (amoor.w, amoand.w, amoxor.w, amoadd.w,
+ * amoswap.w): una ISR no puede caer entre la lectura y la escritura, y
+ * vale también entre harts. amo_assign32() usa un bucle lr.w/sc.w.
+ *
+ * Sin extensión A (AMO_ENABLE = 0) cada operación se hace con
+ * mstatus.MIE guardado y a 0 (AMO_IRQ_SAVE/AMO_IRQ_RESTORE), válido en
+ * un solo hart también desde una ISR. En el host se usan los __atomic de
+ * GCC (que hacen el papel de las AMO) o, con AMO_ENABLE = 0, la misma
+ * ruta de respaldo.
+ *
+ * Tipos de uso:
+ *  - amo_flag_t:  indicador 0/1 (set, clear, test, test-and-set/clear).
+ *  - amo_mask_t:  máscara de bits; cada lado cambia solo sus bits.
+ *  - amo_count_t: contador que incrementan varios contextos.
+ *
+ * AMO_HOOK() se ejecuta entre la carga y la escritura de la ruta de
+ * respaldo (y de la RMW ingenua de tools/amo_stress.c); por defecto no
+ * hace nada.
+ */
+#ifndef AMO_H
+#define AMO_H
+
+#include "riscv_types.h"
+
+#ifndef AMO_ENABLE
+#if !defined(__riscv) || defined(__riscv_atomic)
+#define AMO_ENABLE  (1)
+#else
+#define AMO_ENABLE  (0)
+#endif
+#endif
+
+#ifndef AMO_HOOK
+#define AMO_HOOK()  ((void)0)
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Primitivas                                                          */
+/* ------------------------------------------------------------------ */
+#if AMO_ENABLE && defined(__riscv)
+
+#define AMO_OP(name, insn)                                              \
+    static inline uint32_t name(volatile uint32_t *p, uint32_t v)       \
+    {                                                                   \
+        uint32_t old;                                                   \
+                                                                        \
+        __asm__ volatile (insn " %0, %2, %1"                            \
+                          : "=r"(old), "+A"(*p) : "r"(v) : "memory");   \
+        return old;                                                     \
+    }
+
+AMO_OP(amo_or32,   "amoor.w.aqrl")
+AMO_OP(amo_and32,  "amoand.w.aqrl")
+AMO_OP(amo_xor32,  "amoxor.w.aqrl")
+AMO_OP(amo_add32,  "amoadd.w.aqrl")
+AMO_OP(amo_swap32, "amoswap.w.aqrl")
+
+#undef AMO_OP
+
+/* *p = (*p & ~mask) | (bits & mask); devuelve el valor anterior. */
+static inline uint32_t amo_assign32(volatile uint32_t *p, uint32_t mask,
+                                    uint32_t bits)
+{
+    uint32_t old, tmp;
+
+    __asm__ volatile ("1: lr.w.aqrl %0, %2\n\t"
+                      "and  %1, %0, %3\n\t"
+                      "or   %1, %1, %4\n\t"
+                      "sc.w.aqrl %1, %1, %2\n\t"
+                      "bnez %1, 1b"
+                      : "=&r"(old), "=&r"(tmp), "+A"(*p)
+                      : "r"(~mask), "r"(bits & mask)
+                      : "memory");
+    return old;
+}
+
+#elif AMO_ENABLE
+
+#define AMO_OP(name, builtin)                                           \
+    static inline uint32_t name(volatile uint32_t *p, uint32_t v)       \
+    {                                                                   \
+        return builtin(p, v, __ATOMIC_SEQ_CST);                         \
+    }
+
+AMO_OP(amo_or32,   __atomic_fetch_or)
+AMO_OP(amo_and32,  __atomic_fetch_and)
+AMO_OP(amo_xor32,  __atomic_fetch_xor)
+AMO_OP(amo_add32,  __atomic_fetch_add)
+AMO_OP(amo_swap32, __atomic_exchange_n)
+
+#undef AMO_OP
+
+static inline uint32_t amo_assign32(volatile uint32_t *p, uint32_t mask,
+                                    uint32_t bits)
+{
+    uint32_t old = *p;
+
+    while (!__atomic_compare_exchange_n(p, &old,
+                                        (old & ~mask) | (bits & mask), 0,
+                                        __ATOMIC_SEQ_CST,
+                                        __ATOMIC_SEQ_CST)) {
+    }
+    return old;
+}
+
+#else /* !AMO_ENABLE: interrupciones paradas durante la RMW */
+
+#if defined(__riscv)
+
+static inline uint32_t amo_irq_save(void)
+{
+    uint32_t mstatus;
+
+    __asm__ volatile ("csrrci %0, mstatus, 8" : "=r"(mstatus) :: "memory");
+    return mstatus;
+}
+
+static inline void amo_irq_restore(uint32_t mstatus)
+{
+    __asm__ volatile ("csrs mstatus, %0" :: "r"(mstatus & 8u) : "memory");
+}
+
+#define AMO_IRQ_SAVE()      amo_irq_save()
+#define AMO_IRQ_RESTORE(s)  amo_irq_restore(s)
+
+#elif !defined(AMO_IRQ_SAVE)
+
+#define AMO_IRQ_SAVE()      (0u)
+#define AMO_IRQ_RESTORE(s)  ((void)(s))
+
+#endif
+
+#define AMO_OP(name, expr)                                              \
+    static inline uint32_t name(volatile uint32_t *p, uint32_t v)       \
+    {                                                                   \
+        uint32_t s = AMO_IRQ_SAVE();                                    \
+        uint32_t old = *p;                                              \
+                                                                        \
+        AMO_HOOK();                                                     \
+        *p = (expr);                                                    \
+        AMO_IRQ_RESTORE(s);                                             \
+        return old;                                                     \
+    }
+
+AMO_OP(amo_or32,   old | v)
+AMO_OP(amo_and32,  old & v)
+AMO_OP(amo_xor32,  old ^ v)
+AMO_OP(amo_add32,  old + v)
+AMO_OP(amo_swap32, v)
+
+#undef AMO_OP
+
+static inline uint32_t amo_assign32(volatile uint32_t *p, uint32_t mask,
+                                    uint32_t bits)
+{
+    uint32_t s = AMO_IRQ_SAVE();
+    uint32_t old = *p;
+
+    AMO_HOOK();
+    *p = (old & ~mask) | (bits & mask);
+    AMO_IRQ_RESTORE(s);
+    return old;
+}
+
+#endif /* AMO_ENABLE */
+
+/* ------------------------------------------------------------------ */
+/* Indicador                                                           */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    volatile uint32_t v;
+} amo_flag_t;
+
+static inline void amo_flag_set(amo_flag_t *f)
+{
+    (void)amo_swap32(&f->v, 1u);
+}
+
+static inline void amo_flag_clear(amo_flag_t *f)
+{
+    (void)amo_swap32(&f->v, 0u);
+}
+
+static inline uint8_t amo_flag_test(const amo_flag_t *f)
+{
+    return (uint8_t)(f->v != 0u);
+}
+
+/* Devuelven el valor anterior. */
+static inline uint8_t amo_flag_test_and_set(amo_flag_t *f)
+{
+    return (uint8_t)(amo_swap32(&f->v, 1u) != 0u);
+}
+
+static inline uint8_t amo_flag_test_and_clear(amo_flag_t *f)
+{
+    return (uint8_t)(amo_swap32(&f->v, 0u) != 0u);
+}
+
+/* ------------------------------------------------------------------ */
+/* Máscara de bits (devuelven el valor anterior)                       */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    volatile uint32_t v;
+} amo_mask_t;
+
+static inline uint32_t amo_mask_set(amo_mask_t *m, uint32_t bits)
+{
+    return amo_or32(&m->v, bits);
+}
+
+static inline uint32_t amo_mask_clear(amo_mask_t *m, uint32_t bits)
+{
+    return amo_and32(&m->v, ~bits);
+}
+
+static inline uint32_t amo_mask_toggle(amo_mask_t *m, uint32_t bits)
+{
+    return amo_xor32(&m->v, bits);
+}
+
+static inline uint32_t amo_mask_assign(amo_mask_t *m, uint32_t mask,
+                                       uint32_t bits)
+{
+    return amo_assign32(&m->v, mask, bits);
+}
+
+static inline uint32_t amo_mask_load(const amo_mask_t *m)
+{
+    return m->v;
+}
+
+/* ------------------------------------------------------------------ */
+/* Contador                                                            */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    volatile uint32_t v;
+} amo_count_t;
+
+static inline uint32_t amo_count_add(amo_count_t *c, uint32_t n)
+{
+    return amo_add32(&c->v, n);
+}
+
+static inline uint32_t amo_count_inc(amo_count_t *c)
+{
+    return amo_add32(&c->v, 1u);
+}
+
+static inline uint32_t amo_count_load(const amo_count_t *c)
+{
+    return c->v;
+}
+
+#endif /* AMO_H */
@@ -0,0 +1,181 @@
+/*
+ * Estado de medición de hasta 32 botones en estructura de arrays.
+ *
+ * Sustituye al array de btn_state_t { uint8_t waiting_release; uint64_t
+ * t_press; } (16 bytes por botón con el relleno de alineación a 8, en
+ * RV32 igual que en el host):
+ *  - Los indicadores van empaquetados en máscaras de 32 bits, un bit por
+ *    botón: 'waiting' (midiendo, botón pulsado) y 'sat' (instante de
+ *    pulsación perdido por desbordamiento, ver abajo).
+ *  - Los instantes de pulsación se guardan como desplazamientos de
+ *    BTNSTORE_TS_BITS bits (32 o 16), en unidades de 2^BTNSTORE_TS_SHIFT
+ *    ticks, desde una época común de 64 bits.
+ * Con 32 botones y desplazamientos de 32 bits ocupa 4,5 bytes por botón;
+ * de 16 bits, 2,5. Los desplazamientos de todos los botones caben en
+ * 2 (32 bits) o 1 (16 bits) líneas de caché de 64 bytes.
+ *
+ * Desbordamiento: la época solo se mueve en btnstore_press(), cuando el
+ * desplazamiento del instante actual no cabe en BTNSTORE_TS_BITS. Se
+ * adelanta hasta la pulsación en curso más antigua (o hasta ahora si no
+ * hay ninguna) y se restan los desplazamientos de las demás. La duración
+ * se calcula en 64 bits desde la época, así que un botón mantenido
+ * cualquier tiempo mide bien mientras nadie pulse otro. Solo si dos
+ * pulsaciones simultáneas están separadas más que el rango
+ * (BTNSTORE_TS_RANGE ticks) la más antigua se pega a la época nueva y se
+ * marca en 'sat': su duración pasa a ser una cota inferior.
+ *
+ * Rangos a 10 MHz: 32 bits y SHIFT 0, 429 s con resolución de 1 tick;
+ * 16 bits y SHIFT 10 (por defecto con 16), 6,7 s con 102,4 us.
+ *
+ * El número de botones (BTNSTORE_BUTTONS) fija el tamaño del array; las
+ * máscaras limitan a 32. Todo es inline: cada unidad de compilación lo
+ * configura con sus propias macros. No hay protección frente a ISR: se
+ * usa desde un solo contexto (las callbacks de debounce.h).
+ *
+ * Tamaño y coste por vuelta frente a btn_state_t: tools/btn_bench.c.
+ */
+#ifndef BTNSTORE_H
+#define BTNSTORE_H
+
+#include "riscv_types.h"
+
+#ifndef BTNSTORE_BUTTONS
+#define BTNSTORE_BUTTONS  (4u)
+#endif
+
+#ifndef BTNSTORE_TS_BITS
+#define BTNSTORE_TS_BITS  (32u)
+#endif
+
+#if BTNSTORE_BUTTONS < 1 || BTNSTORE_BUTTONS > 32
+#error "BTNSTORE_BUTTONS debe estar entre 1 y 32"
+#endif
+
+#if BTNSTORE_TS_BITS == 32
+typedef uint32_t btnstore_ts_t;
+#ifndef BTNSTORE_TS_SHIFT
+#define BTNSTORE_TS_SHIFT (0u)
+#endif
+#elif BTNSTORE_TS_BITS == 16
+typedef uint16_t btnstore_ts_t;
+#ifndef BTNSTORE_TS_SHIFT
+#define BTNSTORE_TS_SHIFT (10u)
+#endif
+#else
+#error "BTNSTORE_TS_BITS debe ser 32 o 16"
+#endif
+
+/* Mayor desplazamiento (en unidades) y rango en ticks. */
+#define BTNSTORE_TS_MAX   ((uint64_t)(btnstore_ts_t)~(btnstore_ts_t)0)
+#define BTNSTORE_TS_RANGE ((BTNSTORE_TS_MAX + 1u) << BTNSTORE_TS_SHIFT)
+
+typedef struct {
+    uint64_t      epoch;        /* Época común (ticks).                  */
+    uint32_t      waiting;      /* Bit i: botón i pulsado, midiendo.     */
+    uint32_t      sat;          /* Bit i: duración del botón i acotada.  */
+    btnstore_ts_t t[BTNSTORE_BUTTONS];  /* Pulsación - época (unidades). */
+} btnstore_t;
+
+static inline void btnstore_init(btnstore_t *s, uint64_t now)
+{
+    uint8_t i;
+
+    s->epoch = now;
+    s->waiting = 0u;
+    s->sat = 0u;
+    for (i = 0; i < BTNSTORE_BUTTONS; i++) {
+        s->t[i] = 0u;
+    }
+}
+
+/* Adelanta la época para que quepa el desplazamiento 'off' (unidades
+ * desde la época actual). Devuelve el desplazamiento desde la nueva. */
+static inline uint64_t btnstore_rebase(btnstore_t *s, uint64_t off)
+{
+    uint64_t shift = off;
+    uint32_t m;
+
+    /* Hasta la pulsación en curso más antigua... */
+    for (m = s->waiting; m != 0u; m &= m - 1u) {
+        uint8_t i = (uint8_t)__builtin_ctz(m);
+
+        if (s->t[i] < shift) {
+            shift = s->t[i];
+        }
+    }
+    /* ...salvo que el instante actual siga sin caber. */
+    if ((off - shift) > BTNSTORE_TS_MAX) {
+        shift = off - BTNSTORE_TS_MAX;
+    }
+    for (m = s->waiting; m != 0u; m &= m - 1u) {
+        uint8_t i = (uint8_t)__builtin_ctz(m);
+
+        if (s->t[i] < shift) {
+            s->t[i] = 0u;
+            s->sat |= 1UL << i;
+        } else {
+            s->t[i] = (btnstore_ts_t)(s->t[i] - shift);
+        }
+    }
+    s->epoch += shift << BTNSTORE_TS_SHIFT;
+    return off - shift;
+}
+
+/* Pulsación del botón i en el instante 'now' (>= época). */
+static inline void btnstore_press(btnstore_t *s, uint8_t i, uint64_t now)
+{
+    uint64_t off = (now - s->epoch) >> BTNSTORE_TS_SHIFT;
+
+    if (off > BTNSTORE_TS_MAX) {
+        off = btnstore_rebase(s, off);
+    }
+    s->t[i] = (btnstore_ts_t)off;
+    s->waiting |= 1UL << i;
+    s->sat &= ~(1UL << i);
+}
+
+static inline int btnstore_waiting(const btnstore_t *s, uint8_t i)
+{
+    return (s->waiting >> i) & 1u;
+}
+
+/* 1 si la duración del botón i es solo una cota inferior. */
+static inline int btnstore_saturated(const btnstore_t *s, uint8_t i)
+{
+    return (s->sat >> i) & 1u;
+}
+
+/* Ticks que lleva pulsado el botón i (truncado a la unidad). */
+static inline uint64_t btnstore_held(const btnstore_t *s, uint8_t i,
+                                     uint64_t now)
+{
+    return now - s->epoch - ((uint64_t)s->t[i] << BTNSTORE_TS_SHIFT);
+}
+
+/* Liberación del botón i: termina la medición y devuelve su duración. */
+static inline uint64_t btnstore_release(btnstore_t *s, uint8_t i,
+                                        uint64_t now)
+{
+    s->waiting &= ~(1UL << i);
+    return btnstore_held(s, i, now);
+}
+
+/* Máscara de botones pulsados desde hace al menos 'min' ticks. Recorre
+ * solo los bits de 'waiting'. */
+static inline uint32_t btnstore_held_mask(const btnstore_t *s,
+                                          uint64_t now, uint64_t min)
+{
+    uint32_t out = 0u;
+    uint32_t m;
+
+    for (m = s->waiting; m != 0u; m &= m - 1u) {
+        uint8_t i = (uint8_t)__builtin_ctz(m);
+
+        if (btnstore_held(s, i, now) >= min) {
+            out |= 1UL << i;
+        }
+    }
+    return out;
+}
+
+#endif /* BTNSTORE_H */
@@ -0,0 +1,309 @@
+#include "riscv_types.h"
+#include "riscv_uart.h"
+
+#include "console.h"
+#include "log.h"
+
+#if CONSOLE_ENABLE
+
+console_t console;
+
+/* Coste modelado (ver console.h): en el host lo cobra el simulador si
+ * está enlazado; en RISC-V no genera código. */
+#if defined(__riscv)
+#define CONSOLE_CPU(ticks)  ((void)0)
+#else
+void sim_cpu(uint32_t ticks) __attribute__((weak));
+
+#define CONSOLE_CPU(ticks)            \
+    do {                              \
+        if (sim_cpu != NULL) {        \
+            sim_cpu(ticks);           \
+        }                             \
+    } while (0)
+#endif
+
+/* Nombre, formato de la respuesta y rango (console.h) de cada
+ * parámetro. */
+static const struct {
+    const char *name;
+    uint8_t     log_id;
+    uint32_t    min;
+    uint32_t    max;
+} params[CONSOLE_N_PARAMS] = {
+    { "long_ms",     LOG_CON_LONG_MS,
+      CONSOLE_LONG_MS_MIN,     CONSOLE_LONG_MS_MAX },
+    { "blink_ms",    LOG_CON_BLINK_MS,
+      CONSOLE_BLINK_MS_MIN,    CONSOLE_BLINK_MS_MAX },
+    { "debounce_ms", LOG_CON_DEBOUNCE_MS,
+      CONSOLE_DEBOUNCE_MS_MIN, CONSOLE_DEBOUNCE_MS_MAX },
+};
+
+static const char *const cap_ops[] = { "start", "stop", "dump" };
+
+#define N_CAP_OPS  ((uint8_t)(sizeof cap_ops / sizeof cap_ops[0]))
+
+/* Igualdad de cadenas cortas (sin string.h en la placa). */
+static uint8_t word_is(const char *w, const char *s)
+{
+    while ((*w != '\0') && (*w == *s)) {
+        w++;
+        s++;
+    }
+    return (uint8_t)(*w == *s);
+}
+
+/* Decimal sin signo; devuelve 0 si no es un número que quepa. */
+static uint8_t word_u32(const char *w, uint32_t *v)
+{
+    uint32_t x = 0u;
+
+    if (*w == '\0') {
+        return 0u;
+    }
+    for (; *w != '\0'; w++) {
+        uint32_t d = (uint32_t)(*w - '0');
+
+        if ((d > 9u) || (x > (0xFFFFFFFFu - d) / 10u)) {
+            return 0u;
+        }
+        x = x * 10u + d;
+    }
+    *v = x;
+    return 1u;
+}
+
+/* Índice del parámetro de nombre w o CONSOLE_N_PARAMS. */
+static uint8_t find_param(const char *w)
+{
+    uint8_t p;
+
+    for (p = 0u; p < CONSOLE_N_PARAMS; p++) {
+        if (word_is(w, params[p].name)) {
+            break;
+        }
+    }
+    return p;
+}
+
+static void reply_param(uint8_t p)
+{
+    LOG1(params[p].log_id, *console.cfg->param[p]);
+}
+
+static uint8_t cmd_get(void)
+{
+    uint8_t p;
+
+    if (console.n_words == 1u) {
+        for (p = 0u; p < CONSOLE_N_PARAMS; p++) {
+            if (console.cfg->param[p] != NULL) {
+                reply_param(p);
+            }
+        }
+        return 0u;
+    }
+    p = find_param(console.word[1]);
+    if (p == CONSOLE_N_PARAMS) {
+        return CONSOLE_E_PARAM;
+    }
+    if (console.cfg->param[p] == NULL) {
+        return CONSOLE_E_NA;
+    }
+    reply_param(p);
+    return 0u;
+}
+
+static uint8_t cmd_set(void)
+{
+    uint32_t v;
+    uint8_t p;
+
+    if (console.n_words != 3u) {
+        return CONSOLE_E_CMD;
+    }
+    p = find_param(console.word[1]);
+    if (p == CONSOLE_N_PARAMS) {
+        return CONSOLE_E_PARAM;
+    }
+    if (console.cfg->param[p] == NULL) {
+        return CONSOLE_E_NA;
+    }
+    if (!word_u32(console.word[2], &v) ||
+        (v < params[p].min) || (v > params[p].max)) {
+        return CONSOLE_E_VALUE;
+    }
+    *console.cfg->param[p] = v;
+    if (console.cfg->changed != NULL) {
+        console.cfg->changed(p);
+    }
+    reply_param(p);
+    return 0u;
+}
+
+/* Orden sin argumentos resuelta por un gancho de la variante. */
+static uint8_t cmd_hook(void (*fn)(void))
+{
+    if (console.n_words != 1u) {
+        return CONSOLE_E_CMD;
+    }
+    if (fn == NULL) {
+        return CONSOLE_E_NA;
+    }
+    fn();
+    LOG0(LOG_CON_OK);
+    return 0u;
+}
+
+static uint8_t cmd_cap(void)
+{
+    uint8_t op;
+
+    if (console.n_words != 2u) {
+        return CONSOLE_E_CMD;
+    }
+    for (op = 0u; op < N_CAP_OPS; op++) {
+        if (word_is(console.word[1], cap_ops[op])) {
+            break;
+        }
+    }
+    if (op == N_CAP_OPS) {
+        return CONSOLE_E_CMD;
+    }
+    if (console.cfg->cap == NULL) {
+        return CONSOLE_E_NA;
+    }
+    console.cfg->cap(op);
+    LOG0(LOG_CON_OK);
+    return 0u;
+}
+
+/* Ejecuta la línea completa y prepara la siguiente. */
+static void console_exec(void)
+{
+    const char *w = console.word[0];
+    uint8_t err = console.err;
+
+    CONSOLE_CPU(CONSOLE_COST_CMD);
+    if (err == 0u) {
+        if (word_is(w, "get")) {
+            err = cmd_get();
+        } else if (word_is(w, "set")) {
+            err = cmd_set();
+        } else if (word_is(w, "stats")) {
+            err = cmd_hook(console.cfg->stats);
+        } else if (word_is(w, "reset")) {
+            err = cmd_hook(console.cfg->reset);
+        } else if (word_is(w, "cap")) {
+            err = cmd_cap();
+        } else {
+            err = CONSOLE_E_CMD;
+        }
+    }
+    if (err != 0u) {
+        LOG1(LOG_CON_ERR, err);
+    }
+    console.lines++;
+    console.n_words = 0u;
+    console.len = 0u;
+    console.err = 0u;
+    console.ready = 0u;
+}
+
+/* Añade un byte a la línea en curso. */
+static void console_byte(uint8_t c)
+{
+    if ((c == '\r') || (c == '\n')) {
+        if (console.len != 0u) {
+            console.n_words++;
+        }
+        /* Líneas vacías (p. ej. el '\n' de un "\r\n"): nada que hacer. */
+        console.ready = (uint8_t)((console.n_words != 0u) ||
+                                  (console.err != 0u));
+        console.len = 0u;
+        return;
+    }
+    if ((c == ' ') || (c == '\t')) {
+        if (console.len != 0u) {
+            console.n_words++;
+            console.len = 0u;
+        }
+        return;
+    }
+    if ((console.n_words >= CONSOLE_WORDS) ||
+        (console.len >= CONSOLE_WORD_MAX)) {
+        console.err = CONSOLE_E_LONG;
+        return;
+    }
+    console.word[console.n_words][console.len++] = (char)c;
+    console.word[console.n_words][console.len] = '\0';
+}
+
+void console_init(const console_cfg_t *cfg)
+{
+    console.cfg = cfg;
+    console.head = 0u;
+    console.tail = 0u;
+    console.overruns = 0u;
+    console.overruns_seen = 0u;
+    console.n_words = 0u;
+    console.len = 0u;
+    console.err = 0u;
+    console.ready = 0u;
+}
+
+void console_rx_isr(void)
+{
+    while (riscv_uart_rx_ready()) {
+        uint8_t c = riscv_uart_getc();
+        uint32_t head = console.head;
+
+        if ((head - console.tail) >= CONSOLE_RX_SIZE) {
+            console.overruns++;
+            continue;
+        }
+        console.rx[head & (CONSOLE_RX_SIZE - 1u)] = c;
+        __asm__ volatile ("" ::: "memory");
+        console.head = head + 1u;
+    }
+}
+
+void console_poll(void)
+{
+    uint32_t tail = console.tail;
+    uint32_t n = console.head - tail;
+
+    if (console.ready) {
+        console_exec();
+        return;
+    }
+    if (n == 0u) {
+        return;
+    }
+
+    /* Bytes perdidos: la línea en curso ya no vale. */
+    if (console.overruns != console.overruns_seen) {
+        console.overruns_seen = console.overruns;
+        console.err = CONSOLE_E_OVERRUN;
+    }
+
+    if (n > CONSOLE_POLL_BYTES) {
+        n = CONSOLE_POLL_BYTES;
+    }
+    __asm__ volatile ("" ::: "memory");
+    while (n != 0u) {
+        uint8_t c = console.rx[tail & (CONSOLE_RX_SIZE - 1u)];
+
+        tail++;
+        n--;
+        console_byte(c);
+        if (console.ready) {
+            break;
+        }
+    }
+    __asm__ volatile ("" ::: "memory");
+    CONSOLE_CPU(CONSOLE_COST_BYTE * (tail - console.tail));
+    console.tail = tail;
+}
+
+#endif /* CONSOLE_ENABLE */
@@ -0,0 +1,163 @@
+/*
+ * Consola de órdenes por la UART para ajustar parámetros en marcha.
+ *
+ * Recepción: console_rx_isr(), instalada como manejador de la IRQ de
+ * recepción de la UART (install_uart_rx_handler), copia los bytes a una
+ * cola circular de CONSOLE_RX_SIZE bytes (un productor, la ISR, y un
+ * consumidor, main); si no caben se cuentan como perdidos.
+ *
+ * Proceso: CONSOLE_POLL(), en cada vuelta del bucle principal (o en la
+ * tarea del log), hace una de dos cosas, nunca las dos:
+ *  - ejecuta la orden completada en la pasada anterior, o
+ *  - consume como mucho CONSOLE_POLL_BYTES bytes de la cola, partiendo
+ *    la línea en palabras sobre la marcha.
+ * El coste por pasada está acotado: CONSOLE_POLL_BYTES bytes o una
+ * orden (unas comparaciones de palabras de CONSOLE_WORD_MAX caracteres
+ * como mucho y el gancho de la variante). Sin bytes pendientes son dos
+ * lecturas de RAM. Las respuestas van por el registro diferido (log.h),
+ * así que tampoco esperan a la UART.
+ *
+ * Órdenes (una por línea, terminada en '\r' o '\n'):
+ *   get [parámetro]              valor de uno o de todos
+ *   set <parámetro> <valor>      cambia el valor (decimal, en ms)
+ *   stats                        volcado de estadísticas
+ *   reset                        pone a cero los contadores
+ *   cap start | stop | dump      analizador lógico (lacap.h)
+ * Parámetros: long_ms (umbral de pulsación larga), blink_ms (intervalo
+ * entre conmutaciones del parpadeo) y debounce_ms (ventana de
+ * antirrebote). Cada variante indica cuáles tiene y qué hacer con stats,
+ * reset y cap; el resto responde CONSOLE_E_NA. Un valor nuevo se aplica
+ * a partir del siguiente plazo que lo use.
+ *
+ * Respuestas: LOG_CON_<PARÁMETRO> con el valor (get y set), LOG_CON_OK
+ * o LOG_CON_ERR con uno de los códigos CONSOLE_E_*.
+ *
+ * Con CONSOLE_ENABLE = 0 (por defecto) las macros no generan código.
+ *
+ * En el simulador, sim_main.c -c inyecta líneas en la recepción y el
+ * trabajo de la consola cobra CONSOLE_COST_* ticks de reloj virtual
+ * (estimación de sus ciclos de CPU) para medir su efecto en el periodo
+ * del bucle.
+ */
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "riscv_types.h"
+
+#ifndef CONSOLE_ENABLE
+#define CONSOLE_ENABLE      (0)
+#endif
+
+/* Bytes de la cola de recepción: potencia de 2. */
+#ifndef CONSOLE_RX_SIZE
+#define CONSOLE_RX_SIZE     (64u)
+#endif
+
+#if (CONSOLE_RX_SIZE & (CONSOLE_RX_SIZE - 1u)) != 0
+#error "CONSOLE_RX_SIZE debe ser potencia de 2"
+#endif
+
+/* Bytes consumidos como mucho por pasada. */
+#ifndef CONSOLE_POLL_BYTES
+#define CONSOLE_POLL_BYTES  (4u)
+#endif
+
+/* Caracteres por palabra (los que sobran dan CONSOLE_E_LONG). */
+#define CONSOLE_WORD_MAX    (12u)
+#define CONSOLE_WORDS       (3u)
+
+/* Coste modelado en el simulador (ticks de 100 ns, ~5 ciclos cada uno):
+ * por byte consumido y por orden ejecutada. */
+#define CONSOLE_COST_BYTE   (2u)
+#define CONSOLE_COST_CMD    (40u)
+
+/* Parámetros ajustables. */
+enum {
+    CONSOLE_P_LONG_MS,
+    CONSOLE_P_BLINK_MS,
+    CONSOLE_P_DEBOUNCE_MS,
+    CONSOLE_N_PARAMS
+};
+
+/* Rango de cada parámetro (ms, ambos incluidos): set rechaza lo demás
+ * con CONSOLE_E_VALUE, así que una variante nunca ve un 0 ni un valor
+ * mayor que el máximo. Quien escale el valor en 32 bits debe comprobar
+ * con #error que el máximo escalado cabe. */
+#define CONSOLE_LONG_MS_MIN       (50u)
+#define CONSOLE_LONG_MS_MAX       (60000u)
+#define CONSOLE_BLINK_MS_MIN      (10u)
+#define CONSOLE_BLINK_MS_MAX      (10000u)
+#define CONSOLE_DEBOUNCE_MS_MIN   (1u)
+#define CONSOLE_DEBOUNCE_MS_MAX   (500u)
+
+/* Códigos de error (LOG_CON_ERR). */
+enum {
+    CONSOLE_E_CMD = 1,          /* Orden desconocida.                    */
+    CONSOLE_E_PARAM,            /* Parámetro desconocido.                */
+    CONSOLE_E_VALUE,            /* Valor no numérico o fuera de rango.   */
+    CONSOLE_E_NA,               /* No disponible en esta variante.       */
+    CONSOLE_E_LONG,             /* Palabra o línea demasiado larga.      */
+    CONSOLE_E_OVERRUN           /* Bytes perdidos en la recepción.       */
+};
+
+/* Órdenes de cap. */
+enum { CONSOLE_CAP_START, CONSOLE_CAP_STOP, CONSOLE_CAP_DUMP };
+
+typedef struct {
+    /* Valor de cada parámetro (NULL: no lo tiene la variante); volatile
+     * porque la variante puede leerlo también desde una ISR. */
+    volatile uint32_t *param[CONSOLE_N_PARAMS];
+    /* Aviso tras un set correcto (puede ser NULL). */
+    void    (*changed)(uint8_t p);
+    /* stats, reset y cap (NULL: CONSOLE_E_NA). */
+    void    (*stats)(void);
+    void    (*reset)(void);
+    void    (*cap)(uint8_t op);
+} console_cfg_t;
+
+typedef struct {
+    uint8_t           rx[CONSOLE_RX_SIZE];
+    volatile uint32_t head;       /* Lo escribe console_rx_isr().       */
+    volatile uint32_t tail;       /* Lo escribe console_poll().         */
+    volatile uint32_t overruns;   /* Bytes perdidos (total).            */
+    uint32_t          overruns_seen;
+    char              word[CONSOLE_WORDS][CONSOLE_WORD_MAX + 1u];
+    uint8_t           n_words;
+    uint8_t           len;        /* Caracteres de la palabra en curso. */
+    uint8_t           err;        /* Error de la línea en curso.        */
+    uint8_t           ready;      /* Línea completa por ejecutar.       */
+    uint32_t          lines;      /* Órdenes ejecutadas.                */
+    const console_cfg_t *cfg;
+} console_t;
+
+extern console_t console;
+
+#if CONSOLE_ENABLE
+
+/* Registra la configuración de la variante (antes de habilitar la IRQ
+ * de recepción). */
+void console_init(const console_cfg_t *cfg);
+
+/* Manejador de la IRQ de recepción de la UART. */
+void console_rx_isr(void);
+
+/* Una pasada acotada (ver arriba). */
+void console_poll(void);
+
+/* 1 si quedan bytes u órdenes por procesar (para no dormir con WFI). */
+static inline uint8_t console_busy(void)
+{
+    return (uint8_t)((console.head != console.tail) || console.ready);
+}
+
+#define CONSOLE_POLL()  console_poll()
+#define CONSOLE_BUSY()  console_busy()
+
+#else /* !CONSOLE_ENABLE */
+
+#define CONSOLE_POLL()  ((void)0)
+#define CONSOLE_BUSY()  (0u)
+
+#endif /* CONSOLE_ENABLE */
+
+#endif /* CONSOLE_H */
@@ -0,0 +1,124 @@
+/*
+ * Planificador cooperativo con plazos (EDF), de ejecución hasta el final.
+ *
+ * Cada tarea registrada tiene una función, un plazo relativo y:
+ *  - un periodo (tarea periódica: se activa en una rejilla fija
+ *    first, first + periodo, ...; sched_start/sched_stop la arrancan o
+ *    la paran), o
+ *  - periodo 0 (tarea por evento: se activa con sched_trigger(), que
+ *    también vale desde una ISR, o una vez en el instante que se pase
+ *    a sched_start()).
+ *
+ * sched_run() hace una pasada: lee mtime, activa lo que toca y ejecuta
+ * un solo trabajo, el de plazo absoluto más cercano (a igualdad, la
+ * tarea registrada antes). La cola de listas es un montículo binario de
+ * tamaño fijo (SCHED_MAX_TASKS), O(log n) por operación. Ninguna tarea
+ * se interrumpe: el peor caso de respuesta de una tarea es su propia
+ * ejecución más la del trabajo más largo de las demás, no la suma de
+ * todas como en un super-bucle.
+ *
+ * Estadísticas por tarea, en ticks: ejecuciones, tiempo de ejecución
+ * (máximo y suma), respuesta máxima (fin - activación), solapes (la
+ * tarea se activa con el trabajo anterior aún pendiente) y plazos
+ * vencidos. sched_account() anota del mismo modo un trabajo ejecutado
+ * fuera del planificador (p. ej. el muestreo de un super-bucle) para
+ * comparar.
+ *
+ * Todo salvo sched_trigger() se llama desde main.
+ */
+#ifndef COOP_SCHED_H
+#define COOP_SCHED_H
+
+#include "riscv_types.h"
+#include "amo.h"
+
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS  (8u)
+#endif
+
+#if SCHED_MAX_TASKS > 32u
+#error "SCHED_MAX_TASKS: como mucho 32 (máscara de activaciones)"
+#endif
+
+/* Sin activación programada. */
+#define SCHED_NEVER  (~(uint64_t)0)
+
+/* Función de una tarea; 'now' es el instante de inicio del trabajo. */
+typedef void (*sched_fn_t)(uint64_t now);
+
+typedef struct {
+    uint32_t runs;
+    uint32_t run_max;
+    uint64_t run_sum;
+    uint32_t resp_max;          /* Fin - activación.                     */
+    uint32_t overruns;
+    uint32_t misses;
+} sched_stat_t;
+
+typedef struct {
+    const char  *name;
+    sched_fn_t   fn;
+    uint32_t     period;        /* 0: por evento.                        */
+    uint32_t     deadline;      /* Plazo relativo a la activación.       */
+    uint64_t     next;          /* Próxima activación periódica.         */
+    uint64_t     release;       /* Activación del trabajo pendiente.     */
+    uint64_t     due;           /* Su plazo absoluto.                    */
+    uint8_t      queued;
+    sched_stat_t st;
+} sched_task_t;
+
+typedef struct {
+    sched_task_t task[SCHED_MAX_TASKS];
+    uint8_t      n_tasks;
+    uint8_t      heap[SCHED_MAX_TASKS];  /* Índices, por plazo.         */
+    uint8_t      n_ready;
+    uint64_t     next;          /* Mínimo de task[].next.                */
+    amo_mask_t   trig;          /* Activaciones por evento pendientes.   */
+} sched_t;
+
+extern sched_t sched;
+
+void sched_init(void);
+
+/* Registra una tarea (parada) y devuelve su índice. Con las
+ * SCHED_MAX_TASKS ya ocupadas, detiene el programa (__builtin_trap). */
+uint8_t sched_add(const char *name, sched_fn_t fn, uint32_t period,
+                  uint32_t deadline);
+
+/* Primera activación en 'first' (en una tarea por evento, la única). */
+void sched_start(uint8_t id, uint64_t first);
+void sched_stop(uint8_t id);
+
+/* Cambia el periodo de una tarea periódica; vale desde la activación
+ * siguiente a la ya programada. */
+static inline void sched_set_period(uint8_t id, uint32_t period)
+{
+    sched.task[id].period = period;
+}
+
+/* Tarea por evento: activación en la próxima pasada. */
+static inline void sched_trigger(uint8_t id)
+{
+    (void)amo_mask_set(&sched.trig, 1u << id);
+}
+
+/* Una pasada; devuelve 0 si no había nada que ejecutar. */
+uint8_t sched_run(void);
+
+/* Anota un trabajo de la tarea 'id' ejecutado fuera de sched_run(),
+ * activado en 'release', iniciado en 'start' y terminado ahora. */
+void sched_account(uint8_t id, uint64_t release, uint64_t start);
+
+static inline const sched_stat_t *sched_stat(uint8_t id)
+{
+    return &sched.task[id].st;
+}
+
+/* Pone a cero las estadísticas de todas las tareas. */
+void sched_reset_stats(void);
+
+/* Emite las estadísticas por el registro diferido (log.h): dos
+ * registros por tarea (LOG_SCHED_TASK y LOG_SCHED_MISS). */
+void sched_log_stats(void);
+
+#endif /* COOP_SCHED_H */
@@ -0,0 +1,37 @@
+/*
+ * Contador de ciclos del núcleo para medir duraciones cortas (ISR, ...).
+ * En RISC-V se lee el CSR cycle; en el host (sim/) se deriva del reloj
+ * virtual suponiendo un núcleo a CPU_CLOCK.
+ */
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include "riscv_types.h"
+
+#ifndef CPU_CLOCK
+#define CPU_CLOCK  (50000000u)                /* 50 MHz                  */
+#endif
+
+#if defined(__riscv)
+
+static inline uint32_t cycles_now(void)
+{
+    uint32_t c;
+
+    __asm__ volatile ("rdcycle %0" : "=r"(c));
+    return c;
+}
+
+#else
+
+#include "clinc.h"
+#include "riscv_monotonic_clock.h"
+
+static inline uint32_t cycles_now(void)
+{
+    return (uint32_t)(get_ticks_from_reset() * (CPU_CLOCK / CLINT_CLOCK));
+}
+
+#endif
+
+#endif /* CYCLES_H */
@@ -0,0 +1,44 @@
+#include "riscv_types.h"
+
+#include "debounce.h"
+
+void debounce_init(debounce_t *d, uint32_t raw)
+{
+    uint8_t i;
+
+    d->cnt0 = 0u;
+    d->cnt1 = 0u;
+    d->state = raw;
+    d->rise = 0u;
+    d->fall = 0u;
+    d->cb_mask = 0u;
+    for (i = 0u; i < 32u; i++) {
+        d->cb[i] = NULL;
+    }
+}
+
+void debounce_set_callback(debounce_t *d, uint8_t pin, debounce_cb_t cb)
+{
+    if (pin >= 32u) {
+        return;
+    }
+    d->cb[pin] = cb;
+    if (cb != NULL) {
+        d->cb_mask |= (1u << pin);
+    } else {
+        d->cb_mask &= ~(1u << pin);
+    }
+}
+
+void debounce_dispatch(const debounce_t *d)
+{
+    uint32_t pending = (d->rise | d->fall) & d->cb_mask;
+
+    while (pending != 0u) {
+        uint8_t pin = (uint8_t)__builtin_ctz(pending);
+
+        pending &= pending - 1u;
+        d->cb[pin](pin, (((d->rise >> pin) & 1u) != 0u) ? DEBOUNCE_RISE
+                                                        : DEBOUNCE_FALL);
+    }
+}
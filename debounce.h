@@ -0,0 +1,69 @@
+/*
+ * Antirrebote de las 32 entradas del puerto a la vez con contadores
+ * verticales de 2 bits.
+ *
+ * Cada bit del puerto tiene un contador de 2 bits repartido entre las
+ * palabras cnt0 (bit bajo) y cnt1 (bit alto). Mientras la muestra de un
+ * pin difiere de su estado estable el contador avanza; si coincide, se
+ * pone a 0. Al cumplirse DEBOUNCE_SAMPLES muestras seguidas distintas, el
+ * estado estable cambia. Todo son operaciones lógicas sobre la palabra
+ * de 32 bits: el coste por muestra es el mismo con 2 que con 32 botones.
+ *
+ * debounce_sample() debe llamarse con periodo fijo; la ventana de
+ * antirrebote es DEBOUNCE_SAMPLES periodos.
+ */
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include "riscv_types.h"
+
+#define DEBOUNCE_SAMPLES  (4u)
+
+/* Tipo de flanco entregado a las callbacks. */
+#define DEBOUNCE_FALL     (0u)
+#define DEBOUNCE_RISE     (1u)
+
+/* Callback por pin: pin = número de bit (0-31). */
+typedef void (*debounce_cb_t)(uint8_t pin, uint8_t edge);
+
+typedef struct {
+    uint32_t      cnt0;         /* Bit 0 de los contadores verticales.   */
+    uint32_t      cnt1;         /* Bit 1 de los contadores verticales.   */
+    uint32_t      state;        /* Estado estable (filtrado).            */
+    uint32_t      rise;         /* Flancos de subida de la última muestra. */
+    uint32_t      fall;         /* Flancos de bajada de la última muestra. */
+    uint32_t      cb_mask;      /* Pines con callback registrada.        */
+    debounce_cb_t cb[32];
+} debounce_t;
+
+/* Estado inicial = 'raw' (sin flancos pendientes). */
+void debounce_init(debounce_t *d, uint32_t raw);
+
+/* Registra cb para el pin (NULL la elimina). */
+void debounce_set_callback(debounce_t *d, uint8_t pin, debounce_cb_t cb);
+
+/* Procesa una muestra del puerto. Devuelve la máscara de pines que han
+ * cambiado de estado estable (rise | fall). */
+static inline uint32_t debounce_sample(debounce_t *d, uint32_t raw)
+{
+    uint32_t delta = raw ^ d->state;
+    uint32_t toggle;
+
+    /* Cuenta 0 -> 1 -> 2 -> 3 -> 0 donde delta = 1; a 0 donde no. */
+    d->cnt1 = (d->cnt1 ^ d->cnt0) & delta;
+    d->cnt0 = ~d->cnt0 & delta;
+
+    /* Vuelta completa: DEBOUNCE_SAMPLES muestras distintas seguidas. */
+    toggle = delta & ~(d->cnt0 | d->cnt1);
+    d->state ^= toggle;
+
+    d->rise = toggle & d->state;
+    d->fall = toggle & ~d->state;
+    return toggle;
+}
+
+/* Llama a la callback de cada pin con flanco en la última muestra,
+ * recorriendo solo los bits activos (count-trailing-zeros). */
+void debounce_dispatch(const debounce_t *d);
+
+#endif /* DEBOUNCE_H */
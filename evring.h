@@ -0,0 +1,110 @@
+/*
+ * Cola circular sin bloqueos de un productor y un consumidor (SPSC) para
+ * pasar eventos de botón de una ISR al bucle principal.
+ *
+ *  - Productor (ISR): evring_push(). Solo escribe 'head'.
+ *  - Consumidor (main): evring_pop(). Solo escribe 'tail'.
+ *  - Si la cola está llena, el evento nuevo se descarta y se cuenta en
+ *    'overflows'; 'hwm' guarda la máxima ocupación observada.
+ *
+ * Ningún lado deshabilita interrupciones. Las barreras ordenan la
+ * escritura del hueco antes de publicar 'head' y la lectura del hueco
+ * antes de liberar 'tail' (necesarias si productor y consumidor están en
+ * harts distintos; en un solo núcleo bastaría con la barrera de
+ * compilador que también aportan).
+ */
+#ifndef EVRING_H
+#define EVRING_H
+
+#include "riscv_types.h"
+
+/* Número de huecos: potencia de 2. */
+#ifndef EVRING_SIZE
+#define EVRING_SIZE   (16u)
+#endif
+
+#if (EVRING_SIZE & (EVRING_SIZE - 1u)) != 0
+#error "EVRING_SIZE debe ser potencia de 2"
+#endif
+
+#if defined(__riscv)
+#define EVRING_FENCE_W()  __asm__ volatile ("fence w,w" ::: "memory")
+#define EVRING_FENCE_R()  __asm__ volatile ("fence r,r" ::: "memory")
+#define EVRING_FENCE_RW() __asm__ volatile ("fence r,w" ::: "memory")
+#else
+#define EVRING_FENCE_W()  __atomic_thread_fence(__ATOMIC_RELEASE)
+#define EVRING_FENCE_R()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define EVRING_FENCE_RW() __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+/* Tipo de flanco. */
+#define BTN_EDGE_RELEASE  (0u)
+#define BTN_EDGE_PRESS    (1u)
+
+/* Evento de botón (16 bytes). */
+typedef struct {
+    uint64_t tick;     /* Instante del flanco (ticks de 10 MHz).         */
+    uint8_t  btn;      /* Número de botón (0 = PBT_0, ...).              */
+    uint8_t  edge;     /* BTN_EDGE_PRESS o BTN_EDGE_RELEASE.             */
+} btn_event_t;
+
+typedef struct {
+    btn_event_t       buf[EVRING_SIZE];
+    volatile uint32_t head;       /* Siguiente hueco a escribir.         */
+    volatile uint32_t tail;       /* Siguiente hueco a leer.             */
+    volatile uint32_t overflows;  /* Eventos descartados por cola llena. */
+    volatile uint32_t hwm;        /* Máxima ocupación observada.         */
+} evring_t;
+
+static inline void evring_init(evring_t *r)
+{
+    r->head = 0u;
+    r->tail = 0u;
+    r->overflows = 0u;
+    r->hwm = 0u;
+}
+
+/* Productor: encola *ev. Devuelve 0 si la cola estaba llena. */
+static inline int evring_push(evring_t *r, const btn_event_t *ev)
+{
+    uint32_t head = r->head;
+    uint32_t used = head - r->tail;
+
+    if (used >= EVRING_SIZE) {
+        r->overflows++;
+        return 0;
+    }
+
+    r->buf[head & (EVRING_SIZE - 1u)] = *ev;
+    EVRING_FENCE_W();
+    r->head = head + 1u;
+
+    if (used + 1u > r->hwm) {
+        r->hwm = used + 1u;
+    }
+    return 1;
+}
+
+/* Consumidor: desencola en *ev. Devuelve 0 si la cola estaba vacía. */
+static inline int evring_pop(evring_t *r, btn_event_t *ev)
+{
+    uint32_t tail = r->tail;
+
+    if (tail == r->head) {
+        return 0;
+    }
+
+    EVRING_FENCE_R();
+    *ev = r->buf[tail & (EVRING_SIZE - 1u)];
+    EVRING_FENCE_RW();
+    r->tail = tail + 1u;
+    return 1;
+}
+
+/* Consumidor: 1 si no hay nada que desencolar. */
+static inline int evring_empty(const evring_t *r)
+{
+    return r->tail == r->head;
+}
+
+#endif /* EVRING_H */
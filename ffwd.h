@@ -0,0 +1,61 @@
+/*
+ * Avisos para el avance rápido del simulador (sim/, opción -x).
+ *
+ * Con -x el simulador no hace girar un bucle que solo espera: salta el
+ * reloj virtual hasta el próximo suceso (cambio de entrada, plazo del
+ * timer, fin del carácter en la UART o un plazo anunciado aquí). Para
+ * saber hasta dónde puede saltar, los módulos con estado que depende del
+ * tiempo lo anuncian:
+ *
+ *   FFWD_DUE(key, t)  el módulo 'key' tiene su próximo plazo en t
+ *                     (~0: ninguno). Se llama cuando el plazo cambia;
+ *                     el simulador guarda el último de cada módulo.
+ *   FFWD_IDLE(t)      el bucle no tiene nada que hacer hasta t salvo
+ *                     una entrada o una IRQ (sched_run() sin trabajos
+ *                     listos, con un bucle que solo llama a sched_run()).
+ *
+ * Con FFWD_IDLE el simulador solo salta ahí, nunca en medio de un
+ * trabajo. Un super-bucle (sin FFWD_IDLE) se salta si algún módulo ha
+ * anunciado plazo y dos vueltas seguidas no han tenido ningún efecto (ni
+ * escrituras, ni UART, ni IRQ, ni cambios de entrada); se supone que el
+ * bucle solo depende del tiempo a través de esos módulos.
+ *
+ * En RISC-V no generan código. En el host son llamadas a funciones
+ * débiles de sim_hal.c: sin el simulador enlazado (p. ej. en
+ * tools/fsm_bench.c) no hacen nada.
+ */
+#ifndef FFWD_H
+#define FFWD_H
+
+#include "riscv_types.h"
+
+#if defined(__riscv)
+
+#define FFWD_DUE(key, t)  ((void)0)
+#define FFWD_IDLE(t)      ((void)0)
+
+#else /* host */
+
+void sim_ffwd_due(const void *key, uint64_t t) __attribute__((weak));
+void sim_ffwd_idle(uint64_t t) __attribute__((weak));
+
+static inline void ffwd_due(const void *key, uint64_t t)
+{
+    if (sim_ffwd_due != NULL) {
+        sim_ffwd_due(key, t);
+    }
+}
+
+static inline void ffwd_idle(uint64_t t)
+{
+    if (sim_ffwd_idle != NULL) {
+        sim_ffwd_idle(t);
+    }
+}
+
+#define FFWD_DUE(key, t)  ffwd_due((key), (t))
+#define FFWD_IDLE(t)      ffwd_idle(t)
+
+#endif
+
+#endif /* FFWD_H */
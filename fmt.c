@@ -0,0 +1,102 @@
+#include "riscv_types.h"
+
+#include "fmt.h"
+#include "time_conv.h"
+
+#define E9  (1000000000u)
+
+/* v / 10 exacto para todo v de 32 bits: ceil(2^35 / 10) = 0xCCCCCCCD. */
+static inline uint32_t div10(uint32_t v)
+{
+    return (uint32_t)(((uint64_t)v * 0xCCCCCCCDu) >> 35);
+}
+
+/* Escribe los n dígitos menos significativos de v (con ceros a la
+ * izquierda) de derecha a izquierda, terminando en p + n. */
+static char *fmt_digits(char *p, uint32_t v, uint8_t n)
+{
+    char *end = p + n;
+
+    while (n-- > 0u) {
+        uint32_t q = div10(v);
+
+        p[n] = (char)('0' + (v - q * 10u));
+        v = q;
+    }
+    return end;
+}
+
+/* Número de dígitos de v (al menos 1), solo con comparaciones. */
+static uint8_t n_digits(uint32_t v)
+{
+    static const uint32_t pow10[9] = {
+        10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u,
+        100000000u, 1000000000u
+    };
+    uint8_t n = 1u;
+
+    while ((n < 10u) && (v >= pow10[n - 1u])) {
+        n++;
+    }
+    return n;
+}
+
+char *fmt_u32(char *p, uint32_t v)
+{
+    return fmt_digits(p, v, n_digits(v));
+}
+
+char *fmt_u64(char *p, uint64_t v)
+{
+    uint64_t hi;
+    uint32_t mid, lo;
+
+    if ((v >> 32) == 0u) {
+        return fmt_u32(p, (uint32_t)v);
+    }
+
+    /* v = (hi * 10^9 + mid) * 10^9 + lo, con hi <= 18. */
+    hi = TC_DIV(v, E9);
+    lo = (uint32_t)(v - hi * E9);
+    if ((hi >> 32) == 0u) {
+        p = fmt_u32(p, (uint32_t)hi);
+    } else {
+        uint64_t top = TC_DIV(hi, E9);
+
+        mid = (uint32_t)(hi - top * E9);
+        p = fmt_u32(p, (uint32_t)top);
+        p = fmt_digits(p, mid, 9u);
+    }
+    return fmt_digits(p, lo, 9u);
+}
+
+char *fmt_str(char *p, const char *s)
+{
+    while (*s != '\0') {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+char *fmt_line(char *p, size_t size, const char *fmt,
+               uint32_t a0, uint32_t a1)
+{
+    char *end = p + size;
+    uint8_t k = 0u;
+
+    while ((*fmt != '\0') && (p < end)) {
+        if ((fmt[0] == '%') && (fmt[1] == 'u')) {
+            if ((size_t)(end - p) < FMT_U32_MAX_LEN) {
+                break;
+            }
+            p = fmt_u32(p, (k++ == 0u) ? a0 : a1);
+            fmt += 2;
+        } else if ((fmt[0] == '%') && (fmt[1] == '%')) {
+            *p++ = '%';
+            fmt += 2;
+        } else {
+            *p++ = *fmt++;
+        }
+    }
+    return p;
+}
@@ -0,0 +1,72 @@
+/*
+ * Formateo de enteros sin printf ni división.
+ *
+ * printf("... %u ms\n", ms) arrastra vfprintf de newlib (varios KB de
+ * flash) y analiza el formato en cada llamada. Aquí:
+ *
+ *  - fmt_u32(): dígitos decimales de un uint32_t con q = v / 10 como
+ *    multiplicación por el recíproco, q = (v * 0xCCCCCCCD) >> 35 (un
+ *    mul/mulhu en RV32, exacto para todo v de 32 bits);
+ *  - fmt_u64(): corta el valor en trozos de 10^9 con TC_DIV de
+ *    time_conv.h (multiplicación alta, sin __udivdi3/__umoddi3) y
+ *    escribe cada trozo con fmt_u32();
+ *  - fmt_line(): expande un formato de log_fmt.h con dos argumentos.
+ *    Solo entiende "%u" y "%%": lo demás se copia tal cual. Que los
+ *    formatos no piden otra cosa se comprueba al compilar
+ *    (FMT_CHECK_FORMATS en log.c).
+ *
+ * Todas escriben en p, sin '\0', y devuelven el puntero al final: se
+ * encadenan directamente sobre el búfer de transmisión de la UART.
+ *
+ * Comparación con printf (tamaño y coste por llamada): tools/fmt_bench.c.
+ */
+#ifndef FMT_H
+#define FMT_H
+
+#include "riscv_types.h"
+
+#define FMT_U32_MAX_LEN  (10u)
+#define FMT_U64_MAX_LEN  (20u)
+
+char *fmt_u32(char *p, uint32_t v);
+char *fmt_u64(char *p, uint64_t v);
+
+/* Copia s sin el '\0' final. */
+char *fmt_str(char *p, const char *s);
+
+/* Expande 'fmt' con a0 y a1 ("%u" y "%%"); como mucho 'size' bytes. */
+char *fmt_line(char *p, size_t size, const char *fmt,
+               uint32_t a0, uint32_t a1);
+
+/* ------------------------------------------------------------------ */
+/* Comprobación en compilación                                          */
+/* ------------------------------------------------------------------ */
+
+/* Error de compilación si 'a' no cabe en 32 bits (p. ej. un uint64_t
+ * pasado a un "%u"): obliga a convertirlo de forma explícita. */
+#define FMT_ARG32(a) \
+    ((uint32_t)(a) + 0u * sizeof(char[(sizeof(a) <= 4u) ? 1 : -1]))
+
+/* Comprueba una tabla X(id, formato) con las reglas de printf para dos
+ * argumentos 'unsigned': un "%s", "%llu", "%d" o un tercer "%u" es un
+ * error de compilación. Usar en un único .c (ver log.c). */
+#define FMT_CHECK_ONE(id, f)  fmt_check_(f, 0u, 0u);
+
+#define FMT_CHECK_FORMATS(table)                                        \
+    _Pragma("GCC diagnostic push")                                      \
+    _Pragma("GCC diagnostic error \"-Wformat\"")                        \
+    _Pragma("GCC diagnostic error \"-Wformat-signedness\"")             \
+    _Pragma("GCC diagnostic ignored \"-Wformat-extra-args\"")           \
+    static inline void fmt_check_(const char *f, ...)                   \
+        __attribute__((format(printf, 1, 2)));                          \
+    static inline void fmt_check_(const char *f, ...)                   \
+    {                                                                   \
+        (void)f;                                                        \
+    }                                                                   \
+    static inline void fmt_check_formats_(void)                         \
+    {                                                                   \
+        table(FMT_CHECK_ONE)                                            \
+    }                                                                   \
+    _Pragma("GCC diagnostic pop")
+
+#endif /* FMT_H */
@@ -0,0 +1,131 @@
+#include "riscv_types.h"
+#include "gpio_drv.h"
+
+#include "ffwd.h"
+#include "fsm.h"
+#include "log.h"
+#include "pstats.h"
+#include "time_conv.h"
+
+void fsm_init(fsm_t *f, const fsm_cfg_t *cfg, uint32_t port, uint32_t out)
+{
+    uint8_t i;
+
+    f->cfg = cfg;
+    f->btn_mask = 0u;
+    for (i = 0u; i < 32u; i++) {
+        f->bit_btn[i] = 0u;
+    }
+    for (i = 0u; i < cfg->n_btn; i++) {
+        f->btn_mask |= cfg->btn[i].mask;
+        f->bit_btn[__builtin_ctz(cfg->btn[i].mask)] = i;
+        f->t_press[i] = 0u;
+    }
+    for (i = 0u; i < cfg->n_grp; i++) {
+        f->state[i] = 0u;
+        f->tick_last[i] = 0u;
+    }
+    f->tick_on = 0u;
+    f->next_due = FSM_NEVER;
+    f->prev = port & f->btn_mask;
+    f->pressed = 0u;
+    f->out = out;
+    FFWD_DUE(f, f->next_due);
+}
+
+/* Ejecuta la transición del grupo g para el evento ev. */
+static void fsm_fire(fsm_t *f, uint8_t g, uint8_t ev, uint8_t b,
+                     uint64_t now)
+{
+    const fsm_cfg_t *cfg = f->cfg;
+    const fsm_group_t *grp = &cfg->grp[g];
+    const fsm_tr_t *tr =
+        &grp->table[f->state[g] * FSM_N_EVENTS(cfg->n_btn) + ev];
+    uint8_t act = tr->act;
+
+    if (act & FSM_ACT_REPORT) {
+        uint32_t ms = (uint32_t)ticks_to_ms(now - f->t_press[b]);
+
+        PSTATS_ADD(b, ms);
+#if PSTATS_EACH
+        LOG1(cfg->btn[b].log_id, ms);
+#endif
+    }
+    if (act & FSM_ACT_LED_ON) {
+        f->out |= grp->led_mask;
+    }
+    if (act & FSM_ACT_LED_OFF) {
+        f->out &= ~grp->led_mask;
+    }
+    if (act & FSM_ACT_LED_TOGGLE) {
+        f->out ^= grp->led_mask;
+    }
+    if (act & FSM_ACT_TICK_START) {
+        f->tick_on |= (uint8_t)(1u << g);
+        f->tick_last[g] = now;
+    }
+    if (act & FSM_ACT_TICK_STOP) {
+        f->tick_on &= (uint8_t)~(1u << g);
+    }
+    f->state[g] = tr->next;
+}
+
+void fsm_update(fsm_t *f, uint32_t port, uint64_t now)
+{
+    const fsm_cfg_t *cfg = f->cfg;
+    uint32_t cur = port & f->btn_mask;
+    uint32_t changed = cur ^ f->prev;
+    uint32_t out = f->out;
+    uint8_t g;
+
+    f->prev = cur;
+
+    /* Flancos: solo se recorren los bits que han cambiado. */
+    while (changed != 0u) {
+        uint8_t bit = (uint8_t)__builtin_ctz(changed);
+        uint8_t b = f->bit_btn[bit];
+        uint8_t ev;
+
+        changed &= changed - 1u;
+        if (cur & (1u << bit)) {
+            f->pressed |= 1u << bit;
+            f->t_press[b] = now;
+            ev = FSM_EV_PRESS(b);
+        } else {
+            if (!(f->pressed & (1u << bit))) {
+                continue;
+            }
+            f->pressed &= ~(1u << bit);
+            ev = ((now - f->t_press[b]) >= cfg->btn[b].long_ticks) ?
+                 FSM_EV_LONG(b) : FSM_EV_SHORT(b);
+        }
+
+        for (g = 0u; g < cfg->n_grp; g++) {
+            fsm_fire(f, g, ev, b, now);
+        }
+    }
+
+    /* Periodos vencidos y siguiente vencimiento. */
+    f->next_due = FSM_NEVER;
+    for (g = 0u; g < cfg->n_grp; g++) {
+        uint64_t due;
+
+        if (!(f->tick_on & (1u << g))) {
+            continue;
+        }
+        if ((now - f->tick_last[g]) >= cfg->grp[g].period) {
+            f->tick_last[g] = now;
+            fsm_fire(f, g, FSM_EV_TICK(cfg->n_btn), 0u, now);
+        }
+        /* La acción puede haber parado el periodo. */
+        due = f->tick_last[g] + cfg->grp[g].period;
+        if ((f->tick_on & (1u << g)) && (due < f->next_due)) {
+            f->next_due = due;
+        }
+    }
+    FFWD_DUE(f, f->next_due);
+
+    if (f->out != out) {
+        gpio_write(f->out);
+    }
+}
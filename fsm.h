@@ -0,0 +1,106 @@
+/*
+ * Motor de máquinas de estados por tabla para botones y grupos de LEDs.
+ *
+ * El comportamiento se describe con una tabla constante (en ROM) por
+ * grupo de LEDs: tabla[estado][evento] = { acciones, siguiente estado }.
+ * El motor solo genera eventos y ejecuta acciones; añadir un botón o un
+ * grupo es añadir filas/columnas a la configuración, no ramas al bucle.
+ *
+ * Eventos (por cada botón b = 0..n_btn-1, en este orden):
+ *   FSM_EV_PRESS(b)       flanco de pulsación.
+ *   FSM_EV_SHORT(b)       liberación con duración < long_ticks.
+ *   FSM_EV_LONG(b)        liberación con duración >= long_ticks.
+ * y al final FSM_EV_TICK(n_btn): ha vencido el periodo del grupo.
+ *
+ * Una liberación sin pulsación previa (botón ya pulsado en fsm_init) no
+ * genera evento. Cada evento de botón se entrega a todos los grupos; el
+ * de periodo, solo al suyo. La búsqueda en la tabla es O(1). Tras procesar una
+ * muestra se hace como mucho un gpio_write.
+ */
+#ifndef FSM_H
+#define FSM_H
+
+#include "riscv_types.h"
+
+#ifndef FSM_MAX_BTN
+#define FSM_MAX_BTN   (8u)
+#endif
+#ifndef FSM_MAX_GRP
+#define FSM_MAX_GRP   (4u)
+#endif
+
+/* next_due sin ningún periodo activo. */
+#define FSM_NEVER  (~(uint64_t)0)
+
+/* Numeración de eventos. */
+#define FSM_EV_PRESS(b)   ((uint8_t)(3u * (b)))
+#define FSM_EV_SHORT(b)   ((uint8_t)(3u * (b) + 1u))
+#define FSM_EV_LONG(b)    ((uint8_t)(3u * (b) + 2u))
+#define FSM_EV_TICK(nb)   ((uint8_t)(3u * (nb)))
+#define FSM_N_EVENTS(nb)  (3u * (nb) + 1u)
+
+/* Acciones (combinables). Se ejecutan en este orden. */
+#define FSM_ACT_NONE        (0x00u)
+#define FSM_ACT_REPORT      (0x01u)  /* Registrar duración (log_id).    */
+#define FSM_ACT_LED_ON      (0x02u)  /* Encender los LEDs del grupo.     */
+#define FSM_ACT_LED_OFF     (0x04u)  /* Apagar los LEDs del grupo.       */
+#define FSM_ACT_LED_TOGGLE  (0x08u)  /* Conmutar los LEDs del grupo.     */
+#define FSM_ACT_TICK_START  (0x10u)  /* (Re)arrancar el periodo.         */
+#define FSM_ACT_TICK_STOP   (0x20u)  /* Parar el periodo.                */
+
+/* Entrada de la tabla de transiciones (2 bytes). */
+typedef struct {
+    uint8_t act;
+    uint8_t next;
+} fsm_tr_t;
+
+typedef struct {
+    uint32_t mask;         /* Bit del botón en el puerto (activo alto).  */
+    uint64_t long_ticks;   /* Umbral de pulsación larga.                 */
+    uint8_t  log_id;       /* Formato de FSM_ACT_REPORT (log_fmt.h).     */
+} fsm_button_t;
+
+typedef struct {
+    const fsm_tr_t *table; /* [n_states][FSM_N_EVENTS(n_btn)]            */
+    uint32_t led_mask;
+    uint64_t period;       /* Periodo de FSM_EV_TICK en ticks.           */
+} fsm_group_t;
+
+typedef struct {
+    const fsm_button_t *btn;
+    uint8_t             n_btn;
+    const fsm_group_t  *grp;
+    uint8_t             n_grp;
+} fsm_cfg_t;
+
+typedef struct {
+    const fsm_cfg_t *cfg;
+    uint32_t btn_mask;            /* OR de las máscaras de los botones.  */
+    uint32_t prev;                /* Última muestra de los botones.      */
+    uint32_t pressed;             /* Pulsaciones vistas (medida abierta). */
+    uint32_t out;                 /* Sombra de la salida.                */
+    uint8_t  bit_btn[32];         /* Bit del puerto -> botón.            */
+    uint64_t t_press[FSM_MAX_BTN];
+    uint8_t  state[FSM_MAX_GRP];
+    uint8_t  tick_on;             /* Bit g: periodo del grupo g activo.  */
+    uint64_t tick_last[FSM_MAX_GRP];
+    uint64_t next_due;            /* Próximo vencimiento o FSM_NEVER.    */
+} fsm_t;
+
+/* Prepara el motor: 'port' es la primera lectura del puerto y 'out' el
+ * valor de salida actual. Todos los grupos empiezan en el estado 0. */
+void fsm_init(fsm_t *f, const fsm_cfg_t *cfg, uint32_t port, uint32_t out);
+
+/* Flancos y periodos vencidos (parte lenta de fsm_step). */
+void fsm_update(fsm_t *f, uint32_t port, uint64_t now);
+
+/* Procesa una muestra del puerto en el instante 'now'. Sin flancos ni
+ * periodos vencidos (el caso normal) cuesta dos comparaciones. */
+static inline void fsm_step(fsm_t *f, uint32_t port, uint64_t now)
+{
+    if (((port & f->btn_mask) != f->prev) || (now >= f->next_due)) {
+        fsm_update(f, port, now);
+    }
+}
+
+#endif /* FSM_H */
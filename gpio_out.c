@@ -0,0 +1,39 @@
+#include "riscv_types.h"
+#include "gpio_drv.h"
+
+#include "gpio_out.h"
+
+gpio_out_t gpio_out;
+
+void gpio_out_init(uint32_t value)
+{
+    gpio_out.shadow.v = value;
+    gpio_out.written = value;
+    gpio_out.dirty.v = 0u;
+    gpio_write(value);
+    (void)amo_count_inc(&gpio_out.physical);
+}
+
+void gpio_out_commit(void)
+{
+    uint32_t v, w;
+
+    /* Primero 'dirty' y luego la sombra: un cambio posterior a esta
+     * lectura vuelve a marcar 'dirty' para el siguiente flush. */
+    (void)amo_flag_test_and_clear(&gpio_out.dirty);
+    v = amo_mask_load(&gpio_out.shadow);
+    if (v == gpio_out.written) {
+        return;
+    }
+
+    /* Una ISR que entre aquí (y haga su propio flush) no puede ser
+     * interrumpida por main: si main ha escrito un valor ya viejo, la
+     * nueva lectura de la sombra lo detecta y se reescribe. */
+    do {
+        w = v;
+        gpio_out.written = w;
+        gpio_write(w);
+        (void)amo_count_inc(&gpio_out.physical);
+        v = amo_mask_load(&gpio_out.shadow);
+    } while (v != w);
+}
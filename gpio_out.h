@@ -0,0 +1,100 @@
+/*
+ * Capa de salida sobre gpio_drv.h: registro sombra del puerto con
+ * operaciones de bits y una sola escritura física por vuelta.
+ *
+ *  - gpio_out_set(), gpio_out_clear(), gpio_out_toggle() y
+ *    gpio_out_assign() solo cambian la sombra y marcan 'dirty' (escritura
+ *    lógica; no tocan el bus).
+ *  - gpio_out_flush() hace como mucho un gpio_write() y solo si la sombra
+ *    difiere de lo último escrito. Se llama una vez por vuelta del bucle
+ *    y, si una ISR cambia salidas y el efecto debe ser inmediato, al final
+ *    de esa ISR.
+ *
+ * Se puede usar desde main y desde las ISR sin parar interrupciones:
+ * la sombra, 'dirty' y los contadores son palabras de amo.h (una AMO por
+ * operación). gpio_out_commit() vuelve a leer la sombra después de
+ * escribir y repite si una ISR la ha cambiado entre medias, para que una
+ * escritura vieja de main no quede encima de otra más nueva.
+ */
+#ifndef GPIO_OUT_H
+#define GPIO_OUT_H
+
+#include "riscv_types.h"
+
+#include "amo.h"
+
+typedef struct {
+    amo_mask_t        shadow;     /* Valor deseado del puerto.           */
+    volatile uint32_t written;    /* Último valor enviado al puerto.     */
+    amo_flag_t        dirty;      /* Sombra cambiada desde el flush.     */
+    amo_count_t       logical;    /* Operaciones set/clear/toggle/...    */
+    amo_count_t       physical;   /* Llamadas reales a gpio_write().     */
+} gpio_out_t;
+
+extern gpio_out_t gpio_out;
+
+/* ------------------------------------------------------------------ */
+/* API                                                                 */
+/* ------------------------------------------------------------------ */
+
+/* Escribe 'value' en el puerto (físicamente) y lo toma como sombra. */
+void gpio_out_init(uint32_t value);
+
+/* Escritura física si la sombra ha cambiado (camino lento). */
+void gpio_out_commit(void);
+
+/* shadow = (shadow & ~mask) | (bits & mask). */
+static inline void gpio_out_assign(uint32_t mask, uint32_t bits)
+{
+    (void)amo_mask_assign(&gpio_out.shadow, mask, bits);
+    amo_flag_set(&gpio_out.dirty);
+    (void)amo_count_inc(&gpio_out.logical);
+}
+
+static inline void gpio_out_set(uint32_t bits)
+{
+    (void)amo_mask_set(&gpio_out.shadow, bits);
+    amo_flag_set(&gpio_out.dirty);
+    (void)amo_count_inc(&gpio_out.logical);
+}
+
+static inline void gpio_out_clear(uint32_t bits)
+{
+    (void)amo_mask_clear(&gpio_out.shadow, bits);
+    amo_flag_set(&gpio_out.dirty);
+    (void)amo_count_inc(&gpio_out.logical);
+}
+
+static inline void gpio_out_toggle(uint32_t bits)
+{
+    (void)amo_mask_toggle(&gpio_out.shadow, bits);
+    amo_flag_set(&gpio_out.dirty);
+    (void)amo_count_inc(&gpio_out.logical);
+}
+
+/* Valor deseado del puerto (sombra). */
+static inline uint32_t gpio_out_get(void)
+{
+    return amo_mask_load(&gpio_out.shadow);
+}
+
+/* Vuelca la sombra al puerto: nada si no hay cambios pendientes. */
+static inline void gpio_out_flush(void)
+{
+    if (amo_flag_test(&gpio_out.dirty)) {
+        gpio_out_commit();
+    }
+}
+
+/* Estadísticas: escrituras lógicas y físicas. */
+static inline uint32_t gpio_out_logical(void)
+{
+    return amo_count_load(&gpio_out.logical);
+}
+
+static inline uint32_t gpio_out_physical(void)
+{
+    return amo_count_load(&gpio_out.physical);
+}
+
+#endif /* GPIO_OUT_H */
@@ -0,0 +1,33 @@
+/*
+ * Identificador de hart.
+ *
+ * En la placa lee el CSR mhartid; en el host lo da el simulador (0 salvo
+ * con sim_run2(), que ejecuta la variante en dos harts).
+ */
+#ifndef HART_H
+#define HART_H
+
+#include "riscv_types.h"
+
+#if defined(__riscv)
+
+static inline uint32_t hart_id(void)
+{
+    uint32_t id;
+
+    __asm__ volatile ("csrr %0, mhartid" : "=r"(id));
+    return id;
+}
+
+#else /* host */
+
+uint32_t sim_hart_id(void);
+
+static inline uint32_t hart_id(void)
+{
+    return sim_hart_id();
+}
+
+#endif
+
+#endif /* HART_H */
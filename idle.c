@@ -0,0 +1,49 @@
+#include "riscv_types.h"
+
+#include "clinc.h"
+#include "riscv_monotonic_clock.h"
+
+#include "idle.h"
+#include "log.h"
+
+#define IDLE_REPORT_TICKS  ((uint64_t)IDLE_REPORT_MS * (CLINT_CLOCK / 1000u))
+
+idle_stat_t idle_stat;
+
+/* Inicio del intervalo de informe en curso. */
+static uint64_t rep_t = 0u;
+static uint64_t rep_idle = 0u;
+static uint32_t rep_wakeups = 0u;
+
+void idle_wait(void)
+{
+    uint64_t t0 = get_ticks_from_reset();
+
+    cpu_wfi();
+    idle_stat.idle_ticks += get_ticks_from_reset() - t0;
+    idle_stat.wakeups++;
+}
+
+void idle_poll(uint64_t now)
+{
+    uint64_t span = now - rep_t;
+    uint64_t busy;
+
+    if (span < IDLE_REPORT_TICKS) {
+        return;
+    }
+    busy = span - (idle_stat.idle_ticks - rep_idle);
+
+    /* Diezmilésimas sin división de 64 bits: se reduce el intervalo a
+     * 18 bits (busy <= span), de modo que busy * 10000 cabe en 32. */
+    while ((span >> 18) != 0u) {
+        span >>= 1;
+        busy >>= 1;
+    }
+    LOG2(LOG_IDLE_DUTY, ((uint32_t)busy * 10000u) / (uint32_t)span,
+         idle_stat.wakeups - rep_wakeups);
+
+    rep_t = now;
+    rep_idle = idle_stat.idle_ticks;
+    rep_wakeups = idle_stat.wakeups;
+}
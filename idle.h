@@ -0,0 +1,69 @@
+/*
+ * Reposo del núcleo con WFI y cuenta del tiempo en reposo.
+ *
+ * El bucle principal llama a idle_wait() cuando no le queda trabajo, con
+ * las interrupciones deshabilitadas desde antes de comprobarlo:
+ *
+ *     disable_irq();
+ *     if (nada pendiente) {
+ *         idle_wait();
+ *     }
+ *     enable_irq();
+ *
+ * WFI despierta con una IRQ pendiente aunque estén deshabilitadas (MIE =
+ * 0), así que una que llegue entre la comprobación y el WFI no se pierde:
+ * el núcleo no llega a dormir y la ISR se atiende en enable_irq(). Las
+ * fuentes de despertar son las IRQ habilitadas una a una (timer del
+ * CLINT, cambio de nivel en el GPIO); el bucle debe haber programado el
+ * próximo plazo antes de dormir.
+ *
+ * idle_wait() suma el tiempo dormido a idle_stat. idle_poll(), llamada
+ * en cada vuelta, emite cada IDLE_REPORT_MS un registro LOG_IDLE_DUTY con
+ * la fracción de tiempo activo (en diezmilésimas) y los WFI de ese
+ * intervalo. Sale en la primera vuelta tras vencer el intervalo: sin
+ * despertares no hay informe, ni hace falta.
+ *
+ * En el host, cpu_wfi() la resuelve el simulador adelantando el reloj
+ * virtual hasta la siguiente interrupción.
+ */
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "riscv_types.h"
+
+#ifndef IDLE_REPORT_MS
+#define IDLE_REPORT_MS  (60000u)
+#endif
+
+typedef struct {
+    uint64_t idle_ticks;        /* Tiempo total dentro de WFI.           */
+    uint32_t wakeups;
+} idle_stat_t;
+
+extern idle_stat_t idle_stat;
+
+#if defined(__riscv)
+
+static inline void cpu_wfi(void)
+{
+    __asm__ volatile ("wfi" ::: "memory");
+}
+
+#else /* host */
+
+void sim_wfi(void);
+
+static inline void cpu_wfi(void)
+{
+    sim_wfi();
+}
+
+#endif
+
+/* WFI con la cuenta de tiempo (ver arriba). */
+void idle_wait(void);
+
+/* Informe periódico del ciclo de trabajo; 'now' en ticks de mtime. */
+void idle_poll(uint64_t now);
+
+#endif /* IDLE_H */
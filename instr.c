@@ -0,0 +1,83 @@
+#include "riscv_types.h"
+
+#include "instr.h"
+#include "log.h"
+
+#if INSTR_ENABLE
+
+instr_hist_t instr_hist[INSTR_N_HIST];
+uint64_t instr_loop_last = 0u;
+uint64_t instr_loop_prev = 0u;
+
+/* Cabecera de cada histograma en el volcado. */
+static const uint8_t hist_fmt[INSTR_N_HIST] = {
+    LOG_INSTR_LOOP, LOG_INSTR_EDGE, LOG_INSTR_ISR
+};
+
+/* Estado del volcado: histograma y cubeta en curso. dump_k ==
+ * INSTR_BUCKETS indica que falta la cabecera. */
+static uint32_t dump_pins = 0u;
+static uint8_t  dump_on = 0u;
+static uint8_t  dump_h = 0u;
+static uint8_t  dump_k = 0u;
+
+void instr_dump(void)
+{
+    if (!dump_on) {
+        dump_on = 1u;
+        dump_h = 0u;
+        dump_k = INSTR_BUCKETS;
+    }
+}
+
+void instr_reset(void)
+{
+    uint8_t h, k;
+
+    for (h = 0u; h < INSTR_N_HIST; h++) {
+        for (k = 0u; k < INSTR_BUCKETS; k++) {
+            instr_hist[h].bucket[k] = 0u;
+        }
+        instr_hist[h].max = 0u;
+    }
+}
+
+void instr_poll(uint32_t pins)
+{
+    const instr_hist_t *hist;
+
+    if (pins & ~dump_pins & INSTR_DUMP_MASK) {
+        instr_dump();
+    }
+    dump_pins = pins;
+
+    /* Un registro por llamada y solo con la cola medio vacía: los
+     * registros de la aplicación tienen prioridad. */
+    if (!dump_on || (log_free() <= (LOG_RING_SIZE / 2u))) {
+        return;
+    }
+
+    hist = &instr_hist[dump_h];
+    if (dump_k == INSTR_BUCKETS) {
+        LOG1(hist_fmt[dump_h], hist->max);
+        dump_k = 0u;
+        return;
+    }
+
+    while ((dump_k < INSTR_BUCKETS) && (hist->bucket[dump_k] == 0u)) {
+        dump_k++;
+    }
+    if (dump_k < INSTR_BUCKETS) {
+        LOG2(LOG_INSTR_BIN, dump_k, hist->bucket[dump_k]);
+        dump_k++;
+        return;
+    }
+
+    /* Histograma terminado. */
+    dump_k = INSTR_BUCKETS;
+    if (++dump_h == INSTR_N_HIST) {
+        dump_on = 0u;
+    }
+}
+
+#endif /* INSTR_ENABLE */
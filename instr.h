@@ -0,0 +1,115 @@
+/*
+ * Instrumentación de tiempos: histogramas log2 en RAM fija.
+ *
+ * Tres histogramas, en ticks de get_ticks_from_reset():
+ *   INSTR_H_LOOP  periodo del bucle principal (INSTR_LOOP en cada vuelta).
+ *   INSTR_H_EDGE  latencia desde el flanco hasta que se atiende:
+ *                 - INSTR_EDGE(t_edge, now) si se conoce el instante del
+ *                   flanco (p. ej. sellado en la ISR y atendido en main);
+ *                 - INSTR_EDGE_POLLED(cambio) en un bucle de sondeo: el
+ *                   flanco ocurrió entre la vuelta anterior y esta, así que
+ *                   se anota la cota superior (periodo de esa vuelta).
+ *   INSTR_H_ISR   duración de una ISR (INSTR_ISR_ENTER/INSTR_ISR_EXIT).
+ *
+ * La cubeta k cuenta los valores v con 2^(k-1) <= v < 2^k (la 0, v = 0;
+ * la última acumula todo lo que no cabe). Cada histograma debe tener un
+ * único contexto escritor (main o una ISR).
+ *
+ * Volcado: un flanco de subida en INSTR_DUMP_MASK (INSTR_POLL) o
+ * instr_dump() lo inicia; INSTR_POLL lo envía poco a poco con el registro
+ * diferido (log.h), sin bloquear el bucle ni llenar la cola. INSTR_POLL()
+ * lee el puerto por su cuenta; INSTR_POLL_PINS(pins) aprovecha la lectura
+ * que ya tenga el bucle.
+ *
+ * Con INSTR_ENABLE = 0 (por defecto) las macros no generan código.
+ */
+#ifndef INSTR_H
+#define INSTR_H
+
+#include "riscv_types.h"
+#include "gpio_drv.h"
+#include "riscv_monotonic_clock.h"
+
+#ifndef INSTR_ENABLE
+#define INSTR_ENABLE     (0)
+#endif
+
+/* Botón que pide el volcado. */
+#ifndef INSTR_DUMP_MASK
+#define INSTR_DUMP_MASK  PBT_3_MASK
+#endif
+
+#define INSTR_BUCKETS    (32u)
+
+enum { INSTR_H_LOOP, INSTR_H_EDGE, INSTR_H_ISR, INSTR_N_HIST };
+
+typedef struct {
+    uint32_t bucket[INSTR_BUCKETS];
+    uint32_t max;
+} instr_hist_t;
+
+#if INSTR_ENABLE
+
+extern instr_hist_t instr_hist[INSTR_N_HIST];
+extern uint64_t instr_loop_last;   /* Instante de esta vuelta.          */
+extern uint64_t instr_loop_prev;   /* Instante de la vuelta anterior.   */
+
+static inline void instr_add(uint8_t h, uint64_t v)
+{
+    uint32_t x = (v > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)v;
+    uint32_t k = (x == 0u) ? 0u : (32u - (uint32_t)__builtin_clz(x));
+
+    if (k >= INSTR_BUCKETS) {
+        k = INSTR_BUCKETS - 1u;
+    }
+    instr_hist[h].bucket[k]++;
+    if (x > instr_hist[h].max) {
+        instr_hist[h].max = x;
+    }
+}
+
+static inline void instr_loop(uint64_t now)
+{
+    if (instr_loop_last != 0u) {
+        instr_add(INSTR_H_LOOP, now - instr_loop_last);
+    }
+    instr_loop_prev = instr_loop_last;
+    instr_loop_last = now;
+}
+
+/* Inicia el volcado (si no hay uno en curso). */
+void instr_dump(void);
+
+/* Detecta la petición de volcado y envía una parte. */
+void instr_poll(uint32_t pins);
+
+/* Pone a cero los histogramas. */
+void instr_reset(void);
+
+#define INSTR_LOOP(now)          instr_loop(now)
+#define INSTR_EDGE(t_edge, now)  instr_add(INSTR_H_EDGE, (now) - (t_edge))
+#define INSTR_EDGE_POLLED(chg)                                      \
+    do {                                                            \
+        if ((chg) && (instr_loop_prev != 0u)) {                     \
+            instr_add(INSTR_H_EDGE, instr_loop_last - instr_loop_prev); \
+        }                                                           \
+    } while (0)
+#define INSTR_ISR_ENTER()        uint64_t instr_t0_ = get_ticks_from_reset()
+#define INSTR_ISR_EXIT()                                            \
+    instr_add(INSTR_H_ISR, get_ticks_from_reset() - instr_t0_)
+#define INSTR_POLL()             instr_poll(gpio_read())
+#define INSTR_POLL_PINS(pins)    instr_poll(pins)
+
+#else /* !INSTR_ENABLE */
+
+#define INSTR_LOOP(now)          ((void)0)
+#define INSTR_EDGE(t_edge, now)  ((void)0)
+#define INSTR_EDGE_POLLED(chg)   ((void)0)
+#define INSTR_ISR_ENTER()        ((void)0)
+#define INSTR_ISR_EXIT()         ((void)0)
+#define INSTR_POLL()             ((void)0)
+#define INSTR_POLL_PINS(pins)    ((void)0)
+
+#endif /* INSTR_ENABLE */
+
+#endif /* INSTR_H */
@@ -0,0 +1,151 @@
+#include "riscv_types.h"
+#include "riscv_monotonic_clock.h"
+
+#include "cycles.h"
+#include "lacap.h"
+#include "log.h"
+#include "time_conv.h"
+
+#if LACAP_ENABLE
+
+lacap_t lacap;
+
+/* Estado del volcado: paso y desplazamiento en el búfer. */
+enum { DUMP_HDR, DUMP_BASE, DUMP_V0, DUMP_DATA, DUMP_END };
+
+static uint32_t dump_pins = 0u;
+static uint32_t dump_off = 0u;
+static uint8_t  dump_step = DUMP_HDR;
+static uint8_t  dump_on = 0u;
+
+/* LEB128 sin signo: como mucho 5 bytes para 32 bits. */
+static inline uint8_t *put_leb(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x80u) {
+        *p++ = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+void lacap_sample(uint32_t pins)
+{
+    uint32_t c0 = cycles_now();
+    uint32_t x, dc;
+
+    if (lacap.frozen) {
+        return;
+    }
+    lacap.samples++;
+
+    if (!lacap.started) {
+        lacap.t0 = get_ticks_from_reset();
+        lacap.v0 = pins;
+        lacap.last = pins;
+        lacap.run = 0u;
+        lacap.started = 1u;
+        return;
+    }
+
+    x = pins ^ lacap.last;
+    lacap.run++;
+    if ((x != 0u) || (lacap.run == LACAP_RUN_MAX)) {
+        if ((lacap.len + LACAP_REC_MAX) <= LACAP_BYTES) {
+            uint8_t *p = put_leb(&lacap.buf[lacap.len], lacap.run);
+
+            p = put_leb(p, x);
+            lacap.len = (uint32_t)(p - lacap.buf);
+            lacap.records++;
+        } else if (x != 0u) {
+            lacap.lost++;
+        }
+        lacap.run = 0u;
+        lacap.last = pins;
+    }
+
+    dc = cycles_now() - c0;
+    if (dc > lacap.cyc_max) {
+        lacap.cyc_max = dc;
+    }
+}
+
+void lacap_dump(void)
+{
+    if (!dump_on) {
+        dump_on = 1u;
+        lacap.frozen = 1u;
+        dump_step = DUMP_HDR;
+        dump_off = 0u;
+    }
+}
+
+/* Vacía la captura y la reanuda. */
+static void lacap_restart(void)
+{
+    lacap.len = 0u;
+    lacap.run = 0u;
+    lacap.samples = 0u;
+    lacap.records = 0u;
+    lacap.lost = 0u;
+    lacap.cyc_max = 0u;
+    lacap.started = 0u;
+    dump_on = 0u;
+    __asm__ volatile ("" ::: "memory");
+    lacap.frozen = 0u;
+}
+
+void lacap_stop(void)
+{
+    lacap.frozen = 1u;
+}
+
+void lacap_start(void)
+{
+    if (!dump_on) {
+        lacap_restart();
+    }
+}
+
+void lacap_poll(uint32_t pins)
+{
+    if (pins & ~dump_pins & LACAP_DUMP_MASK) {
+        lacap_dump();
+    }
+    dump_pins = pins;
+
+    /* Un registro por llamada y solo con la cola medio vacía: los
+     * registros de la aplicación tienen prioridad. */
+    if (!dump_on || (log_free() <= (LOG_RING_SIZE / 2u))) {
+        return;
+    }
+
+    if (dump_step == DUMP_HDR) {
+        LOG2(LOG_LACAP_HDR, LACAP_PERIOD_TICKS, lacap.len);
+        dump_step = DUMP_BASE;
+    } else if (dump_step == DUMP_BASE) {
+        uint32_t ms = (uint32_t)ticks_to_ms(lacap.t0);
+
+        LOG2(LOG_LACAP_BASE, ms,
+             (uint32_t)(lacap.t0 - (uint64_t)ms * (CLINT_CLOCK / 1000u)));
+        dump_step = DUMP_V0;
+    } else if (dump_step == DUMP_V0) {
+        LOG2(LOG_LACAP_V0, lacap.v0, lacap.samples);
+        dump_step = (lacap.len != 0u) ? DUMP_DATA : DUMP_END;
+    } else if (dump_step == DUMP_DATA) {
+        const uint8_t *b = &lacap.buf[dump_off];
+
+        LOG2(LOG_LACAP_DATA, dump_off,
+             (uint32_t)b[0] | ((uint32_t)b[1] << 8) |
+             ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24));
+        dump_off += 4u;
+        if (dump_off >= lacap.len) {
+            dump_step = DUMP_END;
+        }
+    } else {
+        LOG2(LOG_LACAP_END, lacap.lost, lacap.cyc_max);
+        lacap_restart();
+    }
+}
+
+#endif /* LACAP_ENABLE */
@@ -0,0 +1,115 @@
+/*
+ * Analizador lógico: captura del puerto GPIO en RAM, comprimida.
+ *
+ * El manejador de un timer periódico llama a LACAP_SAMPLE(pins) con la
+ * palabra completa de gpio_read() cada LACAP_PERIOD_US. Solo se guardan
+ * los cambios, como registros (racha, xor):
+ *   racha  muestras desde el registro anterior (>= 1);
+ *   xor    bits que cambian respecto a la muestra anterior (0: solo
+ *          tiempo, para rachas de más de LACAP_RUN_MAX muestras).
+ * Cada campo va en LEB128 sin signo (7 bits por byte, el bit 7 indica
+ * que sigue otro byte): un botón (bits 4-7) son 2 bytes de xor y una
+ * racha corta 1 byte, y horas sin cambios cuestan unos pocos bytes.
+ *
+ * Coste por muestra acotado: una comparación si no hay cambio y, si lo
+ * hay, como mucho LACAP_REC_MAX bytes escritos, sin bucles que dependan
+ * de los datos guardados. lacap_sample() anota su máximo en ciclos
+ * (cycles.h). Con el búfer lleno se dejan de guardar cambios (se cuentan
+ * en 'lost') y la captura conserva el principio.
+ *
+ * Volcado: un flanco de subida en LACAP_DUMP_MASK (LACAP_POLL(), que lee
+ * el puerto por su cuenta) o lacap_dump() congela la captura y la envía
+ * por el registro diferido (log.h): LOG_LACAP_HDR (periodo en ticks,
+ * bytes), LOG_LACAP_BASE (instante de la primera muestra en ms y ticks),
+ * LOG_LACAP_V0 (su valor y el total de muestras), un LOG_LACAP_DATA por
+ * cada 4 bytes (desplazamiento y palabra little-endian) y LOG_LACAP_END
+ * (cambios perdidos y ciclos máx. por muestra). Al terminar, la captura
+ * empieza de nuevo. tools/la2vcd.c convierte el texto en VCD.
+ *
+ * lacap_stop() congela la captura sin volcarla (p. ej. justo después
+ * del suceso que interesa) y lacap_start() la vacía y la reanuda; fuera
+ * de un volcado, que tiene prioridad.
+ *
+ * Con LACAP_ENABLE = 0 (por defecto) las macros no generan código.
+ */
+#ifndef LACAP_H
+#define LACAP_H
+
+#include "riscv_types.h"
+#include "clinc.h"
+#include "gpio_drv.h"
+
+#ifndef LACAP_ENABLE
+#define LACAP_ENABLE     (0)
+#endif
+
+/* Periodo de muestreo. */
+#ifndef LACAP_PERIOD_US
+#define LACAP_PERIOD_US  (100u)
+#endif
+
+#define LACAP_PERIOD_TICKS  (LACAP_PERIOD_US * (CLINT_CLOCK / 1000000u))
+
+/* Tamaño del búfer: múltiplo de 4 (se vuelca por palabras). */
+#ifndef LACAP_BYTES
+#define LACAP_BYTES      (2048u)
+#endif
+
+#if (LACAP_BYTES % 4u) != 0
+#error "LACAP_BYTES debe ser múltiplo de 4"
+#endif
+
+/* Botón que pide el volcado. */
+#ifndef LACAP_DUMP_MASK
+#define LACAP_DUMP_MASK  PBT_2_MASK
+#endif
+
+/* Racha máxima por registro (cabe en 4 bytes LEB128) y tamaño máximo
+ * de un registro (racha + xor de 32 bits). */
+#define LACAP_RUN_MAX    ((1u << 28) - 1u)
+#define LACAP_REC_MAX    (4u + 5u)
+
+typedef struct {
+    uint8_t           buf[LACAP_BYTES];
+    uint32_t          len;        /* Bytes usados.                       */
+    uint32_t          last;       /* Última muestra.                     */
+    uint32_t          run;        /* Muestras desde el último registro.  */
+    uint32_t          samples;
+    uint32_t          records;
+    uint32_t          lost;       /* Cambios sin sitio en el búfer.      */
+    uint32_t          cyc_max;    /* Ciclos máx. de lacap_sample().      */
+    uint64_t          t0;         /* Instante de la primera muestra.     */
+    uint32_t          v0;         /* Su valor.                           */
+    volatile uint8_t  started;    /* 0: falta la primera muestra.        */
+    volatile uint8_t  frozen;     /* 1: volcado en curso (la ISR no      */
+                                  /* toca nada).                         */
+} lacap_t;
+
+extern lacap_t lacap;
+
+#if LACAP_ENABLE
+
+/* Desde el manejador del timer, con el valor del puerto. */
+void lacap_sample(uint32_t pins);
+
+/* Inicia el volcado (si no hay uno en curso). */
+void lacap_dump(void);
+
+/* Congela la captura / la vacía y la reanuda. */
+void lacap_stop(void);
+void lacap_start(void);
+
+/* Detecta la petición de volcado y envía una parte. */
+void lacap_poll(uint32_t pins);
+
+#define LACAP_SAMPLE(pins)  lacap_sample(pins)
+#define LACAP_POLL()        lacap_poll(gpio_read())
+
+#else /* !LACAP_ENABLE */
+
+#define LACAP_SAMPLE(pins)  ((void)0)
+#define LACAP_POLL()        ((void)0)
+
+#endif /* LACAP_ENABLE */
+
+#endif /* LACAP_H */
@@ -0,0 +1,136 @@
+#include "riscv_types.h"
+#include "riscv_uart.h"
+
+#include "log.h"
+
+log_ring_t log_ring;
+
+/* Los formatos solo usan "%u" con dos argumentos como mucho. */
+FMT_CHECK_FORMATS(LOG_FORMATS)
+
+#if LOG_DEFERRED
+
+/* Trama en curso de envío. */
+static uint8_t  tx_frame[3u + 4u * LOG_MAX_ARGS];
+static uint8_t  tx_len = 0u;
+static uint8_t  tx_pos = 0u;
+
+/* Descartes ya avisados con LOG_DROPPED. */
+static uint32_t dropped_reported = 0u;
+
+/* Serializa un registro en tx_frame. */
+static void log_frame(uint8_t id, uint8_t nargs, const uint32_t *arg)
+{
+    uint8_t i;
+
+    tx_frame[0] = (uint8_t)LOG_SYNC;
+    tx_frame[1] = id;
+    tx_frame[2] = nargs;
+    tx_len = 3u;
+    for (i = 0u; i < nargs; i++) {
+        tx_frame[tx_len++] = (uint8_t)(arg[i]);
+        tx_frame[tx_len++] = (uint8_t)(arg[i] >> 8);
+        tx_frame[tx_len++] = (uint8_t)(arg[i] >> 16);
+        tx_frame[tx_len++] = (uint8_t)(arg[i] >> 24);
+    }
+    tx_pos = 0u;
+}
+
+/* Prepara la siguiente trama; devuelve 0 si no hay nada que enviar. */
+static int log_next_frame(void)
+{
+    uint32_t dropped = log_ring.dropped;
+    uint32_t tail = log_ring.tail;
+    const log_rec_t *r;
+
+    if (dropped != dropped_reported) {
+        uint32_t n = dropped - dropped_reported;
+
+        dropped_reported = dropped;
+        log_frame((uint8_t)LOG_DROPPED, 1u, &n);
+        return 1;
+    }
+
+    if (tail == log_ring.head) {
+        return 0;
+    }
+
+    __asm__ volatile ("" ::: "memory");
+    r = &log_ring.buf[tail & (LOG_RING_SIZE - 1u)];
+    log_frame(r->id, r->nargs, r->arg);
+    __asm__ volatile ("" ::: "memory");
+    log_ring.tail = tail + 1u;
+    return 1;
+}
+
+uint8_t log_busy(void)
+{
+    return (uint8_t)((tx_pos != tx_len) || (log_ring.tail != log_ring.head) ||
+                     (log_ring.dropped != dropped_reported));
+}
+
+void log_drain(void)
+{
+    /* Sin nada pendiente no se toca la UART. */
+    if (!log_busy()) {
+        return;
+    }
+
+    while (riscv_uart_tx_ready()) {
+        if (tx_pos == tx_len) {
+            if (!log_next_frame()) {
+                return;
+            }
+        }
+        riscv_uart_putc(tx_frame[tx_pos++]);
+    }
+}
+
+#else /* !LOG_DEFERRED */
+
+#define LOG_FMT_STR(id, fmt)  fmt,
+
+static const char *const log_fmt[LOG_N_FORMATS] = {
+    LOG_FORMATS(LOG_FMT_STR)
+};
+
+/* Longitud máxima de una línea de texto. */
+#define LOG_LINE_MAX  (96u)
+
+void log_print(uint8_t id, uint32_t a0, uint32_t a1)
+{
+#if LOG_PRINTF
+    if (id < LOG_N_FORMATS) {
+        printf(log_fmt[id], (unsigned)a0, (unsigned)a1);
+    }
+#else
+    static char line[LOG_LINE_MAX];
+    const char *p, *end;
+
+    if (id >= LOG_N_FORMATS) {
+        return;
+    }
+    end = fmt_line(line, sizeof line, log_fmt[id], a0, a1);
+    for (p = line; p < end; p++) {
+        while (!riscv_uart_tx_ready()) {
+        }
+        riscv_uart_putc((uint8_t)*p);
+    }
+#endif
+}
+
+void log_drain(void)
+{
+}
+
+uint8_t log_busy(void)
+{
+    return 0u;
+}
+
+#endif /* LOG_DEFERRED */
+
+uint32_t log_dropped(void)
+{
+    return log_ring.dropped;
+}
@@ -0,0 +1,117 @@
+/*
+ * Registro diferido en binario.
+ *
+ * En lugar de formatear con printf (más de 1 ms por línea a 115200
+ * baudios), cada llamada LOGn() copia un registro compacto (id de formato
+ * y argumentos en crudo) en una cola en RAM y vuelve de inmediato.
+ * log_drain(), llamada en los ratos libres del bucle principal, envía los
+ * registros por la UART sin bloquear, y tools/logdec.c los convierte de
+ * nuevo en el texto de log_fmt.h.
+ *
+ * Si la cola está llena el registro se descarta; el total se lee con
+ * log_dropped() y el drenado emite un registro LOG_DROPPED con los
+ * perdidos desde el último aviso.
+ *
+ * Las llamadas LOGn() deben hacerse desde un único contexto (main o una
+ * sola ISR): la cola tiene un único productor.
+ *
+ * LOG_DEFERRED = 0 envía el mismo texto de forma síncrona, formateado
+ * con fmt.h directamente en la UART (LOG_PRINTF = 1: con printf).
+ *
+ * Los argumentos deben caber en 32 bits: un uint64_t es un error de
+ * compilación (FMT_ARG32) en lugar de truncarse en silencio.
+ */
+#ifndef LOG_H
+#define LOG_H
+
+#include "riscv_types.h"
+
+#include "fmt.h"
+#include "log_fmt.h"
+
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED  (1)
+#endif
+
+#ifndef LOG_PRINTF
+#define LOG_PRINTF    (0)
+#endif
+
+/* Número de registros en la cola: potencia de 2. */
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE (32u)
+#endif
+
+#if (LOG_RING_SIZE & (LOG_RING_SIZE - 1u)) != 0
+#error "LOG_RING_SIZE debe ser potencia de 2"
+#endif
+
+/* Registro en RAM (12 bytes). */
+typedef struct {
+    uint8_t  id;
+    uint8_t  nargs;
+    uint16_t reserved;
+    uint32_t arg[LOG_MAX_ARGS];
+} log_rec_t;
+
+typedef struct {
+    log_rec_t         buf[LOG_RING_SIZE];
+    volatile uint32_t head;       /* Lo escribe el productor (LOGn).     */
+    volatile uint32_t tail;       /* Lo escribe log_drain().             */
+    volatile uint32_t dropped;    /* Registros descartados (total).      */
+} log_ring_t;
+
+extern log_ring_t log_ring;
+
+/* Escritura de un registro en la cola (camino rápido). */
+static inline void log_put(uint8_t id, uint8_t nargs,
+                           uint32_t a0, uint32_t a1)
+{
+    uint32_t head = log_ring.head;
+    log_rec_t *r;
+
+    if ((head - log_ring.tail) >= LOG_RING_SIZE) {
+        log_ring.dropped++;
+        return;
+    }
+
+    r = &log_ring.buf[head & (LOG_RING_SIZE - 1u)];
+    r->id = id;
+    r->nargs = nargs;
+    r->arg[0] = a0;
+    r->arg[1] = a1;
+
+    __asm__ volatile ("" ::: "memory");
+    log_ring.head = head + 1u;
+}
+
+#if LOG_DEFERRED
+#define LOG0(id)        log_put((id), 0u, 0u, 0u)
+#define LOG1(id, a)     log_put((id), 1u, FMT_ARG32(a), 0u)
+#define LOG2(id, a, b)  log_put((id), 2u, FMT_ARG32(a), FMT_ARG32(b))
+#else
+/* Envío síncrono del texto del formato 'id'. */
+void log_print(uint8_t id, uint32_t a0, uint32_t a1);
+
+#define LOG0(id)        log_print((id), 0u, 0u)
+#define LOG1(id, a)     log_print((id), FMT_ARG32(a), 0u)
+#define LOG2(id, a, b)  log_print((id), FMT_ARG32(a), FMT_ARG32(b))
+#endif
+
+/* Registros libres en la cola. */
+static inline uint32_t log_free(void)
+{
+    return LOG_RING_SIZE - (log_ring.head - log_ring.tail);
+}
+
+/* Envía por la UART lo que quepa sin esperar. */
+void log_drain(void);
+
+/* 1 si log_drain() aún tiene algo que enviar (siempre 0 en modo
+ * síncrono). */
+uint8_t log_busy(void);
+
+/* Registros descartados desde el arranque. */
+uint32_t log_dropped(void);
+
+#endif /* LOG_H */
@@ -0,0 +1,57 @@
+/*
+ * Tabla de formatos del registro diferido (log.h) y formato de trama.
+ *
+ * Cada entrada X(id, formato) asocia un identificador con el texto que
+ * reconstruye el decodificador de host (tools/logdec.c). El id es la
+ * posición en la tabla: añadir siempre al final.
+ *
+ * Trama en la UART (little-endian):
+ *   LOG_SYNC | id | nargs | arg0 (4 bytes) | ... | arg[nargs-1]
+ */
+#ifndef LOG_FMT_H
+#define LOG_FMT_H
+
+#define LOG_SYNC      (0xA5u)
+#define LOG_MAX_ARGS  (2u)
+
+#define LOG_FORMATS(X)                                   \
+    X(LOG_DROPPED,      "[log] %u registros perdidos\n") \
+    X(LOG_BTN0_MS,      "BTN0 pulsado %u ms\n")          \
+    X(LOG_PULSADOR0_MS, "Pulsador 0: %u ms\r\n")         \
+    X(LOG_TIEMPO_MS,    "Tiempo pulsado: %u ms\n")       \
+    X(LOG_PBT0_MS,      "PBT0: %u ms\n")                 \
+    X(LOG_BTNN_MS,      "BTN%u pulsado %u ms\n")         \
+    X(LOG_INSTR_LOOP,   "[instr] bucle: max %u\n")       \
+    X(LOG_INSTR_EDGE,   "[instr] flanco: max %u\n")      \
+    X(LOG_INSTR_ISR,    "[instr] ISR: max %u\n")         \
+    X(LOG_INSTR_BIN,    "[instr]   <2^%u: %u\n")         \
+    X(LOG_PULSADOR0_US, "Pulsador 0: %u us\r\n")         \
+    X(LOG_STATS_BTN,    "[stats] BTN%u n=%u\n")          \
+    X(LOG_STATS_RANGE,  "[stats]   min %u max %u\n")     \
+    X(LOG_STATS_MEAN,   "[stats]   media %u sd %u\n")    \
+    X(LOG_STATS_PCT,    "[stats]   p%u %u\n")            \
+    X(LOG_STATS_BIN,    "[stats]   <2^%u: %u\n")         \
+    X(LOG_IDLE_DUTY,    "[idle] activa %u/10000, %u WFI\n") \
+    X(LOG_LACAP_HDR,    "[cap] periodo %u ticks, %u bytes\n") \
+    X(LOG_LACAP_BASE,   "[cap] inicio %u ms + %u ticks\n") \
+    X(LOG_LACAP_V0,     "[cap] puerto %u, %u muestras\n") \
+    X(LOG_LACAP_DATA,   "[cap] %u: %u\n")                \
+    X(LOG_LACAP_END,    "[cap] fin: %u perdidos, %u ciclos\n") \
+    X(LOG_CON_LONG_MS,  "[con] long_ms = %u\n")         \
+    X(LOG_CON_BLINK_MS, "[con] blink_ms = %u\n")        \
+    X(LOG_CON_DEBOUNCE_MS, "[con] debounce_ms = %u\n")  \
+    X(LOG_CON_OK,       "[con] ok\n")                   \
+    X(LOG_CON_ERR,      "[con] error %u\n")             \
+    X(LOG_SCHED_TASK,   "[sched] tarea %u: resp. máx %u ticks\n") \
+    X(LOG_SCHED_MISS,   "[sched]   %u plazos vencidos, %u solapes\n") \
+    X(LOG_TIMER_RATE,   "[timer] %u IRQ/s en %u ms\n") \
+    X(LOG_BTN1_MS,      "BTN1 pulsado %u ms\n")
+
+#define LOG_ENUM_ID(id, fmt)  id,
+
+enum {
+    LOG_FORMATS(LOG_ENUM_ID)
+    LOG_N_FORMATS
+};
+
+#endif /* LOG_FMT_H */
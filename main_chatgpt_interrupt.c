@@ -6,6 +6,7 @@
 #include "clinc.h"
 #include "riscv_monotonic_clock.h"
 
+#include "gpio_out.h"
 #include "log.h"
 
   /* Variables compartidas con la ISR */
@@ -39,6 +40,7 @@
 
       /* Configurar LEDs como salida (bits 16-19) */
       gpio_set_direction(0x000F0000);
+      gpio_out_init(0x00000000);
 
       /* Configurar timer*/
       install_local_timer_handler(timer_handler);
@@ -63,7 +65,7 @@
           {
               /* Flanco de bajada: fin de pulsación */
               elapsed = ms_ticks - press_time;
-              printf("Tiempo pulsado: %u ms\n", elapsed);
+              LOG1(LOG_TIEMPO_MS, elapsed);
 
               if (elapsed >= 1000)
               {
@@ -84,12 +86,12 @@
 
                   if (leds_on)
                   {
-                      gpio_write(0x00000000);
+                      gpio_out_clear(0x000F0000);
                       leds_on = 0;
                   }
                   else
                   {
-                      gpio_write(0x000F0000);
+                      gpio_out_set(0x000F0000);
                       leds_on = 1;
                   }
               }
@@ -101,12 +103,18 @@
               /* Detener parpadeo */
               blinking = 0;
               leds_on = 0;
-              gpio_write(0x00000000);
+              gpio_out_clear(0x000F0000);
               btn1_prev = 1;
           }
           else if (!(gpio & PBT_1_MASK))
           {
               btn1_prev = 0;
           }
+
+          /* Volcar los LEDs: un gpio_write como mucho por vuelta */
+          gpio_out_flush();
+
+          /* Enviar registros pendientes por la UART sin bloquear */
+          log_drain();
       }
   }
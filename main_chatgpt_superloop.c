@@ -6,7 +6,9 @@
 #include "clinc.h"
 #include "riscv_monotonic_clock.h"
 
+#include "gpio_out.h"
 #include "log.h"
+#include "time_conv.h"
 
 #define ALL_LEDS     (LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK)
 
@@ -17,6 +19,7 @@ int main(void) {
 
     /* Configuración: Bits 16-19 como salida */
     gpio_set_direction(ALL_LEDS);
+    gpio_out_init(0);
 
     while (1) {
         current_gpio = gpio_read();
@@ -30,9 +33,9 @@ int main(void) {
         /* Detección de flanco de subida (Liberar) */
         else if (!pbt0_now && pbt0_last) {
             uint64_t diff = now - t_start;
-            /* 10 MHz -> diff / 10000 para ms */
-            uint32_t ms = (uint32_t)(diff / 10000);
-            printf("Tiempo pulsado: %u ms\n", ms);
+            /* 10 MHz -> ms sin división de 64 bits */
+            uint32_t ms = (uint32_t)ticks_to_ms(diff);
+            LOG1(LOG_TIEMPO_MS, ms);
 
             if (ms > 1000) {
                 blink_en = 1;
@@ -43,17 +46,23 @@ int main(void) {
         /* Botón 1 para detener el parpadeo */
         if (current_gpio & PBT_1_MASK) {
             blink_en = 0;
-            gpio_write(0); /* Apagar LEDs */
+            gpio_out_clear(ALL_LEDS); /* Apagar LEDs */
         }
 
         /* Lógica de parpadeo no bloqueante (cada 500ms = 5,000,000 ticks) */
         if (blink_en) {
             if ((now - t_last_blink) >= 5000000) {
                 leds_on = !leds_on;
-                gpio_write(leds_on ? ALL_LEDS : 0);
+                gpio_out_assign(ALL_LEDS, leds_on ? ALL_LEDS : 0);
                 t_last_blink = now;
             }
         }
+
+        /* Una escritura del puerto como mucho, y solo si ha cambiado */
+        gpio_out_flush();
+
+        /* Enviar registros pendientes por la UART sin bloquear */
+        log_drain();
     }
     return 0;
 }
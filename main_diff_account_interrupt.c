@@ -6,10 +6,22 @@
 #include "clinc.h"
 #include "riscv_monotonic_clock.h"
 
+#include "gpio_out.h"
+#include "idle.h"
 #include "log.h"
 
+#include "snap64.h"
+#include "swtimer.h"
 
-      /* Contador decreciente */
+/* IDLE = 1: sin registros por enviar, el super-loop duerme con WFI hasta
+   la siguiente IRQ (el timer de 1 ms o un flanco de los botones).
+   IDLE = 0: gira sin parar. */
+#ifndef IDLE
+#define IDLE  (1)
+#endif
+
+      /* Contador decreciente. En RV32 main no lo lee directamente (son
+         dos cargas que la ISR puede partir), sino con snap64_read(). */
       volatile uint64_t counter_ms = (uint64_t)-1;
 
 
@@ -27,6 +39,25 @@
           }
       }
 
+#if IDLE
+      /* IRQ de los botones: solo despierta al bucle del WFI */
+      void gpio_wake(void)
+      {
+      }
+#endif
+
+      /* Temporizadores software movidos desde el bucle (pasos de 1 ms) */
+      static swtimer_wheel_t timers;
+      static swtimer_t blink_timer;
+
+      /* Callback de blink_timer: alternar LEDs en la sombra (el puerto
+         se escribe en el gpio_out_flush() de la vuelta) */
+      static void blink_toggle(void *arg)
+      {
+          (void)arg;
+          gpio_out_toggle(0xF << 16);
+      }
+
       /* Main: mide tiempo entre pulsación y liberación de botón 0,
          enciende LEDs si > 1000 ms y hace parpadeo cada 500 ms hasta
          que se pulse el botón 1. El resto del programa es un super-loop. */
@@ -41,7 +72,6 @@
           volatile uint8_t measuring = 0;    /* true mientras se mantiene pulsado */
           volatile uint8_t leds_on = 0;      /* true si LEDs encendidos por >1s */
           volatile uint8_t blinking = 0;     /* true si en modo parpadeo */
-          volatile uint32_t led_output = 0;   /* valor a escribir en GPIO */
           uint32_t gpio_dir = LED_MASK;       /* configurar solo LEDs como salida */
 
           /* Variables para detección de flancos y parpadeo */
@@ -49,22 +79,31 @@
           uint32_t cur_gpio = 0;
           uint8_t prev_btn0 = 0;
           uint8_t prev_btn1 = 0;
-          uint64_t last_blink_toggle_cnt = 0;
-          const uint64_t BLINK_PERIOD_MS = 500;
+          const uint32_t BLINK_PERIOD_MS = 500;
 
           /* Inicializaciones hardware */
           gpio_set_direction(gpio_dir);       /* LEDs como salida */
-          gpio_write(0);                      /* apagar LEDs inicialmente */
+          gpio_out_init(0);                   /* apagar LEDs inicialmente */
+
+          /* Inicializar contador decreciente muy grande para evitar 0 pronto
+             (antes de habilitar la IRQ: la escritura también son dos
+             mitades) */
+          counter_ms = (uint64_t)0xFFFFFFFFFFFFFFFFULL;
+
+          /* Paso de la rueda = ms transcurridos = ~counter_ms */
+          swtimer_wheel_init(&timers, 0u);
+          swtimer_init(&blink_timer, blink_toggle, NULL);
 
           /* Configurar timer para 1 ms: gap = 10000 ticks (10 MHz clock) */
           install_local_timer_handler(timer_handler);
           local_timer_set_gap(10000);
           enable_timer_clinc_irq();
+#if IDLE
+          install_gpio_handler(gpio_wake);
+          gpio_irq_enable(PBT_0_MASK | PBT_1_MASK);
+#endif
           enable_irq();
 
-          /* Inicializar contador decreciente muy grande para evitar 0 pronto */
-          counter_ms = (uint64_t)0xFFFFFFFFFFFFFFFFULL;
-
           /* Leer estado inicial de botones */
           prev_gpio = gpio_read();
           prev_btn0 = (prev_gpio & PBT_0_MASK) ? 1 : 0;
@@ -74,6 +113,10 @@
           while (1) {
               /* Leer GPIO (botones) */
               cur_gpio = gpio_read();
+              /* Instantánea del contador para toda la vuelta */
+              uint64_t cnt = snap64_read(&counter_ms);
+              /* Vencer los temporizadores hasta el ms actual */
+              swtimer_advance_to(&timers, (uint32_t)~cnt);
               /* Extraer estados booleanos */
               uint8_t cur_btn0 = (cur_gpio & PBT_0_MASK) ? 1 : 0;
               uint8_t cur_btn1 = (cur_gpio & PBT_1_MASK) ? 1 : 0;
@@ -83,14 +126,14 @@
                   /* Flanco de subida: botón 0 acaba de ser pulsado */
                   measuring = 1;
                   /* Guardar contador en el instante de pulsar */
-                  start_cnt = counter_ms;
+                  start_cnt = cnt;
               } else {
                   if (prev_btn0 && !cur_btn0) {
                       /* Flanco de bajada: botón 0 acaba de ser liberado */
                       if (measuring) {
                           measuring = 0;
                           /* Guardar contador en el instante de liberar */
-                          end_cnt = counter_ms;
+                          end_cnt = cnt;
                           /* Calcular tiempo transcurrido en ms.
                              Como counter_ms es decreciente, start_cnt >= end_cnt */
                           uint64_t elapsed_ms = 0;
@@ -100,18 +143,18 @@
                               /* Caso improbable de wrap; manejar como 0 */
                               elapsed_ms = 0;
                           }
-                          /* Imprimir tiempo en ms */
-                          printf("Tiempo pulsado: %u ms\n", (unsigned)elapsed_ms);
+                          /* Imprimir tiempo en ms (cabe en 32 bits) */
+                          LOG1(LOG_TIEMPO_MS, (uint32_t)elapsed_ms);
 
                           /* Si supera 1000 ms, encender LEDs y activar parpadeo */
                           if (elapsed_ms > 1000) {
                               leds_on = 1;
                               blinking = 1;
                               /* Encender LEDs inmediatamente */
-                              led_output = LED_MASK;
-                              gpio_write(led_output);
-                              /* inicializar toggle timer */
-                              last_blink_toggle_cnt = counter_ms;
+                              gpio_out_set(LED_MASK);
+                              /* alternar cada 500 ms a partir de ahora */
+                              swtimer_start(&timers, &blink_timer,
+                                            BLINK_PERIOD_MS, BLINK_PERIOD_MS);
                           } else {
                               /* Si no supera 1s, no cambiar modo parpadeo */
                               /* Mantener estado previo de blinking/leds */
@@ -128,53 +171,20 @@
                   if (blinking || leds_on) {
                       blinking = 0;
                       leds_on = 0;
-                      led_output = 0;
-                      gpio_write(led_output);
+                      swtimer_stop(&timers, &blink_timer);
+                      gpio_out_clear(LED_MASK);
                   }
               } else {
                   /* No flanco en botón 1: nada que hacer */
               }
 
-              /* --- Si estamos en modo parpadeo, alternar cada 500 ms --- */
+              /* --- El parpadeo lo hace blink_timer (cada 500 ms) --- */
               if (blinking) {
-                  /* Calcular tiempo transcurrido desde último toggle */
-                  uint64_t elapsed_since_toggle = 0;
-                  if (last_blink_toggle_cnt >= counter_ms) {
-                      elapsed_since_toggle = last_blink_toggle_cnt - counter_ms;
-                  } else {
-                      /* wrap improbable: resetar referencia */
-                      last_blink_toggle_cnt = counter_ms;
-                      elapsed_since_toggle = 0;
-                  }
-
-                  if (elapsed_since_toggle >= BLINK_PERIOD_MS) {
-                      /* Toggle LEDs */
-                      if (led_output & LED_MASK) {
-                          led_output &= ~LED_MASK; /* apagar LEDs */
-                      } else {
-                          led_output |= LED_MASK;  /* encender LEDs */
-                      }
-                      gpio_write(led_output);
-                      /* actualizar referencia de toggle */
-                      last_blink_toggle_cnt = counter_ms;
-                  } else {
-                      /* No es tiempo de toggle aún */
-                  }
+                  /* Nada que hacer aquí */
               } else {
-                  /* No en parpadeo: si leds_on es true, mantener encendidos */
-                  if (leds_on) {
-                      /* Asegurar LEDs encendidos */
-                      if ((led_output & LED_MASK) == 0) {
-                          led_output |= LED_MASK;
-                          gpio_write(led_output);
-                      }
-                  } else {
-                      /* Asegurar LEDs apagados */
-                      if (led_output & LED_MASK) {
-                          led_output &= ~LED_MASK;
-                          gpio_write(led_output);
-                      }
-                  }
+                  /* No en parpadeo: asegurar LEDs según leds_on (solo en la
+                     sombra; el flush no escribe si no hay cambio) */
+                  gpio_out_assign(LED_MASK, leds_on ? LED_MASK : 0u);
               }
 
               /* Actualizar estados previos para detección de flancos */
@@ -182,9 +192,27 @@
               prev_btn1 = cur_btn1;
               prev_gpio = cur_gpio;
 
-              /* Super-loop ligero: se puede añadir WFI o sleep si la plataforma
-                 lo permite; aquí se mantiene activo para permitir lecturas
-                 frecuentes y que el timer ISR actualice counter_ms. */
+              /* Volcar los LEDs: un gpio_write como mucho por vuelta */
+              gpio_out_flush();
+
+              /* Enviar registros pendientes por la UART sin bloquear */
+              log_drain();
+
+#if IDLE
+              /* Reposo hasta la próxima IRQ. Se comprueba con las IRQ
+                 deshabilitadas: una que llegue en medio queda pendiente y
+                 el WFI vuelve enseguida */
+              idle_poll(get_ticks_from_reset());
+              disable_irq();
+              if (!log_busy()) {
+                  idle_wait();
+              }
+              enable_irq();
+#else
+              /* Super-loop ligero: se mantiene activo para permitir
+                 lecturas frecuentes y que el timer ISR actualice
+                 counter_ms. */
+#endif
           }
 
           /* Nunca se llega aquí */
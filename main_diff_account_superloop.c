@@ -6,7 +6,9 @@
 #include "clinc.h"
 #include "riscv_monotonic_clock.h"
 
+#include "gpio_out.h"
 #include "log.h"
+#include "time_conv.h"
 
 #define TICKS_PER_MS 10000ULL
 #define ONE_SECOND_MS 1000ULL
@@ -24,6 +26,7 @@ int main(void)
     uint8_t leds_on = 0;
 
     gpio_set_direction(LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK);
+    gpio_out_init(0);
 
     while (1)
     {
@@ -38,10 +41,10 @@ int main(void)
         else if (!(buttons & PBT_0_MASK) && button0_prev)
         {
             release_ticks = now_ticks;
-            elapsed_ms =
-                (release_ticks - press_ticks) / TICKS_PER_MS;
+            elapsed_ms = ticks_to_ms(release_ticks - press_ticks);
 
-            printf("Tiempo pulsado: %llu ms\n", elapsed_ms);
+            /* En 32 bits caben 49 días de pulsación. */
+            LOG1(LOG_TIEMPO_MS, (uint32_t)elapsed_ms);
 
             if (elapsed_ms > ONE_SECOND_MS)
             {
@@ -58,24 +61,24 @@ int main(void)
             {
                 last_blink_ticks = now_ticks;
 
-                if (leds_on)
-                {
-                    gpio_write(0);
-                    leds_on = 0;
-                }
-                else
-                {
-                    gpio_write(LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK);
-                    leds_on = 1;
-                }
+                gpio_out_toggle(LED_0_MASK | LED_1_MASK | LED_2_MASK |
+                                LED_3_MASK);
+                leds_on = !leds_on;
             }
 
             if (buttons & PBT_1_MASK)
             {
                 blinking = 0;
                 leds_on = 0;
-                gpio_write(0);
+                gpio_out_clear(LED_0_MASK | LED_1_MASK | LED_2_MASK |
+                               LED_3_MASK);
             }
         }
+
+        /* Volcar los LEDs: un gpio_write como mucho por vuelta. */
+        gpio_out_flush();
+
+        /* Enviar registros pendientes por la UART sin bloquear. */
+        log_drain();
     }
 }
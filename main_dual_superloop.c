@@ -0,0 +1,155 @@
+#include "riscv_types.h"
+#include "riscv_uart.h"
+#include "gpio_drv.h"
+
+#include "riscv_monotonic_clock.h"
+
+#include "amo.h"
+#include "gpio_out.h"
+#include "hart.h"
+#include "log.h"
+#include "mbox.h"
+#include "time_conv.h"
+
+/*
+ * Reparto en dos harts del comportamiento de main_final_superloop.c.
+ *
+ * DUAL_HART = 1: la hart 0 solo muestrea los botones y sella cada flanco
+ * con mtime en un bucle corto y de duración fija; los flancos pasan por
+ * el buzón (mbox.h) a la hart 1, que mide, registra, decide los LEDs y
+ * parpadea. Una impresión lenta (LOG_DEFERRED = 0) ya no retrasa la
+ * siguiente lectura de los botones.
+ *
+ * DUAL_HART = 0: el mismo código en la hart 0 (muestreo y consumo en la
+ * misma vuelta), para comparar; la hart 1 no hace nada.
+ *
+ * Las dos harts entran en main(); la hart 1 espera a que la 0 haya
+ * preparado el puerto y el buzón.
+ */
+#ifndef DUAL_HART
+#define DUAL_HART  (1)
+#endif
+
+#define TICKS_PER_MS  (CLINT_CLOCK / 1000U)
+#define LEDS_ALL (LED_0_MASK|LED_1_MASK|LED_2_MASK|LED_3_MASK)
+#define BLINK_MS   500U
+#define BLINK_TCK  (BLINK_MS * TICKS_PER_MS)
+#define LONG_MS    1000U
+
+/* Botones muestreados (el índice es btn_event_t.btn). */
+#define N_BTN  2u
+
+static const uint32_t btn_mask[N_BTN] = { PBT_0_MASK, PBT_1_MASK };
+
+static mbox_t     mbox;
+static amo_flag_t ready;
+
+/* ------------------------------------------------------------------ */
+/* Hart 0: muestreo                                                    */
+/* ------------------------------------------------------------------ */
+
+/* Sella y envía los flancos de 'pins' respecto a '*prev'. */
+static void sample(uint32_t *prev, uint32_t pins, uint64_t now)
+{
+  uint32_t chg = (pins ^ *prev);
+  uint8_t b;
+
+  for (b = 0; b < N_BTN; b++) {
+    if (chg & btn_mask[b]) {
+      btn_event_t ev;
+
+      ev.tick = now;
+      ev.btn = b;
+      ev.edge = (pins & btn_mask[b]) ? BTN_EDGE_PRESS : BTN_EDGE_RELEASE;
+      (void)mbox_push(&mbox, &ev);
+    }
+  }
+  *prev = pins;
+}
+
+/* ------------------------------------------------------------------ */
+/* Hart 1: medida, registro y LEDs                                     */
+/* ------------------------------------------------------------------ */
+
+static uint8_t  b0_measuring = 0;
+static uint64_t t_press = 0;
+static uint8_t  blink = 0;
+static uint64_t blink_last = 0;
+
+static void consume(uint64_t now)
+{
+  btn_event_t ev;
+
+  while (mbox_pop(&mbox, &ev)) {
+    /* BTN0: medir la pulsación; si dura >= 1 s, encender y parpadear. */
+    if (ev.btn == 0u) {
+      if (ev.edge == BTN_EDGE_PRESS) {
+        b0_measuring = 1;
+        t_press = ev.tick;
+      } else if (b0_measuring) {
+        uint32_t ms = (uint32_t)ticks_to_ms(ev.tick - t_press);
+
+        b0_measuring = 0;
+        LOG1(LOG_BTN0_MS, ms);
+        if (ms >= LONG_MS) {
+          gpio_out_set(LEDS_ALL);
+          blink = 1;
+          blink_last = now;
+        }
+      }
+    }
+
+    /* BTN1: detener el parpadeo. */
+    if ((ev.btn == 1u) && (ev.edge == BTN_EDGE_PRESS) && blink) {
+      blink = 0;
+      gpio_out_clear(LEDS_ALL);
+    }
+  }
+
+  /* Parpadeo no bloqueante. */
+  if (blink && (now - blink_last) >= BLINK_TCK) {
+    blink_last = now;
+    gpio_out_toggle(LEDS_ALL);
+  }
+
+  gpio_out_flush();
+  log_drain();
+}
+
+/* ------------------------------------------------------------------ */
+/* Arranque                                                            */
+/* ------------------------------------------------------------------ */
+
+int main(void)
+{
+  if (hart_id() != 0u) {
+#if DUAL_HART
+    while (!amo_flag_test(&ready)) {
+      (void)get_ticks_from_reset();
+    }
+    while (1) {
+      consume(get_ticks_from_reset());
+    }
+#endif
+    return 0;
+  }
+
+  gpio_set_direction(LEDS_ALL);
+  gpio_out_init(gpio_read() & ~LEDS_ALL);
+  mbox_init(&mbox);
+
+  uint32_t prev = gpio_read();
+  amo_flag_set(&ready);
+
+  while (1) {
+    uint64_t now = get_ticks_from_reset();
+    uint32_t pins = gpio_read();
+
+    sample(&prev, pins, now);
+#if !DUAL_HART
+    consume(now);
+#endif
+  }
+
+  return 0;
+}
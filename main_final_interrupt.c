@@ -6,19 +6,105 @@
 #include "clinc.h"
 #include "riscv_monotonic_clock.h"
 
+#include "amo.h"
+#include "console.h"
+#include "gpio_out.h"
+#include "idle.h"
+#include "instr.h"
+#include "lacap.h"
 #include "log.h"
 
+#include "evring.h"
+#include "oneshot.h"
+#include "snap64.h"
+#include "swtimer.h"
+#include "time_conv.h"
+
 
 /* ------------------------------------------------------------------ */
 /* Configuración de timer y parpadeo                                   */
 /* ------------------------------------------------------------------ */
+/* TIMER_TICKLESS = 1: la IRQ se programa solo para el próximo plazo real
+ * (la siguiente conmutación de LEDs) y las marcas de tiempo se leen de
+ * mtime. Unas 2 IRQ/s parpadeando y ninguna en reposo.
+ * TIMER_TICKLESS = 0: IRQ periódica de 1 ms (1000 IRQ/s siempre).
+ * Con LACAP_ENABLE (lacap.h) el timer es periódico a LACAP_PERIOD_US:
+ * cada IRQ toma una muestra del puerto y una de cada IRQS_PER_STEP da el
+ * paso de 1 ms de siempre.                                              */
+#ifndef TIMER_TICKLESS
+#define TIMER_TICKLESS   (!LACAP_ENABLE)
+#endif
+
+#if TIMER_TICKLESS && LACAP_ENABLE
+#error "LACAP_ENABLE necesita TIMER_TICKLESS = 0"
+#endif
+
+/* EDGE_CAPTURE = 1: los flancos de PBT_0/PBT_1 se capturan en gpio_isr
+ * leyendo mtime como primera acción y las duraciones se informan en us.
+ * Error de captura de cada flanco: la latencia de entrada a la ISR
+ * (constante salvo variaciones del núcleo) más, si coincide con
+ * timer_handler, lo que quede de este (las ISR no se anidan), más la
+ * resolución de mtime (0,1 us). En la duración se cancela la parte
+ * constante: |error| <= duración máx. de timer_handler + 0,1 us
+ * (1,5 us en el simulador: 14 ticks). Sin ISR de timer en curso, 0,1 us.
+ * EDGE_CAPTURE = 0: sondeo en el bucle con resolución de 1 ms.          */
+#ifndef EDGE_CAPTURE
+#define EDGE_CAPTURE     (1)
+#endif
+
+/* IDLE = 1: sin trabajo pendiente, el bucle duerme con WFI (idle.h) hasta
+ * la siguiente IRQ: cambio en un botón (también sin EDGE_CAPTURE, con un
+ * manejador vacío que solo despierta), plazo del timer o, con la
+ * consola, byte recibido. Mientras quedan registros por enviar no
+ * duerme (la transmisión de la UART no tiene IRQ), ni con bytes u
+ * órdenes de la consola por procesar.
+ * IDLE = 0: el bucle gira sin parar.                                    */
+#ifndef IDLE
+#define IDLE             (1)
+#endif
+
+/* Cada ISR_REPORT_MS el bucle informa (LOG_TIMER_RATE) de la tasa media
+ * de entradas a timer_handler en ese intervalo; sale en la primera
+ * vuelta tras vencerlo, como el informe de idle.h.                      */
+#ifndef ISR_REPORT_MS
+#define ISR_REPORT_MS    (60000u)
+#endif
+
 #define GAP_TICKS        (10000u)             /* 1 ms a 10 MHz           */
-#define MS_PER_TICK      (1u)                 /* 1 ms por interrupción   */
+#define MS_PER_TICK      (1u)                 /* 1 ms por paso           */
+
+#if LACAP_ENABLE
+#define TIMER_GAP        (LACAP_PERIOD_TICKS)
+#define IRQS_PER_STEP    (GAP_TICKS / LACAP_PERIOD_TICKS)
+#if (GAP_TICKS % LACAP_PERIOD_TICKS) != 0
+#error "LACAP_PERIOD_US debe dividir 1 ms"
+#endif
+#else
+#define TIMER_GAP        (GAP_TICKS)
+#endif
 #define BLINK_HALF_MS    (500u)               /* Parpadeo cada 500 ms    */
+#define LONG_MS          (1000u)              /* Pulsación larga: 1 s    */
+
+#define TICKS_PER_MS     (CLINT_CLOCK / 1000u)
 
 /* Máscaras de LEDs (se asume que LED_?_MASK están definidas). */
 #define LED_MASK (LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK)
 
+/* Pines que despiertan del reposo (también los que piden un volcado). */
+#if INSTR_ENABLE
+#define WAKE_INSTR (INSTR_DUMP_MASK)
+#else
+#define WAKE_INSTR (0u)
+#endif
+
+#if LACAP_ENABLE
+#define WAKE_LACAP (LACAP_DUMP_MASK)
+#else
+#define WAKE_LACAP (0u)
+#endif
+
+#define WAKE_MASK (PBT_0_MASK | PBT_1_MASK | WAKE_INSTR | WAKE_LACAP)
+
 /* ------------------------------------------------------------------ */
 /* Variables globales usadas en main() e ISR                           */
 /* ------------------------------------------------------------------ */
@@ -28,20 +114,207 @@ volatile uint32_t counter = 0;
 volatile uint32_t ms_now = 0;
 /* Reloj de software en milisegundos (res. 1 ms).                       */
 
-volatile uint32_t blink_accum = 0;
-/* Acumula ms para conmutar LEDs cada 500 ms cuando parpadean.          */
+#if !TIMER_TICKLESS
+static swtimer_wheel_t timers;
+/* Temporizadores software: un paso por IRQ (1 ms).                     */
+
+static swtimer_t blink_timer;
+/* Conmuta los LEDs cada 500 ms mientras parpadean.                     */
+#endif
+
+amo_mask_t blink_req;
+/* Peticiones de main a timer_handler, el único que toca la rueda y
+ * blink_deadline: BLINK_REQ_STATE, arrancar (desde cero) o parar según
+ * 'blinking' (en tickless, solo arrancar desde blink_origin);
+ * BLINK_REQ_PERIOD, aplicar un blink_half_ms nuevo (con la rueda).     */
+#define BLINK_REQ_STATE  (1u << 0)
+#define BLINK_REQ_PERIOD (1u << 1)
+
+amo_flag_t blinking;
+/* 0 = sin parpadeo; 1 = parpadeando (lo cambia main, lo lee la ISR).   */
+
+#if TIMER_TICKLESS
+static uint64_t blink_deadline = 0;
+/* Modo tickless: instante (ticks) de la próxima conmutación de LEDs.
+ * Solo lo usa timer_handler.                                           */
+
+seq64_t blink_origin;
+/* Modo tickless: instante del último arranque del parpadeo. Lo escribe
+ * main con el one-shot desarmado, así que timer_handler nunca interrumpe
+ * la escritura (condición de seq64_t) ni ve un valor a medias.        */
+#endif
+
+volatile uint32_t long_ms = LONG_MS;
+volatile uint32_t blink_half_ms = BLINK_HALF_MS;
+/* Umbral de pulsación larga y semiperiodo del parpadeo; los puede
+ * cambiar la consola (console.h) desde main y timer_handler lee
+ * blink_half_ms. Una palabra alineada: lectura y escritura atómicas.   */
+
+static inline uint64_t blink_half_ticks(void)
+{
+    return (uint64_t)blink_half_ms * TICKS_PER_MS;
+}
+
+amo_count_t isr_count;
+/* Entradas a timer_handler desde el arranque.                         */
 
-volatile uint8_t blinking = 0;
-/* 0 = sin parpadeo; 1 = parpadeando.                                   */
+#if EDGE_CAPTURE
+static evring_t btn_events;
+/* Flancos capturados en gpio_isr (instante y botón) hacia main.        */
+
+static uint32_t cap_pins = 0;
+/* Último estado de los botones visto por gpio_isr.                     */
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Tiempo actual en ms y tasa de interrupciones                        */
+/* ------------------------------------------------------------------ */
+static uint32_t now_ms(void)
+{
+#if TIMER_TICKLESS || EDGE_CAPTURE
+    /* mtime es la base de tiempo en ambos modos. */
+    return (uint32_t)ticks_to_ms(get_ticks_from_reset());
+#else
+    return ms_now;
+#endif
+}
 
-volatile uint32_t led_out = 0;
-/* Imagen de salida solo con bits LED_MASK.                             */
+/* Cada ISR_REPORT_MS, registra las entradas por segundo a la ISR. */
+static void report_isr_rate(uint32_t t_ms)
+{
+    static uint32_t win_start_ms = 0u;
+    static uint32_t win_count = 0u;
+    uint32_t span = t_ms - win_start_ms;
+
+    if (span >= ISR_REPORT_MS) {
+        uint32_t count = amo_count_load(&isr_count);
+
+        LOG2(LOG_TIMER_RATE,
+             (uint32_t)(((uint64_t)(count - win_count) * 1000u) / span),
+             span);
+        win_count = count;
+        win_start_ms = t_ms;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Arranque y parada del parpadeo                                      */
+/* ------------------------------------------------------------------ */
+/* Toggle de los 4 LEDs: XOR sobre la sombra de salida (gpio_out.h). */
+static void blink_toggle(void *arg)
+{
+    (void)arg;
+    gpio_out_toggle(LED_MASK);
+}
+
+static void blink_start(void)
+{
+    amo_flag_set(&blinking);
+
+    /* Encender inicialmente los 4 LEDs. */
+    gpio_out_set(LED_MASK);
+
+#if TIMER_TICKLESS
+    {
+        uint64_t t0 = get_ticks_from_reset();
+
+        /* Si ya parpadeaba, el one-shot sigue armado: desarmarlo antes de
+         * publicar el origen nuevo. La primera conmutación (dentro de
+         * 500 ms) la calcula timer_handler a partir de él. */
+        oneshot_disarm();
+        seq64_write(&blink_origin, t0);
+        (void)amo_mask_set(&blink_req, BLINK_REQ_STATE);
+        oneshot_arm_at(t0 + blink_half_ticks());
+    }
+#else
+    /* La rueda es de timer_handler: lo arranca en su próximo paso, antes
+     * de avanzarla, así que el plazo es el mismo que arrancándolo aquí. */
+    (void)amo_mask_set(&blink_req, BLINK_REQ_STATE);
+#endif
+}
+
+static void blink_stop(void)
+{
+    amo_flag_clear(&blinking);
+#if TIMER_TICKLESS
+    oneshot_disarm();
+#else
+    (void)amo_mask_set(&blink_req, BLINK_REQ_STATE);
+#endif
+    gpio_out_clear(LED_MASK);
+}
 
 /* ------------------------------------------------------------------ */
 /* Rutina de servicio de interrupción del timer                        */
 /* ------------------------------------------------------------------ */
+#if LACAP_ENABLE
+/* 1 si esta IRQ completa un paso de 1 ms (divisor de la IRQ rápida). */
+static inline uint8_t timer_step(void)
+{
+    static uint32_t sub = 0u;
+
+    if (++sub < IRQS_PER_STEP) {
+        return 0u;
+    }
+    sub = 0u;
+    return 1u;
+}
+#else
+#define timer_step()  (1u)
+#endif
+
+#if !TIMER_TICKLESS
+/* Aplica las peticiones de main a la rueda (ver blink_req). El estado
+ * final lo da 'blinking', así que un arranque y una parada seguidos sin
+ * paso entre medias no dependen del orden en que se vean los bits. */
+static void blink_apply_requests(void)
+{
+    uint32_t req = amo_mask_clear(&blink_req,
+                                  BLINK_REQ_STATE | BLINK_REQ_PERIOD);
+
+    if ((req & BLINK_REQ_STATE) ||
+        ((req & BLINK_REQ_PERIOD) && swtimer_active(&blink_timer))) {
+        if (amo_flag_test(&blinking)) {
+            swtimer_start(&timers, &blink_timer,
+                          blink_half_ms / MS_PER_TICK,
+                          blink_half_ms / MS_PER_TICK);
+        } else {
+            swtimer_stop(&timers, &blink_timer);
+        }
+    }
+}
+#endif
+
 void timer_handler(void)
 {
+    INSTR_ISR_ENTER();
+
+    (void)amo_count_inc(&isr_count);
+
+    /* Muestra del analizador lógico, lo antes posible tras la entrada. */
+    LACAP_SAMPLE(gpio_read());
+
+#if TIMER_TICKLESS
+    /* Solo se llega aquí en un plazo de parpadeo: conmutar y programar
+     * el siguiente a partir del plazo anterior, sin acumular deriva. */
+    if (amo_flag_test(&blinking)) {
+        /* Primer plazo tras un arranque: desde el origen de main. */
+        if (amo_mask_clear(&blink_req, BLINK_REQ_STATE) & BLINK_REQ_STATE) {
+            blink_deadline = seq64_read(&blink_origin) + blink_half_ticks();
+        }
+        blink_toggle(NULL);
+
+        blink_deadline += blink_half_ticks();
+        oneshot_arm_at(blink_deadline);
+    } else {
+        oneshot_disarm();
+    }
+#else
+    if (!timer_step()) {
+        INSTR_ISR_EXIT();
+        return;
+    }
+
     /* Estructura solicitada en el enunciado. */
     if (counter != 0u) {
         counter--;
@@ -53,27 +326,150 @@ void timer_handler(void)
     /* Tictac de software: cada IRQ suma 1 ms. */
     ms_now += MS_PER_TICK;
 
-    /* Gestión del parpadeo sin bloquear la medición de pulsaciones. */
-    if (blinking) {
-        blink_accum += MS_PER_TICK;
+    /* Temporizadores software (parpadeo) sin bloquear la medición: las
+     * peticiones de main se aplican con la rueda aún en el paso anterior. */
+    blink_apply_requests();
+    swtimer_tick(&timers);
+#endif
+
+    /* Conmutación en el instante del plazo, sin esperar a main. */
+    gpio_out_flush();
+
+    INSTR_ISR_EXIT();
+}
+
+#if EDGE_CAPTURE
+/* ------------------------------------------------------------------ */
+/* Captura de flancos de los botones                                   */
+/* ------------------------------------------------------------------ */
+void gpio_isr(void)
+{
+    /* Lo primero: sellar el instante del flanco. */
+    uint64_t tick = get_ticks_from_reset();
+    INSTR_ISR_ENTER();
+    uint32_t pins = gpio_read() & (PBT_0_MASK | PBT_1_MASK);
+    uint32_t changed = pins ^ cap_pins;
+    btn_event_t ev;
+
+    cap_pins = pins;
+    ev.tick = tick;
+
+    /* Un evento por botón que ha cambiado. */
+    while (changed != 0u) {
+        uint32_t bit = changed & (0u - changed);
+
+        ev.btn = (bit == PBT_0_MASK) ? 0u : 1u;
+        ev.edge = (pins & bit) ? BTN_EDGE_PRESS : BTN_EDGE_RELEASE;
+        (void)evring_push(&btn_events, &ev);
+        changed &= ~bit;
+    }
 
-        /* Conmuta LEDs cada 500 ms. */
-        if (blink_accum >= BLINK_HALF_MS) {
-            blink_accum = 0u;
+    INSTR_ISR_EXIT();
+}
 
-            /* Toggle de los 4 LEDs: XOR sobre la imagen de salida. */
-            led_out ^= LED_MASK;
+/* Medida (en us) y política de LEDs a partir de un flanco capturado. */
+static void on_edge(const btn_event_t *ev)
+{
+    static uint8_t measuring = 0u;
+    static uint64_t t_press = 0u;
 
-            /* Aplicar nuevo estado a los LEDs. */
-            gpio_write(led_out);
+    if (ev->btn == 0u) {
+        if (ev->edge == BTN_EDGE_PRESS) {
+            measuring = 1u;
+            t_press = ev->tick;
+        } else if (measuring == 1u) {
+            uint64_t dt = ev->tick - t_press;
+            uint64_t us = ticks_to_us(dt);
+
+            measuring = 0u;
+            /* El log es de 32 bits: satura a partir de ~71 min. */
+            LOG1(LOG_PULSADOR0_US,
+                 (us > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)us);
+
+            /* Si >= long_ms: encender LEDs y comenzar parpadeo. Se
+             * compara en ticks de 64 bits: ni la duración ni el umbral
+             * desbordan. */
+            if (dt >= (uint64_t)long_ms * TICKS_PER_MS) {
+                blink_start();
+            }
         }
     } else {
-        /* Si no hay parpadeo, asegurar que el acumulador no crece. */
-        if (blink_accum != 0u) {
-            blink_accum = 0u;
+        /* Pulsación de PBT_1: detener parpadeo y apagar LEDs. */
+        if ((ev->edge == BTN_EDGE_PRESS) && amo_flag_test(&blinking)) {
+            blink_stop();
         }
     }
 }
+#elif IDLE
+/* Sin captura de flancos, la IRQ de GPIO solo saca al bucle del WFI. */
+void gpio_wake(void)
+{
+}
+#endif
+
+#if CONSOLE_ENABLE
+/* ------------------------------------------------------------------ */
+/* Consola (console.h)                                                 */
+/* ------------------------------------------------------------------ */
+/* CONSOLE_ENABLE = 1: órdenes por la UART (console.h) para leer y
+ * cambiar long_ms y blink_ms, volcar y poner a cero los histogramas de
+ * instr.h (con INSTR_ENABLE) y manejar la captura de lacap.h (con
+ * LACAP_ENABLE). Una pasada acotada de la consola por vuelta.           */
+
+/* Con la rueda de temporizadores, timer_handler aplica el periodo nuevo
+ * rearrancando el parpadeo en curso; sin ella lo toma en la siguiente
+ * conmutación. */
+static void con_changed(uint8_t p)
+{
+#if !TIMER_TICKLESS
+    if (p == CONSOLE_P_BLINK_MS) {
+        (void)amo_mask_set(&blink_req, BLINK_REQ_PERIOD);
+    }
+#else
+    (void)p;
+#endif
+}
+
+#if INSTR_ENABLE
+static void con_stats(void)
+{
+    instr_dump();
+}
+
+static void con_reset(void)
+{
+    instr_reset();
+}
+#endif
+
+#if LACAP_ENABLE
+static void con_cap(uint8_t op)
+{
+    if (op == CONSOLE_CAP_START) {
+        lacap_start();
+    } else if (op == CONSOLE_CAP_STOP) {
+        lacap_stop();
+    } else {
+        lacap_dump();
+    }
+}
+#endif
+
+static const console_cfg_t con_cfg = {
+    { &long_ms, &blink_half_ms, NULL },
+    con_changed,
+#if INSTR_ENABLE
+    con_stats, con_reset,
+#else
+    NULL, NULL,
+#endif
+#if LACAP_ENABLE
+    con_cap,
+#else
+    NULL,
+#endif
+};
+#endif /* CONSOLE_ENABLE */
 
 /* ------------------------------------------------------------------ */
 /* Función principal                                                   */
@@ -81,6 +477,9 @@ void timer_handler(void)
 int main(void)
 {
     uint32_t dir = 0u;
+    uint32_t t_ms = 0u;
+
+#if !EDGE_CAPTURE
     uint32_t pins = 0u;
 
     uint8_t btn0_prev = 0u;
@@ -92,25 +491,69 @@ int main(void)
     uint32_t t_start_ms = 0u;
     uint32_t t_end_ms = 0u;
     uint32_t elapsed_ms = 0u;
+#endif
 
     /* Configurar como salida exclusivamente los bits 16-19 (LEDs 0-3). */
     dir = LED_MASK;
     gpio_set_direction(dir);
 
     /* Apagar LEDs al inicio. */
-    led_out = 0u;
-    gpio_write(led_out);
-
-    /* Instalar y habilitar el timer con el gap de 1 ms (10 000 ticks). */
+    gpio_out_init(0u);
+
+#if EDGE_CAPTURE
+    /* Interrupción por cambio en PBT_0 y PBT_1. */
+    evring_init(&btn_events);
+    cap_pins = gpio_read() & (PBT_0_MASK | PBT_1_MASK);
+    install_gpio_handler(gpio_isr);
+    gpio_irq_enable(IDLE ? WAKE_MASK : (PBT_0_MASK | PBT_1_MASK));
+#elif IDLE
+    install_gpio_handler(gpio_wake);
+    gpio_irq_enable(WAKE_MASK);
+#endif
+
+#if CONSOLE_ENABLE
+    /* Órdenes por la UART: la ISR solo encola los bytes. */
+    console_init(&con_cfg);
+    install_uart_rx_handler(console_rx_isr);
+#endif
+
+#if TIMER_TICKLESS
+    /* Instalar el timer desarmado: se programa al empezar a parpadear. */
     install_local_timer_handler(timer_handler);
-    local_timer_set_gap(GAP_TICKS);
+    oneshot_disarm();
+    enable_irq();
+#else
+    /* Instalar y habilitar el timer con el gap de 1 ms (10 000 ticks) o
+     * el periodo de muestreo de lacap.h. */
+    swtimer_wheel_init(&timers, 0u);
+    swtimer_init(&blink_timer, blink_toggle, NULL);
+    install_local_timer_handler(timer_handler);
+    local_timer_set_gap(TIMER_GAP);
     enable_timer_clinc_irq();
     enable_irq();
+#endif
 
     /* Bucle principal: solo lógica con if-else y lectura de GPIO. */
     while (1) {
+        t_ms = now_ms();
+        report_isr_rate(t_ms);
+
+        INSTR_LOOP(get_ticks_from_reset());
+
+#if EDGE_CAPTURE
+        btn_event_t ev;
+
+        /* Flancos capturados por gpio_isr, en orden. */
+        while (evring_pop(&btn_events, &ev)) {
+            INSTR_EDGE(ev.tick, get_ticks_from_reset());
+            on_edge(&ev);
+        }
+#else
         pins = gpio_read();
 
+        INSTR_EDGE_POLLED(((pins & PBT_0_MASK) ? 1u : 0u) != btn0_prev ||
+                          ((pins & PBT_1_MASK) ? 1u : 0u) != btn1_prev);
+
         /* Supuesto: botones activos a '1'. Cambiar si son activos a '0'. */
         btn0_now = (pins & PBT_0_MASK) ? 1u : 0u;
         btn1_now = (pins & PBT_1_MASK) ? 1u : 0u;
@@ -118,13 +561,13 @@ int main(void)
         /* Flanco de subida en botón 0: comienza medición. */
         if ((btn0_prev == 0u) && (btn0_now == 1u)) {
             measuring = 1u;
-            t_start_ms = ms_now;
+            t_start_ms = t_ms;
         } else {
             /* Flanco de bajada en botón 0: termina medición. */
             if ((btn0_prev == 1u) && (btn0_now == 0u)) {
                 if (measuring == 1u) {
                     measuring = 0u;
-                    t_end_ms = ms_now;
+                    t_end_ms = t_ms;
 
                     /* Tiempo pulsado en ms (resolución 1 ms). */
                     if (t_end_ms >= t_start_ms) {
@@ -135,17 +578,11 @@ int main(void)
                     }
 
                     /* Imprime el tiempo pulsado en ms. */
-                    printf("Pulsador 0: %u ms\r\n",
-                           (unsigned)elapsed_ms);
+                    LOG1(LOG_PULSADOR0_MS, elapsed_ms);
 
                     /* Si >= 1 s: encender LEDs y comenzar parpadeo. */
-                    if (elapsed_ms >= 1000u) {
-                        blinking = 1u;
-                        blink_accum = 0u;
-
-                        /* Encender inicialmente los 4 LEDs. */
-                        led_out = LED_MASK;
-                        gpio_write(led_out);
+                    if (elapsed_ms >= long_ms) {
+                        blink_start();
                     }
                 }
             } else {
@@ -155,11 +592,8 @@ int main(void)
 
         /* Flanco de subida en botón 1: detener parpadeo y apagar LEDs. */
         if ((btn1_prev == 0u) && (btn1_now == 1u)) {
-            if (blinking == 1u) {
-                blinking = 0u;
-                blink_accum = 0u;
-                led_out = 0u;
-                gpio_write(led_out);
+            if (amo_flag_test(&blinking)) {
+                blink_stop();
             }
         } else {
             /* No hay flanco de subida en botón 1. */
@@ -168,8 +602,33 @@ int main(void)
         /* Actualizar memoria de estado de botones. */
         btn0_prev = btn0_now;
         btn1_prev = btn1_now;
+#endif
+
+        /* Volcar los LEDs: un gpio_write como mucho por vuelta. */
+        gpio_out_flush();
+
+        /* Enviar registros pendientes por la UART sin bloquear. */
+        log_drain();
+        INSTR_POLL();
+        LACAP_POLL();
+        CONSOLE_POLL();
 
         /* Bucle sin bloqueos: la temporización real va en la ISR. */
+#if IDLE
+        idle_poll(get_ticks_from_reset());
+
+        /* Comprobar y dormir con las IRQ deshabilitadas: un flanco que
+         * llegue en medio deja la IRQ pendiente y el WFI no se detiene. */
+        disable_irq();
+#if EDGE_CAPTURE
+        if (evring_empty(&btn_events) && !log_busy() && !CONSOLE_BUSY()) {
+#else
+        if (!log_busy() && !CONSOLE_BUSY()) {
+#endif
+            idle_wait();
+        }
+        enable_irq();
+#endif
     }
 
     /* No se debe llegar aquí. */
@@ -6,12 +6,190 @@
 #include "clinc.h"
 #include "riscv_monotonic_clock.h"
 
+#include "console.h"
+#include "instr.h"
 #include "log.h"
+#include "pstats.h"
+#include "time_conv.h"
+
+/* FSM_TABLE = 1: el comportamiento es la tabla 'leds_table' ejecutada por
+ * el motor de fsm.h. FSM_TABLE = 0: versión escrita a mano (referencia
+ * para comparar el coste por vuelta del bucle). */
+#ifndef FSM_TABLE
+#define FSM_TABLE  (1)
+#endif
+
+/* SCHED = 1 (solo con FSM_TABLE): el muestreo y el vaciado del log son
+ * tareas del planificador de coop_sched.h, cada una con su periodo y su plazo;
+ * el muestreo pasa a ser cada 50 us en lugar de en cada vuelta.
+ * SCHED = 0 (por defecto): el super-loop, que lee los botones en cada
+ * vuelta. */
+#ifndef SCHED
+#define SCHED  (0)
+#endif
+
+/* CONSOLE_ENABLE = 1 (solo con FSM_TABLE): órdenes por la UART
+ * (console.h) para leer y cambiar long_ms y blink_ms en la tabla del
+ * motor, y volcar o poner a cero las estadísticas (planificador, y las
+ * de instr.h y pstats.h si están activas). La consola hace una pasada
+ * acotada en la tarea del log o en cada vuelta del super-loop. */
+#if CONSOLE_ENABLE && !FSM_TABLE
+#error "CONSOLE_ENABLE necesita FSM_TABLE = 1"
+#endif
+
+#if FSM_TABLE
+#include "fsm.h"
+#if SCHED
+#include "coop_sched.h"
+#endif
+#else
+#include "gpio_out.h"
+#endif
 
 #define TICKS_PER_MS  (CLINT_CLOCK / 1000U)
 #define LEDS_ALL (LED_0_MASK|LED_1_MASK|LED_2_MASK|LED_3_MASK)
 #define BLINK_MS   500U
 #define BLINK_TCK  (BLINK_MS * TICKS_PER_MS)
+#define LONG_MS    1000U
+
+/* Tareas: muestreo cada 50 us (resolución de las medidas) y vaciado del
+ * log cada medio carácter a 115200 baudios. */
+#define SAMPLE_TCK  (50U * (TICKS_PER_MS / 1000U))
+#define LOG_TCK     ((CLINT_CLOCK * 5U) / 115200U)
+
+#if FSM_TABLE
+
+/* Estados del grupo de LEDs. */
+enum { ST_REPOSO, ST_PARPADEO, ST_N };
+
+/* Eventos: BTN0 y BTN1 (pulsar, soltar corto, soltar largo) y periodo. */
+#define N_BTN  2u
+#define EV_N   FSM_N_EVENTS(N_BTN)
+
+#define R  FSM_ACT_REPORT
+#define ON (FSM_ACT_LED_ON | FSM_ACT_TICK_START)
+#define T  FSM_ACT_LED_TOGGLE
+#define OFF (FSM_ACT_LED_OFF | FSM_ACT_TICK_STOP)
+
+/* Medir BTN0; si dura >= 1 s, encender y parpadear; BTN1 lo detiene. */
+static const fsm_tr_t leds_table[ST_N * EV_N] = {
+  /* ST_REPOSO */
+  [ST_REPOSO * EV_N + FSM_EV_PRESS(0)]  = { 0,      ST_REPOSO   },
+  [ST_REPOSO * EV_N + FSM_EV_SHORT(0)]  = { R,      ST_REPOSO   },
+  [ST_REPOSO * EV_N + FSM_EV_LONG(0)]   = { R | ON, ST_PARPADEO },
+  [ST_REPOSO * EV_N + FSM_EV_PRESS(1)]  = { 0,      ST_REPOSO   },
+  [ST_REPOSO * EV_N + FSM_EV_SHORT(1)]  = { 0,      ST_REPOSO   },
+  [ST_REPOSO * EV_N + FSM_EV_LONG(1)]   = { 0,      ST_REPOSO   },
+  [ST_REPOSO * EV_N + FSM_EV_TICK(N_BTN)] = { 0,    ST_REPOSO   },
+  /* ST_PARPADEO */
+  [ST_PARPADEO * EV_N + FSM_EV_PRESS(0)] = { 0,      ST_PARPADEO },
+  [ST_PARPADEO * EV_N + FSM_EV_SHORT(0)] = { R,      ST_PARPADEO },
+  [ST_PARPADEO * EV_N + FSM_EV_LONG(0)]  = { R | ON, ST_PARPADEO },
+  [ST_PARPADEO * EV_N + FSM_EV_PRESS(1)] = { OFF,    ST_REPOSO   },
+  [ST_PARPADEO * EV_N + FSM_EV_SHORT(1)] = { 0,      ST_PARPADEO },
+  [ST_PARPADEO * EV_N + FSM_EV_LONG(1)]  = { 0,      ST_PARPADEO },
+  [ST_PARPADEO * EV_N + FSM_EV_TICK(N_BTN)] = { T,   ST_PARPADEO },
+};
+
+#undef R
+#undef ON
+#undef T
+#undef OFF
+
+/* Umbral y periodo ajustables (consola): la tabla de botones y la de
+ * grupos no son const. */
+static fsm_button_t leds_buttons[N_BTN] = {
+  { PBT_0_MASK, (uint64_t)LONG_MS * TICKS_PER_MS, LOG_BTN0_MS },
+  { PBT_1_MASK, (uint64_t)LONG_MS * TICKS_PER_MS, LOG_BTN1_MS },
+};
+
+static fsm_group_t leds_groups[] = {
+  { leds_table, LEDS_ALL, BLINK_TCK },
+};
+
+static const fsm_cfg_t leds_cfg = {
+  leds_buttons, N_BTN, leds_groups, 1u
+};
+
+static fsm_t fsm;
+
+#if CONSOLE_ENABLE
+/* Valores en ms de la consola (rango en console.h); con_changed los
+ * pasa a las tablas en ticks de 64 bits. */
+static uint32_t long_ms = LONG_MS;
+static uint32_t blink_ms = BLINK_MS;
+
+/* Valores nuevos: desde la próxima pulsación o conmutación. */
+static void con_changed(uint8_t p)
+{
+  uint8_t b;
+
+  if (p == CONSOLE_P_LONG_MS) {
+    for (b = 0u; b < N_BTN; b++) {
+      leds_buttons[b].long_ticks = (uint64_t)long_ms * TICKS_PER_MS;
+    }
+  } else {
+    leds_groups[0].period = (uint64_t)blink_ms * TICKS_PER_MS;
+  }
+}
+
+static void con_stats(void)
+{
+#if SCHED
+  sched_log_stats();
+#endif
+#if INSTR_ENABLE
+  instr_dump();
+#endif
+#if PSTATS_ENABLE
+  pstats_dump();
+#endif
+}
+
+static void con_reset(void)
+{
+#if SCHED
+  sched_reset_stats();
+#endif
+#if INSTR_ENABLE
+  instr_reset();
+#endif
+  pstats_reset();
+}
+
+static const console_cfg_t con_cfg = {
+  { &long_ms, &blink_ms, NULL },
+  con_changed, con_stats, con_reset, NULL
+};
+#endif /* CONSOLE_ENABLE */
+
+#if SCHED
+
+/* Última lectura, para los volcados bajo demanda. */
+static uint32_t pins_last;
+
+static void task_sample(uint64_t now)
+{
+  uint32_t pins = gpio_read();
+
+  INSTR_LOOP(now);
+  INSTR_EDGE_POLLED((pins & fsm.btn_mask) != fsm.prev);
+
+  fsm_step(&fsm, pins, now);
+  pins_last = pins;
+}
+
+/* Enviar registros pendientes por la UART sin bloquear. */
+static void task_log(uint64_t now)
+{
+  (void)now;
+  log_drain();
+  INSTR_POLL_PINS(pins_last);
+  PSTATS_POLL(pins_last);
+  CONSOLE_POLL();
+}
+
+#endif /* SCHED */
 
 int main(void)
 {
@@ -21,6 +199,52 @@ int main(void)
   out_shadow &= ~LEDS_ALL;
   gpio_write(out_shadow);
 
+  fsm_init(&fsm, &leds_cfg, gpio_read(), out_shadow);
+
+#if CONSOLE_ENABLE
+  /* Órdenes por la UART: la ISR solo encola los bytes. */
+  console_init(&con_cfg);
+  install_uart_rx_handler(console_rx_isr);
+  enable_irq();
+#endif
+
+#if SCHED
+  sched_init();
+  sched_start(sched_add("muestreo", task_sample, SAMPLE_TCK, SAMPLE_TCK / 4U),
+              SAMPLE_TCK);
+  sched_start(sched_add("log", task_log, LOG_TCK, LOG_TCK), LOG_TCK);
+
+  while (1) {
+    (void)sched_run();
+  }
+#else
+  while (1) {
+    uint64_t now = get_ticks_from_reset();
+    uint32_t pins = gpio_read();
+
+    INSTR_LOOP(now);
+    INSTR_EDGE_POLLED((pins & fsm.btn_mask) != fsm.prev);
+
+    fsm_step(&fsm, pins, now);
+
+    /* Enviar registros pendientes por la UART sin bloquear. */
+    log_drain();
+    INSTR_POLL_PINS(pins);
+    PSTATS_POLL(pins);
+    CONSOLE_POLL();
+  }
+#endif
+
+  return 0;
+}
+
+#else /* !FSM_TABLE */
+
+int main(void)
+{
+  gpio_set_direction(LEDS_ALL);
+  gpio_out_init(gpio_read() & ~LEDS_ALL);
+
   uint32_t input_previous = gpio_read();
   uint32_t input_current  = input_previous;
   uint32_t button_0_prev  = input_previous & PBT_0_MASK;
@@ -40,6 +264,10 @@ int main(void)
     input_previous = input_current;
     input_current  = gpio_read();
 
+    INSTR_LOOP(now);
+    INSTR_EDGE_POLLED((input_previous ^ input_current) &
+                      (PBT_0_MASK | PBT_1_MASK));
+
     button_0_prev  = input_previous & PBT_0_MASK;
     button_0_curr  = input_current  & PBT_0_MASK;
 
@@ -57,11 +285,13 @@ int main(void)
       if (b0_measuring) {
         b0_measuring = 0;
         uint64_t dt = now - t_press;
-        uint32_t ms = (uint32_t)(dt / TICKS_PER_MS);
-        printf("BTN0 pulsado %u ms\n", ms);
-        if (ms >= 1000U) {
-          out_shadow |= LEDS_ALL;
-          gpio_write(out_shadow);
+        uint32_t ms = (uint32_t)ticks_to_ms(dt);
+        PSTATS_ADD(0u, ms);
+#if PSTATS_EACH
+        LOG1(LOG_BTN0_MS, ms);
+#endif
+        if (ms >= LONG_MS) {
+          gpio_out_set(LEDS_ALL);
           blink = 1;
           blink_last = now;
         }
@@ -72,19 +302,26 @@ int main(void)
     if (!button_1_prev && button_1_curr) {
       if (blink) {
         blink = 0;
-        out_shadow &= ~LEDS_ALL;
-        gpio_write(out_shadow);
+        gpio_out_clear(LEDS_ALL);
       }
     }
 
     /* Parpadeo no bloqueante. */
     if (blink && (now - blink_last) >= BLINK_TCK) {
       blink_last = now;
-      if (out_shadow & LEDS_ALL) out_shadow &= ~LEDS_ALL;
-      else                       out_shadow |=  LEDS_ALL;
-      gpio_write(out_shadow);
+      gpio_out_toggle(LEDS_ALL);
     }
+
+    /* Un gpio_write como mucho por vuelta, solo si hay cambio. */
+    gpio_out_flush();
+
+    /* Enviar registros pendientes por la UART sin bloquear. */
+    log_drain();
+    INSTR_POLL_PINS(input_current);
+    PSTATS_POLL(input_current);
   }
 
   return 0;
 }
+
+#endif /* FSM_TABLE */
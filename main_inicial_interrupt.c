@@ -5,74 +5,296 @@
  * - El parpadeo se detiene al pulsar PBT_1.
  * - Mientras parpadea, se puede seguir midiendo con PBT_0.
  * - Usar solo lógica con if-else y las funciones GPIO indicadas.
- * - El contador 'counter' incrementa automáticamente a 10 MHz.
+ * - El contador monotónico incrementa automáticamente a 10 MHz.
  * - LEDs 0-3 en bits 16-19. Botones 0-3 en bits 4-7.
  * - Máscaras: PBT_0_MASK, PBT_1_MASK, LED_0_MASK..LED_3_MASK.
  * - Líneas <= 80 caracteres.
+ *
+ * ISR_DEFERRED = 1: gpio_isr solo sella el flanco y lo encola en
+ * 'btn_events' (cola SPSC, evring.h); main vacía la cola, registra la
+ * medida y aplica la política de LEDs. Así la duración de la ISR no
+ * depende de la UART ni retrasa otras interrupciones.
+ * ISR_DEFERRED = 0: diseño original, con la impresión y gpio_write en la
+ * ISR (con LOG_DEFERRED = 0, envío síncrono por la UART dentro de la ISR).
+ *
+ * ISR_DEBOUNCE = 1: antirrebote en las interrupciones. El primer flanco
+ * de un botón sella el instante, enmascara la IRQ de ese pin y abre una
+ * ventana de DEBOUNCE_WIN_MS con el timer en one-shot (oneshot.h). Al
+ * cerrarse, timer_isr vuelve a habilitar el pin, lee el nivel ya estable
+ * y, si ha cambiado, entrega el flanco con el instante del primero. Un
+ * contacto que rebota da así una IRQ de GPIO y una de timer por flanco,
+ * en lugar de una por rebote; un pico que vuelve al nivel anterior dentro
+ * de la ventana no produce evento. Los eventos llegan DEBOUNCE_WIN_MS
+ * tarde, pero la medida no cambia.
+ * ISR_DEBOUNCE = 0: cada IRQ de GPIO compara el nivel y entrega lo que ve
+ * (con rebotes, un evento por rebote).
  */
 
-typedef unsigned char        uint8_t;
-typedef unsigned short int   uint16_t;
-typedef unsigned int         uint32_t;
-typedef unsigned long long   uint64_t;
+#include "riscv_types.h"
+#include "riscv_uart.h"
+#include "gpio_drv.h"
 
-/* Prototipos de GPIO (proporcionados por la plataforma) */
-void gpio_set_direction(uint32_t direction);
-void gpio_write(uint32_t output);
-uint32_t gpio_read(void);
+#include "dispatch.h"
+#include "clinc.h"
+#include "riscv_monotonic_clock.h"
 
-/* 'counter' es un registro/variable de hardware que incrementa a 10 MHz */
-extern volatile uint64_t counter;
+#include "gpio_out.h"
+#include "instr.h"
+#include "log.h"
 
-/* Para imprimir el tiempo (ajusta según tu plataforma: printf/uart) */
-#include <stdio.h>
+#include "cycles.h"
+#include "evring.h"
+#include "oneshot.h"
+#include "time_conv.h"
+
+#ifndef ISR_DEFERRED
+#define ISR_DEFERRED  (1)
+#endif
+
+#ifndef ISR_DEBOUNCE
+#define ISR_DEBOUNCE  (1)
+#endif
+
+#ifndef DEBOUNCE_WIN_MS
+#define DEBOUNCE_WIN_MS  (10U)
+#endif
+
+/* Conversión: 10 MHz => 10 000 ticks por milisegundo */
+#define TICKS_PER_MS (10000ULL)
+#define BLINK_TICKS  (500ULL * TICKS_PER_MS)
+
+#define LED_MASK (LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK)
+#define BTN_MASK (PBT_0_MASK | PBT_1_MASK)
+#define N_BTN    2u
+#define DEBOUNCE_WIN_TICKS ((uint64_t)DEBOUNCE_WIN_MS * TICKS_PER_MS)
 
 /* Estados compartidos entre main e ISR (volátiles) */
-static volatile uint8_t pbt0_down = 0;
-static volatile uint64_t pbt0_press_tick = 0;
+static volatile uint32_t btn_down = 0;
+static uint64_t pbt0_press_tick = 0;
 
 static volatile uint8_t blink_on = 0;
 static volatile uint64_t next_toggle_tick = 0;
-static volatile uint32_t led_state = 0;
 
-/* Conversión: 10 MHz => 10 000 ticks por milisegundo */
-#define TICKS_PER_MS (10000ULL)
+/* Eventos de botón de gpio_isr hacia main. */
+static evring_t btn_events;
+
+/* Duración de gpio_isr en ciclos (entrada a salida). */
+volatile uint32_t isr_cycles_last = 0;
+volatile uint32_t isr_cycles_max = 0;
+
+#if ISR_DEBOUNCE
+static const uint32_t btn_mask[N_BTN] = { PBT_0_MASK, PBT_1_MASK };
+
+/* Ventana abierta por botón: instante del primer flanco y cierre. Solo
+ * las tocan gpio_isr y timer_isr, que no se anidan. */
+static uint64_t win_edge[N_BTN];
+static uint64_t win_end[N_BTN];
+static uint32_t win_mask = 0;      /* Pines con la IRQ enmascarada.     */
+#endif
 
-/* Encender todos los LEDs (16..19) y actualiza 'led_state' */
+/* Encender todos los LEDs (16..19) en la sombra de salida */
 static void leds_all_on(void)
 {
-    led_state = LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK;
-    gpio_write(led_state);
+    gpio_out_set(LED_MASK);
 }
 
-/* Apagar todos los LEDs y actualiza 'led_state' */
+/* Apagar todos los LEDs en la sombra de salida */
 static void leds_all_off(void)
 {
-    led_state = 0;
-    gpio_write(led_state);
+    gpio_out_clear(LED_MASK);
 }
 
+/* Política de medida y LEDs para un flanco de botón. */
+static void on_button_event(const btn_event_t *ev)
+{
+    if (ev->btn == 0u) {
+        if (ev->edge == BTN_EDGE_PRESS) {
+            pbt0_press_tick = ev->tick;
+        } else {
+            uint64_t dt_ticks = ev->tick - pbt0_press_tick;
+            uint32_t dt_ms = (uint32_t)ticks_to_ms(dt_ticks);
+
+            /* Imprimir tiempo en ms */
+            LOG1(LOG_PBT0_MS, dt_ms);
+
+            /* Si >= 1000 ms: activar parpadeo y encender LEDs */
+            if (dt_ms >= 1000U) {
+                blink_on = 1;
+                next_toggle_tick = ev->tick + BLINK_TICKS;
+                leds_all_on();
+            }
+        }
+    } else {
+        /* PBT_1: detener parpadeo y apagar LEDs */
+        if ((ev->edge == BTN_EDGE_PRESS) && blink_on) {
+            blink_on = 0;
+            leds_all_off();
+        }
+    }
+}
+
+/* Detecta flanco de 'mask' y lo entrega (encolado o directo). */
+static void btn_edge(uint32_t pins, uint32_t mask, uint8_t id,
+                     uint64_t now)
+{
+    btn_event_t ev;
+
+    if ((pins & mask) && !(btn_down & mask)) {
+        btn_down |= mask;
+        ev.edge = BTN_EDGE_PRESS;
+    } else if (!(pins & mask) && (btn_down & mask)) {
+        btn_down &= ~mask;
+        ev.edge = BTN_EDGE_RELEASE;
+    } else {
+        return;
+    }
+
+    ev.tick = now;
+    ev.btn = id;
+#if ISR_DEFERRED
+    (void)evring_push(&btn_events, &ev);
+#else
+    on_button_event(&ev);
+#endif
+}
+
+#if ISR_DEBOUNCE
+/* Programa el timer para el cierre de ventana más próximo. */
+static void win_arm(void)
+{
+    uint64_t next = ~(uint64_t)0;
+    uint8_t b;
+
+    for (b = 0u; b < N_BTN; b++) {
+        if ((win_mask & btn_mask[b]) && (win_end[b] < next)) {
+            next = win_end[b];
+        }
+    }
+    if (win_mask != 0u) {
+        oneshot_arm_at(next);
+    } else {
+        oneshot_disarm();
+    }
+}
+
+/* Cierre de ventanas: nivel estable y flanco con el instante del
+ * primero. El pin se habilita antes de leerlo: un cambio posterior a la
+ * lectura deja la IRQ pendiente y abre otra ventana. */
+void timer_isr(void)
+{
+    INSTR_ISR_ENTER();
+    uint64_t now = get_ticks_from_reset();
+    uint32_t done = 0u;
+    uint32_t pins;
+    uint8_t b;
+
+    for (b = 0u; b < N_BTN; b++) {
+        if ((win_mask & btn_mask[b]) && (now >= win_end[b])) {
+            done |= btn_mask[b];
+        }
+    }
+    win_mask &= ~done;
+    gpio_irq_enable(done);
+
+    pins = gpio_read();
+    for (b = 0u; b < N_BTN; b++) {
+        if (done & btn_mask[b]) {
+            btn_edge(pins, btn_mask[b], b, win_edge[b]);
+        }
+    }
+#if !ISR_DEFERRED
+    gpio_out_flush();
+#endif
+    win_arm();
+
+    INSTR_ISR_EXIT();
+}
+#endif
+
 /* ISR de GPIO: se llama en cambios de los botones (depende de HW) */
 void gpio_isr(void)
 {
+    INSTR_ISR_ENTER();
+    uint32_t c0 = cycles_now();
+    uint64_t now = get_ticks_from_reset();
     uint32_t pins = gpio_read();
+    uint32_t dc;
+
+#if ISR_DEBOUNCE
+    /* Primer flanco de un pin sin ventana: sellar, enmascarar y abrir. */
+    uint32_t chg = (pins ^ btn_down) & BTN_MASK & ~win_mask;
+    uint8_t b;
 
-    /* PBT_0: medir tiempo entre pulsación y liberación */
-    if ((pins & PBT_0_MASK) && (pbt0_down == 0)) {
-        /* Flanco de pulsación (press) */
-        pbt0_down = 1;
-        pbt0_press_tick = counter;
-    } else if (!(pins & PBT_0_MASK) && (pbt0_down == 1)) {
-        /* Flanco de liberación (release) */
-        pbt0_down = 0;
-
-        uint64_t dt_ticks = counter - pbt0_press_tick;
-        uint32_t dt_ms = (uint32_t)(dt_ticks / TICKS_PER_MS);
-
-        /* Imprimir tiempo en ms */
-        printf("PBT0: %u ms\n", dt_ms);
-
-        /* Si >= 1000 ms: activar parpadeo y encender LEDs */
-        if (dt_ms >= 1000U) {
-            blink_on = 1;
-            leds_all_on();
+    for (b = 0u; b < N_BTN; b++) {
+        if (chg & btn_mask[b]) {
+            win_edge[b] = now;
+            win_end[b] = now + DEBOUNCE_WIN_TICKS;
+        }
+    }
+    if (chg != 0u) {
+        win_mask |= chg;
+        gpio_irq_disable(chg);
+        win_arm();
+    }
+#else
+    btn_edge(pins, PBT_0_MASK, 0u, now);
+    btn_edge(pins, PBT_1_MASK, 1u, now);
+#if !ISR_DEFERRED
+    gpio_out_flush();
+#endif
+#endif
+
+    dc = cycles_now() - c0;
+    isr_cycles_last = dc;
+    if (dc > isr_cycles_max) {
+        isr_cycles_max = dc;
+    }
+
+    INSTR_ISR_EXIT();
+}
+
+int main(void)
+{
+    uint64_t now;
+
+    gpio_set_direction(LED_MASK);
+    gpio_out_init(0);
+
+    evring_init(&btn_events);
+#if ISR_DEBOUNCE
+    install_local_timer_handler(timer_isr);
+    oneshot_disarm();
+#endif
+    install_gpio_handler(gpio_isr);
+    gpio_irq_enable(BTN_MASK);
+    enable_irq();
+
+    while (1) {
+#if ISR_DEFERRED
+        btn_event_t ev;
+
+        /* Vaciar la cola: formateo y LEDs fuera de la ISR */
+        while (evring_pop(&btn_events, &ev)) {
+            INSTR_EDGE(ev.tick, get_ticks_from_reset());
+            on_button_event(&ev);
+        }
+#endif
+
+        /* Enviar registros pendientes por la UART sin bloquear */
+        log_drain();
+
+        /* Parpadeo no bloqueante cada 500 ms */
+        now = get_ticks_from_reset();
+        INSTR_LOOP(now);
+        INSTR_POLL();
+        if (blink_on && (now >= next_toggle_tick)) {
+            next_toggle_tick += BLINK_TICKS;
+            gpio_out_toggle(LED_MASK);
+        }
+
+        /* Un gpio_write como mucho por vuelta, solo si hay cambio */
+        gpio_out_flush();
+    }
+
+    return 0;
+}
@@ -9,13 +9,29 @@
  *
  * Funcionalidad:
  *  - Detecta la pulsación y la liberación de cada botón con rebote
- *    por software (debounce).
+ *    por software (debounce.h: contadores verticales sobre los 32 bits
+ *    del puerto, muestreados cada DEBOUNCE_MS / DEBOUNCE_SAMPLES).
  *  - Imprime el tiempo pulsado en milisegundos.
  *  - Si el tiempo pulsado >= 1000 ms, enciende los 4 LEDs y entra en
  *    modo parpadeo. El parpadeo continúa hasta que se pulse otro
  *    botón distinto al que lo activó.
  *  - Mientras parpadea, se siguen detectando e imprimiendo tiempos
  *    de pulsación de cualquier botón.
+ *  - LED_PWM = 1: los LEDs van por PWM software (swpwm.h, timer en
+ *    one-shot a LED_PWM_HZ tramas/s). Mientras se mantiene el botón i,
+ *    el LED i sube de 0 a brillo máximo en 1 s (indica la duración); al
+ *    soltar antes de 1 s se apaga con una rampa corta. El parpadeo usa
+ *    niveles 0/255. LED_PWM = 0: escritura directa del puerto.
+ *  - SCHED = 1: cada tarea (muestreo, parpadeo, vaciado del log) va en
+ *    el planificador cooperativo (coop_sched.h) con su periodo y su plazo, y
+ *    el bucle solo llama a sched_run(). SCHED = 0 (por defecto): el
+ *    super-loop de siempre; el muestreo se anota igualmente con
+ *    sched_account() para comparar el peor tiempo de respuesta.
+ *  - CONSOLE_ENABLE = 1: órdenes por la UART (console.h) para leer y
+ *    cambiar long_ms, blink_ms y debounce_ms (periodo de muestreo =
+ *    debounce_ms / DEBOUNCE_SAMPLES) y volcar o poner a cero las
+ *    estadísticas del planificador. Una pasada acotada de la consola en
+ *    la tarea del log o en cada vuelta del super-loop.
  *
  * Notas:
  *  - Se asume botones activos a nivel alto (1 = pulsado). Si son
@@ -30,6 +46,31 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include "console.h"
+#include "debounce.h"
+#include "log.h"
+#include "time_conv.h"
+
+#ifndef LED_PWM
+#define LED_PWM               0
+#endif
+
+#ifndef SCHED
+#define SCHED                 0
+#endif
+
+#include "coop_sched.h"
+
+#include "gpio_out.h"
+#if LED_PWM || CONSOLE_ENABLE
+#include "dispatch.h"
+#endif
+#if LED_PWM
+#include "clinc.h"
+#include "oneshot.h"
+#include "swpwm.h"
+#endif
+
 /* Prototipos proporcionados por la plataforma. */
 uint32_t gpio_read(void);
 uint64_t get_ticks_from_reset(void);
@@ -43,13 +84,34 @@ void gpio_write(uint32_t value);
 #define BTN_COUNT             4
 #define LED_COUNT             4
 
+#define BTNSTORE_BUTTONS      BTN_COUNT
+#include "btnstore.h"
+
 /* Temporizaciones (ticks y ms). */
-#define TICKS_PER_SEC         10000000ULL
+#define TICKS_PER_SEC         ((uint64_t)CLINT_CLOCK)
 #define TICKS_PER_MS          (TICKS_PER_SEC / 1000ULL)
 #define DEBOUNCE_MS           20U
 #define DEBOUNCE_TICKS        (DEBOUNCE_MS * TICKS_PER_MS)
+#define DEBOUNCE_SAMPLE_TICKS (DEBOUNCE_TICKS / DEBOUNCE_SAMPLES)
 #define BLINK_PERIOD_MS       250U
 #define BLINK_PERIOD_TICKS    (BLINK_PERIOD_MS * TICKS_PER_MS)
+#define LONG_MS               1000U
+
+/* Tareas: periodo del vaciado del log (medio carácter a 115200 baudios,
+ * para no perder un hueco de la UART entre dos pasadas) y plazos
+ * relativos a la activación. */
+#define UART_BAUD             115200U
+#define LOG_PERIOD_TICKS      ((uint32_t)(TICKS_PER_SEC * 5U / UART_BAUD))
+#define SAMPLE_DEADLINE_TICKS ((uint32_t)(DEBOUNCE_SAMPLE_TICKS / 10U))
+#define BLINK_DEADLINE_TICKS  ((uint32_t)TICKS_PER_MS)
+
+/* PWM: tramas por segundo y rampas (en tramas). */
+#ifndef LED_PWM_HZ
+#define LED_PWM_HZ            100U
+#endif
+#define LED_PWM_PERIOD        ((uint32_t)(TICKS_PER_SEC / LED_PWM_HZ))
+#define LED_FADE_IN_FRAMES    ((uint16_t)LED_PWM_HZ)
+#define LED_FADE_OUT_FRAMES   ((uint16_t)(LED_PWM_HZ / 8U))
 
 /* Nivel activo de los botones: 1 = alto, 0 = bajo. */
 #define BUTTON_ACTIVE_HIGH    1
@@ -57,32 +119,55 @@ void gpio_write(uint32_t value);
 /* Sombra de salida para preservar bits no-LED al escribir GPIO. */
 static uint32_t gpio_out_shadow = 0;
 
-/* Estado por botón para debounce y medición. */
-typedef struct {
-  uint8_t stable;           /* Estado estable: 0 = libre, 1 = pulsado.   */
-  uint8_t last_raw;         /* Último valor leído (sin filtrar).         */
-  uint64_t last_change;     /* Tick del último cambio de last_raw.       */
-  uint8_t waiting_release;  /* 1 si estamos midiendo ese botón.          */
-  uint64_t t_press;         /* Tick de flanco de pulsación (estable).    */
-} btn_state_t;
-
-/* Utilidad: lee los 4 botones y aplica nivel activo. */
-static inline uint8_t read_buttons(uint32_t port)
-{
-  uint32_t v = (port >> BTN_SHIFT) & 0xF;
+/* XOR que deja los botones activos a nivel alto antes del debounce. */
 #if BUTTON_ACTIVE_HIGH
-  return (uint8_t)v;
+#define BTN_ACTIVE_XOR        0UL
 #else
-  return (uint8_t)(~v & 0xF);
+#define BTN_ACTIVE_XOR        (0xFUL << BTN_SHIFT)
 #endif
-}
+
+/* Debounce de todo el puerto y medición de los botones (máscaras y
+ * desplazamientos desde una época común, btnstore.h). */
+static debounce_t deb;
+static btnstore_t btns;
+
+/* Parpadeo: activo, botón origen, timestamp de último toggle. */
+static bool blink_active = false;
+static uint8_t blink_source = 0xFF;
+#if !SCHED
+static uint64_t blink_last = 0;
+#endif
+
+/* Índices de las tareas en el planificador. */
+static uint8_t t_sample;
+#if SCHED
+static uint8_t t_blink, t_log;
+#endif
+
+/* Tick de la muestra en curso (para las callbacks). */
+static uint64_t now = 0;
+
+/* Parámetros ajustables por la consola (ms) y periodos derivados. */
+static uint32_t long_ms = LONG_MS;
+#if CONSOLE_ENABLE
+static uint32_t blink_ms = BLINK_PERIOD_MS;
+static uint32_t debounce_ms = DEBOUNCE_MS;
+#endif
+static uint32_t blink_ticks = (uint32_t)BLINK_PERIOD_TICKS;
+static uint32_t sample_ticks = (uint32_t)DEBOUNCE_SAMPLE_TICKS;
 
 /* Escribe patrón de 4 LEDs preservando otros bits del puerto. */
 static void set_leds_pattern(uint8_t pat)
 {
   gpio_out_shadow &= ~(0xFUL << LED_SHIFT);
   gpio_out_shadow |= ((uint32_t)pat & 0xF) << LED_SHIFT;
-  gpio_write(gpio_out_shadow);
+#if LED_PWM
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    swpwm_set_level(i, (pat & (1u << i)) ? 255u : 0u);
+  }
+#else
+  gpio_out_assign(0xFUL << LED_SHIFT, gpio_out_shadow);
+#endif
 }
 
 /* Utilidades LEDs. */
@@ -94,83 +179,229 @@ static inline void leds_toggle_all(void)
   set_leds_pattern(cur ^ 0xF);
 }
 
+/* Base de tiempos del parpadeo: tarea periódica o marca del bucle. */
+static void blink_timer_start(void)
+{
+#if SCHED
+  sched_start(t_blink, now + blink_ticks);
+#else
+  blink_last = now;
+#endif
+}
+
+static void blink_timer_stop(void)
+{
+#if SCHED
+  sched_stop(t_blink);
+#endif
+}
+
+/* Callback de debounce: flanco estable en el botón del bit 'pin'. */
+static void on_button(uint8_t pin, uint8_t edge)
+{
+  uint8_t i = (uint8_t)(pin - BTN_SHIFT);
+
+  /* Flanco de pulsación (arranque de medición). */
+  if (edge == DEBOUNCE_RISE) {
+    btnstore_press(&btns, i, now);
+
+    /* Si parpadea y es otro botón, detener parpadeo. */
+    if (blink_active && i != blink_source) {
+      blink_active = false;
+      blink_timer_stop();
+      leds_off_all();
+    }
+
+#if LED_PWM
+    /* Fuera del parpadeo, el LED del botón indica la duración. */
+    if (!blink_active) {
+      swpwm_fade(i, 255u, LED_FADE_IN_FRAMES);
+    }
+#endif
+  } else {
+    /* Flanco de liberación: finalizar medición. */
+    if (btnstore_waiting(&btns, i)) {
+      uint64_t dt = btnstore_release(&btns, i, now);
+      uint32_t ms = (uint32_t)ticks_to_ms(dt);
+      LOG2(LOG_BTNN_MS, i, ms);
+
+      /* Activar parpadeo si ms >= 1000. */
+      if (ms >= long_ms) {
+        leds_on_all();
+        blink_active = true;
+        blink_source = i;
+        blink_timer_start();
+      }
+
+#if LED_PWM
+      /* Pulsación corta: apagar el indicador con una rampa breve. */
+      if (!blink_active) {
+        swpwm_fade(i, 0u, LED_FADE_OUT_FRAMES);
+      }
+#endif
+    }
+  }
+}
+
+/* ------------------------------------------------------------------ */
+/* Tareas                                                              */
+/* ------------------------------------------------------------------ */
+
+#if SCHED
+/* Muestra a periodo fijo: flancos de todos los pines a la vez. */
+static void task_sample(uint64_t t)
+{
+  now = t;
+  if (debounce_sample(&deb, gpio_read() ^ BTN_ACTIVE_XOR) != 0u) {
+    debounce_dispatch(&deb);
+  }
+#if !LED_PWM
+  gpio_out_flush();
+#endif
+}
+
+static void task_blink(uint64_t t)
+{
+  now = t;
+  leds_toggle_all();
+#if !LED_PWM
+  gpio_out_flush();
+#endif
+}
+
+/* Enviar registros pendientes por la UART sin bloquear. */
+static void task_log(uint64_t t)
+{
+  (void)t;
+  log_drain();
+  CONSOLE_POLL();
+}
+#endif /* SCHED */
+
+#if CONSOLE_ENABLE
+/* ------------------------------------------------------------------ */
+/* Consola                                                             */
+/* ------------------------------------------------------------------ */
+
+/* blink_ticks y sample_ticks se calculan en 32 bits. */
+#if CONSOLE_BLINK_MS_MAX > 0xFFFFFFFFu / (CLINT_CLOCK / 1000u) || \
+    CONSOLE_DEBOUNCE_MS_MAX > 0xFFFFFFFFu / (CLINT_CLOCK / 1000u)
+#error "CONSOLE_*_MS_MAX: el periodo en ticks no cabe en 32 bits"
+#endif
+
+/* Periodos nuevos: desde la próxima activación. */
+static void con_changed(uint8_t p)
+{
+  (void)p;
+  blink_ticks = blink_ms * (uint32_t)TICKS_PER_MS;
+  sample_ticks = debounce_ms * (uint32_t)TICKS_PER_MS / DEBOUNCE_SAMPLES;
+#if SCHED
+  sched_set_period(t_blink, blink_ticks);
+  sched_set_period(t_sample, sample_ticks);
+#endif
+}
+
+static const console_cfg_t con_cfg = {
+  { &long_ms, &blink_ms, &debounce_ms },
+  con_changed, sched_log_stats, sched_reset_stats, NULL
+};
+#endif /* CONSOLE_ENABLE */
+
 int main(void)
 {
+#if !SCHED
+  uint64_t last_sample = 0;
+#endif
+
   /* Inicialización: tomar estado actual del puerto como sombra. */
   gpio_out_shadow = gpio_read();
+  gpio_out_init(gpio_out_shadow);
+#if LED_PWM
+  {
+    uint32_t mask[SWPWM_CHANNELS];
+
+    for (uint8_t i = 0; i < LED_COUNT; i++) {
+      mask[i] = 1UL << (LED_SHIFT + i);
+    }
+    install_local_timer_handler(swpwm_isr);
+    enable_irq();
+    swpwm_init(LED_PWM_PERIOD, mask);
+  }
+#endif
   leds_off_all();
 
-  /* Estados de botones. */
-  btn_state_t btn[BTN_COUNT] = {0};
+  /* Botones liberados al inicio; callback en los bits 4-7. */
+  debounce_init(&deb, 0);
+  btnstore_init(&btns, 0);
+  for (uint8_t i = 0; i < BTN_COUNT; i++) {
+    debounce_set_callback(&deb, (uint8_t)(BTN_SHIFT + i), on_button);
+  }
+
+#if CONSOLE_ENABLE
+  /* Órdenes por la UART: la ISR solo encola los bytes. */
+  console_init(&con_cfg);
+  install_uart_rx_handler(console_rx_isr);
+  enable_irq();
+#endif
+
+  sched_init();
+#if SCHED
+  /* Tareas por orden de registro (desempate a igualdad de plazo). */
+  t_sample = sched_add("muestreo", task_sample, sample_ticks,
+                       SAMPLE_DEADLINE_TICKS);
+  t_blink = sched_add("parpadeo", task_blink, blink_ticks,
+                      BLINK_DEADLINE_TICKS);
+  t_log = sched_add("log", task_log, LOG_PERIOD_TICKS, LOG_PERIOD_TICKS);
+  sched_start(t_sample, DEBOUNCE_SAMPLE_TICKS);
+  sched_start(t_log, LOG_PERIOD_TICKS);
 
-  /* Parpadeo: activo, botón origen, timestamp de último toggle. */
-  bool blink_active = false;
-  uint8_t blink_source = 0xFF;
-  uint64_t blink_last = 0;
+  /* Bucle principal: un trabajo por pasada. */
+  for (;;) {
+    (void)sched_run();
+  }
+#else
+  /* Solo para las estadísticas del muestreo. */
+  t_sample = sched_add("muestreo", NULL, DEBOUNCE_SAMPLE_TICKS,
+                       SAMPLE_DEADLINE_TICKS);
 
   /* Bucle principal (super-loop). */
   for (;;) {
-    uint64_t now = get_ticks_from_reset();
+    now = get_ticks_from_reset();
     uint32_t port = gpio_read();
-    uint8_t buttons = read_buttons(port);
 
-    /* Actualizar cada botón con debounce y detectar flancos. */
-    for (uint8_t i = 0; i < BTN_COUNT; i++) {
-      uint8_t raw = (buttons >> i) & 0x1;
+    /* Muestra a periodo fijo: flancos de todos los pines a la vez. La
+     * activación es la del periodo que acaba de vencer. */
+    if ((now - last_sample) >= sample_ticks) {
+      uint64_t rel = last_sample + sample_ticks;
 
-      /* Si cambió el valor crudo, reiniciar temporizador. */
-      if (raw != btn[i].last_raw) {
-        btn[i].last_raw = raw;
-        btn[i].last_change = now;
-      }
-
-      /* Si el nuevo valor se mantiene, actualizar estado estable. */
-      if ((now - btn[i].last_change) >= DEBOUNCE_TICKS) {
-        if (raw != btn[i].stable) {
-          btn[i].stable = raw;
-
-          /* Flanco de pulsación (arranque de medición). */
-          if (btn[i].stable) {
-            btn[i].t_press = now;
-            btn[i].waiting_release = 1;
-
-            /* Si parpadea y es otro botón, detener parpadeo. */
-            if (blink_active && i != blink_source) {
-              blink_active = false;
-              leds_off_all();
-            }
-          } else {
-            /* Flanco de liberación: finalizar medición. */
-            if (btn[i].waiting_release) {
-              uint64_t dt = now - btn[i].t_press;
-              uint32_t ms = (uint32_t)(dt / TICKS_PER_MS);
-              printf("BTN%u pulsado %u ms\n", i, ms);
-              btn[i].waiting_release = 0;
-
-              /* Activar parpadeo si ms >= 1000. */
-              if (ms >= 1000U) {
-                leds_on_all();
-                blink_active = true;
-                blink_source = i;
-                blink_last = now;
-              }
-            }
-          }
-        }
+      last_sample = now;
+      if (debounce_sample(&deb, port ^ BTN_ACTIVE_XOR) != 0u) {
+        debounce_dispatch(&deb);
       }
+      sched_account(t_sample, rel, now);
     }
 
     /* Gestionar parpadeo periódico sin bloquear el super-loop. */
     if (blink_active) {
-      if ((now - blink_last) >= BLINK_PERIOD_TICKS) {
+      if ((now - blink_last) >= blink_ticks) {
         blink_last = now;
         leds_toggle_all();
       }
     }
 
+#if !LED_PWM
+    /* Un gpio_write como mucho por vuelta, solo si hay cambio. */
+    gpio_out_flush();
+#endif
+
+    /* Enviar registros pendientes por la UART sin bloquear. */
+    log_drain();
+    CONSOLE_POLL();
+
     /* Opcional: insertar medidas de bajo consumo o espera corta. */
     /* En plataforma real, podría usarse sleep o WFI/WFE si aplica. */
   }
+#endif
 
   /* Nunca retorna en un super-loop. */
   return 0;
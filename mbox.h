@@ -0,0 +1,112 @@
+/*
+ * Buzón sin bloqueos entre dos harts: un productor (la hart que muestrea)
+ * y un consumidor (la que mide, registra y gobierna los LEDs).
+ *
+ * Es la cola SPSC de evring.h con la disposición pensada para dos
+ * núcleos con caché:
+ *  - 'head' y los contadores del productor, 'tail' y los del consumidor y
+ *    los huecos van en líneas de caché distintas (MBOX_LINE), de modo que
+ *    cada hart escribe solo en sus líneas y no hay compartición falsa;
+ *  - cada lado guarda una copia del índice del otro (tail_cache,
+ *    head_cache) y solo lee la línea ajena cuando la copia dice que la
+ *    cola está llena o vacía.
+ *
+ * Las barreras son las de evring.h (fence en RISC-V). Si la cola está
+ * llena el evento se descarta y se cuenta en 'overflows'.
+ */
+#ifndef MBOX_H
+#define MBOX_H
+
+#include "riscv_types.h"
+#include "evring.h"
+
+/* Tamaño de línea de caché (bytes). */
+#ifndef MBOX_LINE
+#define MBOX_LINE  (64u)
+#endif
+
+/* Número de huecos: potencia de 2. */
+#ifndef MBOX_SIZE
+#define MBOX_SIZE  (32u)
+#endif
+
+#if (MBOX_SIZE & (MBOX_SIZE - 1u)) != 0
+#error "MBOX_SIZE debe ser potencia de 2"
+#endif
+
+#define MBOX_ALIGNED  __attribute__((aligned(MBOX_LINE)))
+
+typedef struct {
+    /* Línea del productor. */
+    struct {
+        volatile uint32_t head;
+        uint32_t          tail_cache;
+        volatile uint32_t overflows;
+        volatile uint32_t hwm;       /* Cota de la máxima ocupación.    */
+    } MBOX_ALIGNED p;
+
+    /* Línea del consumidor. */
+    struct {
+        volatile uint32_t tail;
+        uint32_t          head_cache;
+    } MBOX_ALIGNED c;
+
+    btn_event_t buf[MBOX_SIZE] MBOX_ALIGNED;
+} mbox_t;
+
+static inline void mbox_init(mbox_t *m)
+{
+    m->p.head = 0u;
+    m->p.tail_cache = 0u;
+    m->p.overflows = 0u;
+    m->p.hwm = 0u;
+    m->c.tail = 0u;
+    m->c.head_cache = 0u;
+}
+
+/* Productor: encola *ev. Devuelve 0 si el buzón estaba lleno. */
+static inline int mbox_push(mbox_t *m, const btn_event_t *ev)
+{
+    uint32_t head = m->p.head;
+    uint32_t used = head - m->p.tail_cache;
+
+    if (used >= MBOX_SIZE) {
+        m->p.tail_cache = m->c.tail;
+        EVRING_FENCE_R();
+        used = head - m->p.tail_cache;
+        if (used >= MBOX_SIZE) {
+            m->p.overflows++;
+            return 0;
+        }
+    }
+
+    m->buf[head & (MBOX_SIZE - 1u)] = *ev;
+    EVRING_FENCE_W();
+    m->p.head = head + 1u;
+
+    if (used + 1u > m->p.hwm) {
+        m->p.hwm = used + 1u;
+    }
+    return 1;
+}
+
+/* Consumidor: desencola en *ev. Devuelve 0 si el buzón estaba vacío. */
+static inline int mbox_pop(mbox_t *m, btn_event_t *ev)
+{
+    uint32_t tail = m->c.tail;
+
+    if (tail == m->c.head_cache) {
+        m->c.head_cache = m->p.head;
+        if (tail == m->c.head_cache) {
+            return 0;
+        }
+    }
+
+    EVRING_FENCE_R();
+    *ev = m->buf[tail & (MBOX_SIZE - 1u)];
+    EVRING_FENCE_RW();
+    m->c.tail = tail + 1u;
+    return 1;
+}
+
+#endif /* MBOX_H */
@@ -0,0 +1,24 @@
+#include "riscv_types.h"
+
+#include "clinc.h"
+#include "riscv_monotonic_clock.h"
+
+#include "oneshot.h"
+
+void oneshot_arm_at(uint64_t deadline)
+{
+    uint64_t now = get_ticks_from_reset();
+    uint64_t gap = 1u;
+
+    if (deadline > now) {
+        gap = deadline - now;
+    }
+
+    local_timer_set_gap(gap);
+    enable_timer_clinc_irq();
+}
+
+void oneshot_disarm(void)
+{
+    disable_timer_clinc_irq();
+}
@@ -0,0 +1,23 @@
+/*
+ * Temporizador one-shot sobre el CLINT (modo tickless).
+ *
+ * En lugar de una interrupción periódica, se programa mtimecmp para el
+ * siguiente plazo real. El manejador instalado con
+ * install_local_timer_handler() debe volver a llamar a oneshot_arm_at()
+ * o a oneshot_disarm() en cada entrada, ya que local_timer_set_gap()
+ * recarga el comparador con el último gap si no se reprograma.
+ */
+#ifndef ONESHOT_H
+#define ONESHOT_H
+
+#include "riscv_types.h"
+
+/* Programa la IRQ para el instante absoluto 'deadline' (ticks de mtime).
+ * Si el plazo ya pasó, la IRQ salta en el siguiente tick. */
+void oneshot_arm_at(uint64_t deadline);
+
+/* Desarma el comparador: no habrá más IRQ de timer hasta el próximo
+ * oneshot_arm_at(). */
+void oneshot_disarm(void);
+
+#endif /* ONESHOT_H */
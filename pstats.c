@@ -0,0 +1,355 @@
+#include "riscv_types.h"
+
+#include "log.h"
+#include "pstats.h"
+
+#define Q16_ONE  (65536)
+
+static pstats_t pstats[PSTATS_MAX_BTN];
+
+/* Cuantiles de los estimadores P² en Q16 (0,50; 0,95; 0,99). */
+static const int32_t p2_p[PSTATS_N_Q] = { 32768, 62259, 64881 };
+
+/* ------------------------------------------------------------------ */
+/* Utilidades                                                          */
+/* ------------------------------------------------------------------ */
+
+/* floor(sqrt(x)) bit a bit. */
+static uint32_t isqrt64(uint64_t x)
+{
+    uint64_t r = 0u;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0u) {
+        if (x >= r + bit) {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/* ------------------------------------------------------------------ */
+/* P²                                                                  */
+/* ------------------------------------------------------------------ */
+
+/* Incremento por muestra de la posición deseada del marcador i (Q16). */
+static int32_t p2_dn(int32_t p, uint8_t i)
+{
+    static const uint8_t num[5] = { 0u, 1u, 2u, 1u, 2u };
+
+    /* {0, p/2, p, (1+p)/2, 1} */
+    if (i == 3u) {
+        return (Q16_ONE + p) / 2;
+    }
+    if (i == 4u) {
+        return Q16_ONE;
+    }
+    return (p * num[i]) / 2;
+}
+
+/* Primeras cinco muestras: q[] ordenado; 'count' muestras previas. */
+static void p2_fill(pstats_p2_t *e, int32_t p, uint32_t count, int32_t x)
+{
+    uint8_t i = (uint8_t)count;
+
+    while ((i > 0u) && (e->q[i - 1u] > x)) {
+        e->q[i] = e->q[i - 1u];
+        i--;
+    }
+    e->q[i] = x;
+
+    if (count == 4u) {
+        for (i = 0u; i < 5u; i++) {
+            e->n[i] = i + 1u;
+        }
+        /* Posición deseada {1, 1+2p, 1+4p, 3+2p, 5} menos la real. */
+        e->d[0] = 0;
+        e->d[1] = 2 * p - Q16_ONE;
+        e->d[2] = 4 * p - 2 * Q16_ONE;
+        e->d[3] = 2 * p - Q16_ONE;
+        e->d[4] = 0;
+    }
+}
+
+/* Altura corregida del marcador i con predicción parabólica. */
+static int32_t p2_parabolic(const pstats_p2_t *e, uint8_t i, int32_t ds)
+{
+    int64_t n0 = e->n[i - 1u], n1 = e->n[i], n2 = e->n[i + 1u];
+    int64_t q0 = e->q[i - 1u], q1 = e->q[i], q2 = e->q[i + 1u];
+    int64_t t1 = (n1 - n0 + ds) * (q2 - q1) / (n2 - n1);
+    int64_t t2 = (n2 - n1 - ds) * (q1 - q0) / (n1 - n0);
+
+    return (int32_t)(q1 + ds * (t1 + t2) / (n2 - n0));
+}
+
+static void p2_add(pstats_p2_t *e, int32_t p, int32_t x)
+{
+    uint8_t i, k;
+
+    /* Celda de x y extremos. */
+    if (x < e->q[0]) {
+        e->q[0] = x;
+        k = 0u;
+    } else if (x >= e->q[4]) {
+        e->q[4] = x;
+        k = 3u;
+    } else {
+        k = 0u;
+        while (x >= e->q[k + 1u]) {
+            k++;
+        }
+    }
+
+    /* Los extremos siguen siempre en su posición deseada (d = 0). */
+    for (i = (uint8_t)(k + 1u); i < 5u; i++) {
+        e->n[i]++;
+        if (i < 4u) {
+            e->d[i] -= Q16_ONE;
+        }
+    }
+    for (i = 1u; i < 4u; i++) {
+        e->d[i] += p2_dn(p, i);
+    }
+
+    /* Ajuste de los marcadores interiores (como mucho un paso). */
+    for (i = 1u; i < 4u; i++) {
+        int32_t d = e->d[i];
+        int32_t ds, q;
+
+        if ((d >= Q16_ONE) && ((e->n[i + 1u] - e->n[i]) > 1u)) {
+            ds = 1;
+        } else if ((d <= -Q16_ONE) && ((e->n[i] - e->n[i - 1u]) > 1u)) {
+            ds = -1;
+        } else {
+            continue;
+        }
+
+        q = p2_parabolic(e, i, ds);
+        if ((q <= e->q[i - 1u]) || (q >= e->q[i + 1u])) {
+            /* Fuera de orden: interpolación lineal hacia el vecino. */
+            uint8_t j = (uint8_t)(i + ds);
+            int32_t dn = (int32_t)e->n[j] - (int32_t)e->n[i];
+
+            q = e->q[i] + ds * (e->q[j] - e->q[i]) / dn;
+        }
+        e->q[i] = q;
+        e->n[i] = (uint32_t)((int32_t)e->n[i] + ds);
+        e->d[i] -= ds * Q16_ONE;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* API                                                                 */
+/* ------------------------------------------------------------------ */
+
+#if PSTATS_ENABLE && (PSTATS_EVERY != 0u)
+static uint32_t since_dump = 0u;
+#endif
+
+void pstats_add(uint8_t btn, uint32_t ms)
+{
+    pstats_t *s;
+    int32_t x;
+    int64_t d_old, d_new;
+    uint32_t k;
+    uint8_t j;
+
+    if (btn >= PSTATS_MAX_BTN) {
+        return;
+    }
+    s = &pstats[btn];
+
+    /* Q8 con límite (2^23 ms, más de 2 h). */
+    if (ms > 0x7FFFFFu) {
+        ms = 0x7FFFFFu;
+    }
+    x = (int32_t)(ms << 8);
+
+    /* Cuantiles (antes de contar la muestra). */
+    for (j = 0u; j < PSTATS_N_Q; j++) {
+        if (s->n < 5u) {
+            p2_fill(&s->p2[j], p2_p[j], s->n, x);
+        } else {
+            p2_add(&s->p2[j], p2_p[j], x);
+        }
+    }
+
+    /* Número, extremos y Welford. */
+    s->n++;
+    if ((s->n == 1u) || (ms < s->min)) {
+        s->min = ms;
+    }
+    if (ms > s->max) {
+        s->max = ms;
+    }
+    /* Welford con la media de la suma: redondear delta / n, como la
+     * actualización habitual, la deja quieta en cuanto n supera unas 512
+     * veces |x - media| (en ms), y el error se acumula. La suma en Q16
+     * desborda pasados 2^48 ms. */
+    d_old = (int64_t)x - ((s->mean_q16 + 128) >> 8);
+    s->sum += ms;
+    s->mean_q16 = (int64_t)((s->sum << 16) / s->n);
+    d_new = (int64_t)x - ((s->mean_q16 + 128) >> 8);
+    s->m2_q16 += (uint64_t)(d_old * d_new);
+
+    /* Histograma log2. */
+    k = (ms == 0u) ? 0u : (32u - (uint32_t)__builtin_clz(ms));
+    if (k >= PSTATS_BUCKETS) {
+        k = PSTATS_BUCKETS - 1u;
+    }
+    s->bucket[k]++;
+
+#if PSTATS_ENABLE && (PSTATS_EVERY != 0u)
+    if (++since_dump >= PSTATS_EVERY) {
+        since_dump = 0u;
+        pstats_dump();
+    }
+#endif
+}
+
+const pstats_t *pstats_get(uint8_t btn)
+{
+    return &pstats[btn];
+}
+
+uint32_t pstats_mean(uint8_t btn)
+{
+    return (uint32_t)((pstats[btn].mean_q16 + 32768) >> 16);
+}
+
+uint32_t pstats_stddev(uint8_t btn)
+{
+    const pstats_t *s = &pstats[btn];
+
+    if (s->n < 2u) {
+        return 0u;
+    }
+    /* Varianza muestral en Q16 -> desviación en Q8. */
+    return (isqrt64(s->m2_q16 / (s->n - 1u)) + 128u) >> 8;
+}
+
+uint32_t pstats_quantile(uint8_t btn, uint8_t which)
+{
+    const pstats_t *s = &pstats[btn];
+    const pstats_p2_t *e = &s->p2[which];
+    int32_t q;
+
+    if (s->n == 0u) {
+        return 0u;
+    }
+    if (s->n < 5u) {
+        /* Rango más cercano: ceil(p * n) - 1. */
+        uint32_t r = ((uint32_t)p2_p[which] * s->n + 65535u) >> 16;
+
+        q = e->q[(r == 0u) ? 0u : (r - 1u)];
+    } else {
+        q = e->q[2];
+    }
+    return (uint32_t)(q + 128) >> 8;
+}
+
+void pstats_reset(void)
+{
+    uint8_t b, k;
+
+    for (b = 0u; b < PSTATS_MAX_BTN; b++) {
+        pstats[b].n = 0u;
+        pstats[b].min = 0u;
+        pstats[b].max = 0u;
+        pstats[b].sum = 0u;
+        pstats[b].mean_q16 = 0;
+        pstats[b].m2_q16 = 0u;
+        for (k = 0u; k < PSTATS_BUCKETS; k++) {
+            pstats[b].bucket[k] = 0u;
+        }
+    }
+}
+
+#if PSTATS_ENABLE
+
+/* ------------------------------------------------------------------ */
+/* Resumen por el registro diferido                                    */
+/* ------------------------------------------------------------------ */
+
+/* Pasos del resumen de un botón; después, una cubeta por paso. */
+enum { DUMP_HEAD, DUMP_RANGE, DUMP_MEAN, DUMP_PCT };
+
+#define DUMP_BIN  (DUMP_PCT + PSTATS_N_Q)
+
+static const uint8_t pct_value[PSTATS_N_Q] = { 50u, 95u, 99u };
+
+static uint32_t dump_pins = 0u;
+static uint8_t  dump_on = 0u;
+static uint8_t  dump_b = 0u;
+static uint8_t  dump_step = 0u;
+
+void pstats_dump(void)
+{
+    if (!dump_on) {
+        dump_on = 1u;
+        dump_b = 0u;
+        dump_step = DUMP_HEAD;
+    }
+}
+
+void pstats_poll(uint32_t pins)
+{
+    const pstats_t *s;
+
+    if (pins & ~dump_pins & PSTATS_DUMP_MASK) {
+        pstats_dump();
+    }
+    dump_pins = pins;
+
+    /* Un registro por llamada y solo con la cola medio vacía. */
+    if (!dump_on || (log_free() <= (LOG_RING_SIZE / 2u))) {
+        return;
+    }
+
+    /* Botones sin muestras: nada que contar. */
+    while ((dump_b < PSTATS_MAX_BTN) && (pstats[dump_b].n == 0u)) {
+        dump_b++;
+    }
+    if (dump_b == PSTATS_MAX_BTN) {
+        dump_on = 0u;
+        return;
+    }
+    s = &pstats[dump_b];
+
+    if (dump_step == DUMP_HEAD) {
+        LOG2(LOG_STATS_BTN, dump_b, s->n);
+    } else if (dump_step == DUMP_RANGE) {
+        LOG2(LOG_STATS_RANGE, s->min, s->max);
+    } else if (dump_step == DUMP_MEAN) {
+        LOG2(LOG_STATS_MEAN, pstats_mean(dump_b), pstats_stddev(dump_b));
+    } else if (dump_step < DUMP_BIN) {
+        uint8_t j = (uint8_t)(dump_step - DUMP_PCT);
+
+        LOG2(LOG_STATS_PCT, pct_value[j], pstats_quantile(dump_b, j));
+    } else {
+        uint8_t k = (uint8_t)(dump_step - DUMP_BIN);
+
+        while ((k < PSTATS_BUCKETS) && (s->bucket[k] == 0u)) {
+            k++;
+        }
+        if (k < PSTATS_BUCKETS) {
+            LOG2(LOG_STATS_BIN, k, s->bucket[k]);
+            dump_step = (uint8_t)(DUMP_BIN + k + 1u);
+        } else {
+            /* Botón terminado. */
+            dump_b++;
+            dump_step = DUMP_HEAD;
+        }
+        return;
+    }
+    dump_step++;
+}
+
+#endif /* PSTATS_ENABLE */
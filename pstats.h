@@ -0,0 +1,110 @@
+/*
+ * Estadísticas de duración de pulsación en flujo, con RAM fija y tiempo
+ * constante por muestra (no se guardan las muestras).
+ *
+ * Por botón (hasta PSTATS_MAX_BTN), con la duración en ms:
+ *  - número, mínimo y máximo;
+ *  - media a partir de la suma exacta de 64 bits (en Q16; no deriva por
+ *    muchas muestras que haya) y varianza de Welford con esa media
+ *    (suma de cuadrados en Q16; una división de 64 bits por muestra);
+ *  - histograma log2: la cubeta k cuenta 2^(k-1) <= ms < 2^k (la 0,
+ *    ms = 0; la última acumula el resto);
+ *  - p50, p95 y p99 con el estimador P² (Jain y Chlamtac, "The P²
+ *    algorithm for dynamic calculation of quantiles and histograms
+ *    without storing observations", 1985): cinco marcadores por cuantil
+ *    cuyas alturas se corrigen con interpolación parabólica. Hasta la
+ *    quinta muestra el cuantil es exacto (rango más cercano).
+ *
+ * Resumen: un flanco de subida en PSTATS_DUMP_MASK (PSTATS_POLL),
+ * pstats_dump() o cada PSTATS_EVERY muestras (0 = solo a petición). Se
+ * envía poco a poco con el registro diferido, como el volcado de instr.h.
+ * Con las estadísticas activas, la línea por pulsación se omite
+ * (PSTATS_EACH = 0): el tráfico de UART pasa a ser solo el resumen.
+ *
+ * pstats_add() y el volcado se llaman desde el mismo contexto (main).
+ * Con PSTATS_ENABLE = 0 (por defecto) las macros no generan código.
+ * Comprobación frente a los valores exactos: tools/pstats_check.c.
+ */
+#ifndef PSTATS_H
+#define PSTATS_H
+
+#include "riscv_types.h"
+#include "gpio_drv.h"
+
+#ifndef PSTATS_ENABLE
+#define PSTATS_ENABLE    (0)
+#endif
+
+/* 1: seguir emitiendo la línea de cada pulsación. */
+#ifndef PSTATS_EACH
+#define PSTATS_EACH      (!PSTATS_ENABLE)
+#endif
+
+#ifndef PSTATS_MAX_BTN
+#define PSTATS_MAX_BTN   (4u)
+#endif
+
+/* Resumen automático cada N muestras (0 = solo a petición). */
+#ifndef PSTATS_EVERY
+#define PSTATS_EVERY     (0u)
+#endif
+
+/* Botón que pide el resumen. */
+#ifndef PSTATS_DUMP_MASK
+#define PSTATS_DUMP_MASK PBT_2_MASK
+#endif
+
+#define PSTATS_BUCKETS   (18u)           /* Hasta 2^16 ms y resto.      */
+
+enum { PSTATS_P50, PSTATS_P95, PSTATS_P99, PSTATS_N_Q };
+
+/* Estimador P²: alturas (ms en Q8), posiciones (1..n) y diferencia
+ * entre la posición deseada y la real (Q16). */
+typedef struct {
+    int32_t  q[5];
+    uint32_t n[5];
+    int32_t  d[5];
+} pstats_p2_t;
+
+typedef struct {
+    uint32_t    n;
+    uint32_t    min;
+    uint32_t    max;
+    uint64_t    sum;            /* Suma de las duraciones (ms).          */
+    int64_t     mean_q16;       /* sum / n en Q16.                       */
+    uint64_t    m2_q16;
+    uint32_t    bucket[PSTATS_BUCKETS];
+    pstats_p2_t p2[PSTATS_N_Q];
+} pstats_t;
+
+/* Añade una duración (ms) del botón 'btn'. */
+void pstats_add(uint8_t btn, uint32_t ms);
+
+/* Lectura de resultados (ms; media y desviación redondeadas). */
+const pstats_t *pstats_get(uint8_t btn);
+uint32_t pstats_mean(uint8_t btn);
+uint32_t pstats_stddev(uint8_t btn);
+uint32_t pstats_quantile(uint8_t btn, uint8_t which);
+
+/* Pone a cero todos los botones. */
+void pstats_reset(void);
+
+#if PSTATS_ENABLE
+
+/* Inicia el resumen (si no hay uno en curso). */
+void pstats_dump(void);
+
+/* Detecta la petición de resumen y envía una parte. */
+void pstats_poll(uint32_t pins);
+
+#define PSTATS_ADD(btn, ms)  pstats_add((btn), (ms))
+#define PSTATS_POLL(pins)    pstats_poll(pins)
+
+#else /* !PSTATS_ENABLE */
+
+#define PSTATS_ADD(btn, ms)  ((void)0)
+#define PSTATS_POLL(pins)    ((void)0)
+
+#endif /* PSTATS_ENABLE */
+
+#endif /* PSTATS_H */
@@ -0,0 +1,254 @@
+#include "riscv_types.h"
+#include "riscv_monotonic_clock.h"
+
+#include "ffwd.h"
+#include "log.h"
+#include "coop_sched.h"
+
+sched_t sched;
+
+/* ------------------------------------------------------------------ */
+/* Cola de listas (montículo por plazo absoluto)                       */
+/* ------------------------------------------------------------------ */
+
+/* a va antes que b: plazo menor o, a igualdad, registrada antes. */
+static uint8_t before(uint8_t a, uint8_t b)
+{
+    uint64_t da = sched.task[a].due, db = sched.task[b].due;
+
+    return (uint8_t)((da < db) || ((da == db) && (a < b)));
+}
+
+static void heap_push(uint8_t id)
+{
+    uint8_t i = sched.n_ready++;
+
+    while (i > 0u) {
+        uint8_t parent = (uint8_t)((i - 1u) / 2u);
+
+        if (!before(id, sched.heap[parent])) {
+            break;
+        }
+        sched.heap[i] = sched.heap[parent];
+        i = parent;
+    }
+    sched.heap[i] = id;
+}
+
+static uint8_t heap_pop(void)
+{
+    uint8_t top = sched.heap[0];
+    uint8_t last = sched.heap[--sched.n_ready];
+    uint8_t i = 0u;
+
+    for (;;) {
+        uint8_t c = (uint8_t)(2u * i + 1u);
+
+        if (c >= sched.n_ready) {
+            break;
+        }
+        if (((c + 1u) < sched.n_ready) &&
+            before(sched.heap[c + 1u], sched.heap[c])) {
+            c++;
+        }
+        if (!before(sched.heap[c], last)) {
+            break;
+        }
+        sched.heap[i] = sched.heap[c];
+        i = c;
+    }
+    sched.heap[i] = last;
+    return top;
+}
+
+/* ------------------------------------------------------------------ */
+/* Activaciones                                                        */
+/* ------------------------------------------------------------------ */
+
+static void release(uint8_t id, uint64_t t)
+{
+    sched_task_t *k = &sched.task[id];
+
+    /* El trabajo anterior aún no se ha ejecutado: se funden. */
+    if (k->queued) {
+        k->st.overruns++;
+        return;
+    }
+    k->release = t;
+    k->due = t + k->deadline;
+    k->queued = 1u;
+    heap_push(id);
+}
+
+/* Recalcula el mínimo de las próximas activaciones periódicas. */
+static void update_next(void)
+{
+    uint64_t next = SCHED_NEVER;
+    uint8_t i;
+
+    for (i = 0u; i < sched.n_tasks; i++) {
+        if (sched.task[i].next < next) {
+            next = sched.task[i].next;
+        }
+    }
+    sched.next = next;
+    FFWD_DUE(&sched, next);
+}
+
+static void release_due(uint64_t now)
+{
+    uint32_t trig;
+    uint8_t i;
+
+    if (now >= sched.next) {
+        for (i = 0u; i < sched.n_tasks; i++) {
+            sched_task_t *k = &sched.task[i];
+
+            /* Rejilla fija: las activaciones atrasadas cuentan todas.
+             * Sin periodo, sched_start() es una activación diferida. */
+            while (now >= k->next) {
+                release(i, k->next);
+                k->next = (k->period != 0u) ? (k->next + k->period) :
+                                              SCHED_NEVER;
+            }
+        }
+        update_next();
+    }
+
+    if (amo_mask_load(&sched.trig) != 0u) {
+        trig = amo_mask_clear(&sched.trig, ~0u);
+        for (i = 0u; trig != 0u; i++, trig >>= 1) {
+            if (trig & 1u) {
+                release(i, now);
+            }
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* API                                                                 */
+/* ------------------------------------------------------------------ */
+
+static void reset_stat(sched_stat_t *st)
+{
+    st->runs = 0u;
+    st->run_max = 0u;
+    st->run_sum = 0u;
+    st->resp_max = 0u;
+    st->overruns = 0u;
+    st->misses = 0u;
+}
+
+void sched_init(void)
+{
+    sched.n_tasks = 0u;
+    sched.n_ready = 0u;
+    sched.next = SCHED_NEVER;
+    sched.trig.v = 0u;
+}
+
+uint8_t sched_add(const char *name, sched_fn_t fn, uint32_t period,
+                  uint32_t deadline)
+{
+    uint8_t id = sched.n_tasks;
+    sched_task_t *k;
+
+    /* Tabla llena: error de configuración (subir SCHED_MAX_TASKS). Se
+     * para aquí en lugar de escribir fuera de task[] y heap[]. */
+    if (id >= SCHED_MAX_TASKS) {
+        __builtin_trap();
+    }
+    sched.n_tasks = (uint8_t)(id + 1u);
+    k = &sched.task[id];
+
+    k->name = name;
+    k->fn = fn;
+    k->period = period;
+    k->deadline = deadline;
+    k->next = SCHED_NEVER;
+    k->queued = 0u;
+    reset_stat(&k->st);
+    return id;
+}
+
+void sched_start(uint8_t id, uint64_t first)
+{
+    sched.task[id].next = first;
+    if (first < sched.next) {
+        sched.next = first;
+        FFWD_DUE(&sched, first);
+    }
+}
+
+void sched_stop(uint8_t id)
+{
+    sched.task[id].next = SCHED_NEVER;
+    update_next();
+}
+
+/* Anota un trabajo activado en 'rel', iniciado en 'start' y terminado
+ * en 'end'. */
+static void account(sched_task_t *k, uint64_t rel, uint64_t start,
+                    uint64_t end)
+{
+    uint32_t run = (uint32_t)(end - start);
+    uint32_t resp = (uint32_t)(end - rel);
+
+    k->st.runs++;
+    k->st.run_sum += run;
+    if (run > k->st.run_max) {
+        k->st.run_max = run;
+    }
+    if (resp > k->st.resp_max) {
+        k->st.resp_max = resp;
+    }
+    if (end > rel + k->deadline) {
+        k->st.misses++;
+    }
+}
+
+uint8_t sched_run(void)
+{
+    uint64_t now = get_ticks_from_reset();
+    sched_task_t *k;
+    uint8_t id;
+
+    release_due(now);
+    if (sched.n_ready == 0u) {
+        FFWD_IDLE(sched.next);
+        return 0u;
+    }
+
+    id = heap_pop();
+    k = &sched.task[id];
+    k->queued = 0u;
+    k->fn(now);
+    account(k, k->release, now, get_ticks_from_reset());
+    return 1u;
+}
+
+void sched_account(uint8_t id, uint64_t rel, uint64_t start)
+{
+    account(&sched.task[id], rel, start, get_ticks_from_reset());
+}
+
+void sched_reset_stats(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < sched.n_tasks; i++) {
+        reset_stat(&sched.task[i].st);
+    }
+}
+
+void sched_log_stats(void)
+{
+    uint8_t i;
+
+    for (i = 0u; i < sched.n_tasks; i++) {
+        const sched_stat_t *st = &sched.task[i].st;
+
+        LOG2(LOG_SCHED_TASK, i, st->resp_max);
+        LOG2(LOG_SCHED_MISS, st->misses, st->overruns);
+    }
+}
@@ -0,0 +1,22 @@
+/*
+ * Sustituto de host de clinc.h (CLINT) para el simulador.
+ * El reloj virtual avanza a CLINT_CLOCK ticks por segundo.
+ */
+#ifndef CLINC_H
+#define CLINC_H
+
+#include <stdint.h>
+
+#ifndef CLINT_CLOCK
+#define CLINT_CLOCK  (10000000U)              /* 10 MHz                  */
+#endif
+
+/* Programa mtimecmp = mtime + gap; tras cada IRQ se rearma con el mismo
+ * gap salvo que el manejador vuelva a llamar a esta función. gap = 0
+ * desarma el comparador. */
+void local_timer_set_gap(uint64_t gap);
+
+void enable_timer_clinc_irq(void);
+void disable_timer_clinc_irq(void);
+
+#endif /* CLINC_H */
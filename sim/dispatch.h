@@ -0,0 +1,16 @@
+/*
+ * Sustituto de host de dispatch.h para el simulador.
+ */
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+void install_local_timer_handler(void (*handler)(void));
+void install_gpio_handler(void (*handler)(void));
+
+/* IRQ de recepción de la UART: se pide con cada byte que llega. */
+void install_uart_rx_handler(void (*handler)(void));
+
+void enable_irq(void);
+void disable_irq(void);
+
+#endif /* DISPATCH_H */
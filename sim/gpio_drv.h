@@ -0,0 +1,31 @@
+/*
+ * Sustituto de host de gpio_drv.h para el simulador (ver sim_hal.h).
+ * Mismo mapeo que la placa:
+ *  - Botones 0-3 en bits 4-7 (PBT_0 -> bit4, ..., PBT_3 -> bit7).
+ *  - LEDs 0-3 en bits 16-19 (LED_0 -> bit16, ..., LED_3 -> bit19).
+ */
+#ifndef GPIO_DRV_H
+#define GPIO_DRV_H
+
+#include <stdint.h>
+
+#define PBT_0_MASK  (1u << 4)
+#define PBT_1_MASK  (1u << 5)
+#define PBT_2_MASK  (1u << 6)
+#define PBT_3_MASK  (1u << 7)
+
+#define LED_0_MASK  (1u << 16)
+#define LED_1_MASK  (1u << 17)
+#define LED_2_MASK  (1u << 18)
+#define LED_3_MASK  (1u << 19)
+
+void gpio_set_direction(uint32_t direction);
+void gpio_write(uint32_t output);
+uint32_t gpio_read(void);
+
+/* Interrupción por cambio de nivel en los pines de 'mask' (API supuesta
+ * del driver; el manejador se instala con install_gpio_handler()). */
+void gpio_irq_enable(uint32_t mask);
+void gpio_irq_disable(uint32_t mask);
+
+#endif /* GPIO_DRV_H */
@@ -0,0 +1,12 @@
+/*
+ * Sustituto de host de riscv_monotonic_clock.h para el simulador.
+ */
+#ifndef RISCV_MONOTONIC_CLOCK_H
+#define RISCV_MONOTONIC_CLOCK_H
+
+#include <stdint.h>
+
+/* Ticks de CLINT_CLOCK desde el reset (reloj virtual). */
+uint64_t get_ticks_from_reset(void);
+
+#endif /* RISCV_MONOTONIC_CLOCK_H */
@@ -0,0 +1,10 @@
+/*
+ * Sustituto de host de riscv_types.h para el simulador.
+ */
+#ifndef RISCV_TYPES_H
+#define RISCV_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#endif /* RISCV_TYPES_H */
@@ -0,0 +1,22 @@
+/*
+ * Sustituto de host de riscv_uart.h para el simulador.
+ * printf() lo intercepta sim_hal.c: cada línea se cuenta, se sella con
+ * el reloj virtual y consume el tiempo de transmisión por la UART.
+ * Los bytes recibidos salen del guion de sim_main.c -c.
+ */
+#ifndef RISCV_UART_H
+#define RISCV_UART_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Envío sin bloqueo de un byte: solo llamar a riscv_uart_putc() si
+ * riscv_uart_tx_ready() devuelve distinto de 0. */
+int  riscv_uart_tx_ready(void);
+void riscv_uart_putc(uint8_t c);
+
+/* Recepción: hay un byte en la FIFO de entrada / lo saca. */
+int     riscv_uart_rx_ready(void);
+uint8_t riscv_uart_getc(void);
+
+#endif /* RISCV_UART_H */
@@ -0,0 +1,831 @@
+/*
+ * Implementación del HAL simulado con reloj virtual (ver sim_hal.h).
+ */
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "sim_hal.h"
+
+#include "clinc.h"
+#include "dispatch.h"
+#include "gpio_drv.h"
+#include "riscv_monotonic_clock.h"
+#include "riscv_uart.h"
+
+#include "console.h"
+#include "gpio_out.h"
+#include "lacap.h"
+#include "log_fmt.h"
+#include "coop_sched.h"
+
+sim_ctx_t *sim_cur = NULL;
+
+/* Capa de salida (gpio_out.c), si la variante la enlaza. */
+extern gpio_out_t gpio_out __attribute__((weak));
+
+/* Planificador (sched.c), si la variante lo enlaza. */
+extern sched_t sched __attribute__((weak));
+
+/* Analizador lógico (lacap.c), si la variante lo enlaza. */
+extern lacap_t lacap __attribute__((weak));
+
+/* Consola (console.c), si la variante la enlaza. */
+extern console_t console __attribute__((weak));
+
+/* ------------------------------------------------------------------ */
+/* Reloj virtual                                                       */
+/* ------------------------------------------------------------------ */
+
+/* Aplica el siguiente evento del guion en el instante s->now. */
+static void sim_apply_input(sim_ctx_t *s)
+{
+    uint32_t next = s->ev[s->ev_idx].pins;
+
+    /* Liberación de PBT_0: arranca la medida de latencia. */
+    if (s->in & ~next & PBT_0_MASK) {
+        s->release_pending = 1u;
+        s->t_release = s->ev[s->ev_idx].t;
+    }
+    if ((s->in ^ next) & s->gpio_irq_mask) {
+        s->gpio_pending = 1u;
+    }
+    s->in = next;
+    s->ev_idx++;
+    s->ff_act = 1u;
+}
+
+/* Llega el siguiente byte del guion de recepción en el instante
+ * s->now. */
+static void sim_apply_rx(sim_ctx_t *s)
+{
+    uint8_t c = s->rx[s->rx_idx++].c;
+
+    if (s->rx_count < SIM_RX_FIFO) {
+        s->rx_fifo[(s->rx_head + s->rx_count) % SIM_RX_FIFO] = c;
+        s->rx_count++;
+    } else {
+        s->rx_lost++;
+    }
+    if (s->uart_rx_handler != NULL) {
+        s->rx_pending = 1u;
+    }
+    s->ff_act = 1u;
+}
+
+/* Ejecuta 'handler' como ISR en el instante s->now; devuelve su
+ * duración (entrada y salida incluidas). */
+static uint64_t sim_fire(sim_ctx_t *s, void (*handler)(void),
+                         uint64_t *max)
+{
+    uint64_t t0 = s->now;
+    uint64_t dur;
+
+    s->in_isr = 1u;
+    s->ff_act = 1u;
+    s->now += SIM_COST_ISR_ENTRY;
+    if (handler != NULL) {
+        handler();
+    }
+    s->in_isr = 0u;
+
+    dur = s->now - t0;
+    s->isr_ticks += dur;
+    if (dur > *max) {
+        *max = dur;
+    }
+    return dur;
+}
+
+static uint64_t sim_fire_timer(sim_ctx_t *s)
+{
+    uint64_t t0 = s->now;
+    uint64_t dur;
+
+    s->timer_irqs++;
+    s->rearmed = 0u;
+    dur = sim_fire(s, s->timer_handler, &s->timer_isr_max);
+
+    /* Recarga periódica salvo que el manejador haya reprogramado. */
+    if (!s->rearmed) {
+        if (s->gap != 0u) {
+            s->mtimecmp = t0 + s->gap;
+        } else {
+            s->timer_armed = 0u;
+        }
+    }
+    return dur;
+}
+
+static uint64_t sim_fire_gpio(sim_ctx_t *s)
+{
+    s->gpio_irqs++;
+    s->gpio_pending = 0u;
+    return sim_fire(s, s->gpio_handler, &s->gpio_isr_max);
+}
+
+static uint64_t sim_fire_rx(sim_ctx_t *s)
+{
+    s->rx_irqs++;
+    s->rx_pending = 0u;
+    return sim_fire(s, s->uart_rx_handler, &s->rx_isr_max);
+}
+
+/* ------------------------------------------------------------------ */
+/* Dos harts                                                           */
+/* ------------------------------------------------------------------ */
+
+/* Cede el turno si esta hart saca más de SIM_HART_QUANTUM a la otra.
+ * Se llama con hart_mtx tomado. */
+static void sim_hart_yield(sim_ctx_t *s)
+{
+    uint8_t h = s->hart;
+    uint8_t o = (uint8_t)(h ^ 1u);
+
+    s->hart_now[h] = s->now;
+    if (s->hart_done[o] || (s->now <= s->hart_now[o] + SIM_HART_QUANTUM)) {
+        return;
+    }
+    s->hart = o;
+    pthread_cond_broadcast(&s->hart_cv);
+    while (s->hart != h) {
+        pthread_cond_wait(&s->hart_cv, &s->hart_mtx);
+    }
+    s->now = s->hart_now[h];
+}
+
+/* sim_advance() con dos harts: sin interrupciones. Cada hart ve las
+ * entradas de su instante; las estadísticas de entrada (sim_apply_input)
+ * las lleva la hart que pasa primero por cada evento. */
+static void sim_advance2(sim_ctx_t *s, uint64_t cost)
+{
+    uint8_t h = s->hart;
+
+    s->now += cost;
+    if (s->now >= s->end) {
+        s->hart_now[h] = s->now;
+        longjmp(s->hart_exit[h], 1);
+    }
+    while ((s->hart_ev[h] < s->n_ev) && (s->ev[s->hart_ev[h]].t <= s->now)) {
+        s->hart_in[h] = s->ev[s->hart_ev[h]++].pins;
+    }
+    while ((s->ev_idx < s->n_ev) && (s->ev[s->ev_idx].t <= s->now)) {
+        sim_apply_input(s);
+    }
+    sim_hart_yield(s);
+}
+
+void sim_advance(uint64_t cost)
+{
+    sim_ctx_t *s = sim_cur;
+    uint64_t target = s->now + cost;
+
+    if (s->harts == 2u) {
+        sim_advance2(s, cost);
+        return;
+    }
+
+    /* Recorre en orden temporal los cambios de entrada, los bytes
+     * recibidos y los plazos del timer hasta 'target'; cada ISR atendida
+     * retrasa 'target' lo que dure. Dentro de una ISR solo pasa el tiempo
+     * (no hay anidamiento). */
+    for (;;) {
+        uint64_t t_in = UINT64_MAX;
+        uint64_t t_rx = UINT64_MAX;
+        uint64_t t_tm = UINT64_MAX;
+        uint8_t  can_irq = (uint8_t)(!s->in_isr && s->irq_on);
+
+        if (can_irq && s->gpio_pending) {
+            target += sim_fire_gpio(s);
+            continue;
+        }
+        if (can_irq && s->rx_pending) {
+            target += sim_fire_rx(s);
+            continue;
+        }
+
+        if (s->ev_idx < s->n_ev) {
+            t_in = s->ev[s->ev_idx].t;
+        }
+        if (s->rx_idx < s->n_rx) {
+            t_rx = s->rx[s->rx_idx].t;
+        }
+        if (can_irq && s->timer_irq_on && s->timer_armed) {
+            t_tm = s->mtimecmp;
+        }
+        if ((t_in > target) && (t_rx > target) && (t_tm > target)) {
+            break;
+        }
+
+        if ((t_rx < t_in) && (t_rx <= t_tm)) {
+            if (t_rx > s->now) {
+                s->now = t_rx;
+            }
+            sim_apply_rx(s);
+        } else if (t_in <= t_tm) {
+            if (t_in > s->now) {
+                s->now = t_in;
+            }
+            sim_apply_input(s);
+        } else {
+            if (t_tm > s->now) {
+                s->now = t_tm;
+            }
+            target += sim_fire_timer(s);
+        }
+    }
+
+    s->now = target;
+    if (s->now >= s->end) {
+        longjmp(s->exit, 1);
+    }
+}
+
+/* Sin IRQ que pueda despertar, duerme hasta el final. Con dos harts no
+ * se modela: solo pasa el coste de la instrucción. */
+void sim_wfi(void)
+{
+    sim_ctx_t *s = sim_cur;
+    uint64_t t0 = s->now;
+
+    if (s->harts == 2u) {
+        sim_advance(1u);
+        return;
+    }
+
+    while (!s->gpio_pending && !s->rx_pending) {
+        uint64_t t_in = UINT64_MAX;
+        uint64_t t_rx = UINT64_MAX;
+        uint64_t t_tm = UINT64_MAX;
+
+        if (s->ev_idx < s->n_ev) {
+            t_in = s->ev[s->ev_idx].t;
+        }
+        if (s->rx_idx < s->n_rx) {
+            t_rx = s->rx[s->rx_idx].t;
+        }
+        if (s->timer_irq_on && s->timer_armed) {
+            t_tm = s->mtimecmp;
+        }
+        if ((t_in >= s->end) && (t_rx >= s->end) && (t_tm >= s->end)) {
+            s->now = s->end;
+            break;
+        }
+        if ((t_tm <= t_in) && (t_tm <= t_rx)) {
+            if (t_tm > s->now) {
+                s->now = t_tm;
+            }
+            break;
+        }
+        if (t_rx < t_in) {
+            if (t_rx > s->now) {
+                s->now = t_rx;
+            }
+            sim_apply_rx(s);
+        } else {
+            if (t_in > s->now) {
+                s->now = t_in;
+            }
+            sim_apply_input(s);
+        }
+    }
+
+    s->wfi_ticks += s->now - t0;
+    s->wfi_count++;
+    if (s->now >= s->end) {
+        longjmp(s->exit, 1);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Avance rápido (ffwd.h)                                              */
+/* ------------------------------------------------------------------ */
+
+/* Próximo suceso antes de 't': entrada, byte recibido, IRQ, UART libre,
+ * plazo anunciado o fin de la simulación. */
+static uint64_t sim_ffwd_target(const sim_ctx_t *s, uint64_t t)
+{
+    uint8_t i;
+
+    if (s->gpio_pending || s->rx_pending) {
+        return s->now;
+    }
+    if ((s->ev_idx < s->n_ev) && (s->ev[s->ev_idx].t < t)) {
+        t = s->ev[s->ev_idx].t;
+    }
+    if ((s->rx_idx < s->n_rx) && (s->rx[s->rx_idx].t < t)) {
+        t = s->rx[s->rx_idx].t;
+    }
+    if (s->irq_on && s->timer_irq_on && s->timer_armed &&
+        (s->mtimecmp < t)) {
+        t = s->mtimecmp;
+    }
+    if ((s->uart_busy_until > s->now) && (s->uart_busy_until < t)) {
+        t = s->uart_busy_until;
+    }
+    for (i = 0u; i < s->ff_n; i++) {
+        if (s->ff_due[i] < t) {
+            t = s->ff_due[i];
+        }
+    }
+    return (t < s->end) ? t : s->end;
+}
+
+static void sim_ffwd_jump(sim_ctx_t *s, uint64_t t)
+{
+    if (t > s->now) {
+        s->ff_ticks += t - s->now;
+        s->ff_jumps++;
+        s->now = t;
+    }
+}
+
+/* Inicio de una vuelta del super-bucle (gpio_read desde main). */
+static void sim_ffwd_loop(sim_ctx_t *s)
+{
+    if (s->ff_act) {
+        s->ff_act = 0u;
+        s->ff_quiet = 0u;
+        return;
+    }
+    if (s->ff_quiet < 2u) {
+        s->ff_quiet++;
+    }
+    if ((s->ff_quiet >= 2u) && (s->ff_n != 0u) && !s->ff_sched) {
+        sim_ffwd_jump(s, sim_ffwd_target(s, UINT64_MAX));
+    }
+}
+
+void sim_ffwd_due(const void *key, uint64_t t)
+{
+    sim_ctx_t *s = sim_cur;
+    uint8_t i;
+
+    for (i = 0u; (i < s->ff_n) && (s->ff_key[i] != key); i++) {
+    }
+    if (i == s->ff_n) {
+        if (s->ff_n == SIM_FFWD_KEYS) {
+            return;
+        }
+        s->ff_key[s->ff_n++] = key;
+    }
+    s->ff_due[i] = t;
+}
+
+void sim_ffwd_idle(uint64_t t)
+{
+    sim_ctx_t *s = sim_cur;
+
+    /* El bucle lo lleva el planificador: solo se salta aquí, nunca en
+     * medio de un trabajo. */
+    s->ff_sched = 1u;
+    if (s->ffwd && (s->harts != 2u) && !s->in_isr) {
+        sim_ffwd_jump(s, sim_ffwd_target(s, t));
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* HAL: GPIO                                                           */
+/* ------------------------------------------------------------------ */
+void gpio_set_direction(uint32_t direction)
+{
+    sim_cur->dir = direction;
+}
+
+void gpio_write(uint32_t output)
+{
+    sim_ctx_t *s = sim_cur;
+
+    s->gpio_writes++;
+    if (output == s->out) {
+        s->gpio_writes_same++;
+    }
+    s->out = output;
+    s->ff_act = 1u;
+    if (s->golden != NULL) {
+        fprintf(s->golden, "%llu gpio %08x\n", (unsigned long long)s->now,
+                (unsigned)output);
+    }
+    sim_advance(SIM_COST_GPIO_WRITE);
+}
+
+void gpio_irq_enable(uint32_t mask)   { sim_cur->gpio_irq_mask |= mask; }
+void gpio_irq_disable(uint32_t mask)  { sim_cur->gpio_irq_mask &= ~mask; }
+
+uint32_t gpio_read(void)
+{
+    sim_ctx_t *s = sim_cur;
+
+    s->gpio_reads++;
+    if (!s->in_isr) {
+        if (s->loop_iters != 0u) {
+            uint64_t gap = s->now - s->loop_last;
+
+            if (gap > s->loop_gap_max) {
+                s->loop_gap_max = gap;
+            }
+            if ((s->loop_iters == 1u) || (gap < s->loop_gap_min)) {
+                s->loop_gap_min = gap;
+            }
+            s->loop_gap_sum += gap;
+            s->loop_gap_sq += (double)gap * (double)gap;
+        }
+        s->loop_iters++;
+        if (s->ffwd && (s->harts != 2u)) {
+            sim_ffwd_loop(s);
+        }
+        s->loop_last = s->now;
+    }
+    sim_advance(SIM_COST_GPIO_READ);
+
+    /* Las salidas se leen del latch; el resto, de los pines. */
+    if (s->harts == 2u) {
+        return (s->hart_in[s->hart] & ~s->dir) | (s->out & s->dir);
+    }
+    return (s->in & ~s->dir) | (s->out & s->dir);
+}
+
+/* ------------------------------------------------------------------ */
+/* HAL: reloj monotónico, CLINT y dispatch                             */
+/* ------------------------------------------------------------------ */
+uint64_t get_ticks_from_reset(void)
+{
+    sim_advance(SIM_COST_GET_TICKS);
+    return sim_cur->now;
+}
+
+void local_timer_set_gap(uint64_t gap)
+{
+    sim_ctx_t *s = sim_cur;
+
+    s->gap = gap;
+    s->rearmed = 1u;
+    if (gap != 0u) {
+        s->mtimecmp = s->now + gap;
+        s->timer_armed = 1u;
+    } else {
+        s->timer_armed = 0u;
+    }
+}
+
+void enable_timer_clinc_irq(void)   { sim_cur->timer_irq_on = 1u; }
+void disable_timer_clinc_irq(void)  { sim_cur->timer_irq_on = 0u; }
+
+void install_local_timer_handler(void (*handler)(void))
+{
+    sim_cur->timer_handler = handler;
+}
+
+void install_gpio_handler(void (*handler)(void))
+{
+    sim_cur->gpio_handler = handler;
+}
+
+void install_uart_rx_handler(void (*handler)(void))
+{
+    sim_cur->uart_rx_handler = handler;
+}
+
+void enable_irq(void)   { sim_cur->irq_on = 1u; }
+void disable_irq(void)  { sim_cur->irq_on = 0u; }
+
+/* ------------------------------------------------------------------ */
+/* HAL: UART                                                           */
+/* ------------------------------------------------------------------ */
+
+/* Contabiliza una línea completa en el instante actual. */
+static void sim_line(sim_ctx_t *s, const char *line)
+{
+    s->lines++;
+    if (s->release_pending) {
+        uint64_t lat = s->now - s->t_release;
+
+        s->release_pending = 0u;
+        if ((s->lat_n == 0u) || (lat < s->lat_min)) {
+            s->lat_min = lat;
+        }
+        if (lat > s->lat_max) {
+            s->lat_max = lat;
+        }
+        s->lat_sum += lat;
+        s->lat_n++;
+    }
+
+    if (s->trace != NULL) {
+        fprintf(s->trace, "[%10.3f ms] %s",
+                (double)s->now / (double)SIM_TICKS_PER_MS, line);
+    }
+    if (s->golden != NULL) {
+        fprintf(s->golden, "%llu uart %s", (unsigned long long)s->now, line);
+    }
+}
+
+/* printf interceptado: bloquea hasta que sale el último carácter. */
+int printf(const char *fmt, ...)
+{
+    sim_ctx_t *s = sim_cur;
+    char buf[256];
+    uint64_t wait = 0u;
+    va_list ap;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(buf, sizeof buf, fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        return n;
+    }
+    if ((size_t)n >= sizeof buf) {
+        n = (int)(sizeof buf - 1u);
+    }
+
+    if (s->uart_busy_until > s->now) {
+        wait = s->uart_busy_until - s->now;
+    }
+    s->uart_chars += (uint64_t)n;
+    s->ff_act = 1u;
+    sim_advance(wait + SIM_COST_PRINTF + (uint64_t)n * SIM_TICKS_PER_CHAR);
+    s->uart_busy_until = s->now;
+
+    sim_line(s, buf);
+    return n;
+}
+
+int riscv_uart_tx_ready(void)
+{
+    sim_advance(SIM_COST_GPIO_READ);
+    return sim_cur->now >= sim_cur->uart_busy_until;
+}
+
+int riscv_uart_rx_ready(void)
+{
+    sim_advance(SIM_COST_GPIO_READ);
+    return sim_cur->rx_count != 0u;
+}
+
+uint8_t riscv_uart_getc(void)
+{
+    sim_ctx_t *s = sim_cur;
+    uint8_t c = 0u;
+
+    sim_advance(SIM_COST_GPIO_READ);
+    if (s->rx_count != 0u) {
+        c = s->rx_fifo[s->rx_head];
+        s->rx_head = (uint8_t)((s->rx_head + 1u) % SIM_RX_FIFO);
+        s->rx_count--;
+    }
+    return c;
+}
+
+void riscv_uart_putc(uint8_t c)
+{
+    sim_ctx_t *s = sim_cur;
+    char line[128];
+
+    s->ff_act = 1u;
+    sim_advance(SIM_COST_GPIO_WRITE);
+
+    /* El carácter termina de salir un tiempo de carácter después. */
+    s->uart_chars++;
+    s->uart_busy_until = s->now + SIM_TICKS_PER_CHAR;
+
+    /* Texto plano (LOG_DEFERRED = 0): fuera de una trama binaria, los
+     * bytes se acumulan hasta el '\n'. */
+    if ((s->logdec.state == 0u) && (c != LOG_SYNC)) {
+        if (s->text_len < (sizeof s->text - 1u)) {
+            s->text[s->text_len++] = (char)c;
+        }
+        if (c != '\n') {
+            return;
+        }
+        s->text[s->text_len] = '\0';
+        s->text_len = 0u;
+        strcpy(line, s->text);
+    } else if (log_decode_byte(&s->logdec, c, line, sizeof line) <= 0) {
+        return;
+    }
+
+    {
+        uint64_t now = s->now;
+
+        s->now = s->uart_busy_until;
+        sim_line(s, line);
+        s->now = now;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Trabajo de CPU modelado                                             */
+/* ------------------------------------------------------------------ */
+void sim_cpu(uint32_t ticks)
+{
+    sim_advance(ticks);
+}
+
+/* ------------------------------------------------------------------ */
+/* Control de la simulación                                            */
+/* ------------------------------------------------------------------ */
+void sim_init(sim_ctx_t *ctx, const sim_event_t *ev, size_t n_ev,
+              uint64_t duration)
+{
+    memset(ctx, 0, sizeof *ctx);
+    ctx->ev = ev;
+    ctx->n_ev = n_ev;
+    ctx->end = duration;
+    log_decoder_init(&ctx->logdec);
+}
+
+void sim_run(sim_ctx_t *ctx, int (*app)(void))
+{
+    sim_cur = ctx;
+    while ((ctx->ev_idx < ctx->n_ev) && (ctx->ev[ctx->ev_idx].t == 0u)) {
+        sim_apply_input(ctx);
+    }
+
+    if (setjmp(ctx->exit) == 0) {
+        (void)app();
+    }
+}
+
+typedef struct {
+    sim_ctx_t *ctx;
+    int      (*app)(void);
+    uint8_t    hart;
+} sim_hart_arg_t;
+
+static void *sim_hart_main(void *p)
+{
+    const sim_hart_arg_t *a = p;
+    sim_ctx_t *s = a->ctx;
+    uint8_t h = a->hart;
+
+    pthread_mutex_lock(&s->hart_mtx);
+    while (s->hart != h) {
+        pthread_cond_wait(&s->hart_cv, &s->hart_mtx);
+    }
+    s->now = s->hart_now[h];
+    if (setjmp(s->hart_exit[h]) == 0) {
+        (void)a->app();
+        s->hart_now[h] = s->now;
+    }
+
+    /* Terminada (fin de la simulación o app() ha vuelto): turno a la
+     * otra si sigue viva. */
+    s->hart_done[h] = 1u;
+    if (!s->hart_done[h ^ 1u]) {
+        s->hart = (uint8_t)(h ^ 1u);
+        pthread_cond_broadcast(&s->hart_cv);
+    }
+    pthread_mutex_unlock(&s->hart_mtx);
+    return NULL;
+}
+
+void sim_run2(sim_ctx_t *ctx, int (*app)(void))
+{
+    sim_hart_arg_t arg[2];
+    pthread_t th[2];
+    uint8_t h;
+
+    sim_cur = ctx;
+    while ((ctx->ev_idx < ctx->n_ev) && (ctx->ev[ctx->ev_idx].t == 0u)) {
+        sim_apply_input(ctx);
+    }
+
+    ctx->harts = 2u;
+    ctx->hart = 0u;
+    for (h = 0u; h < 2u; h++) {
+        ctx->hart_ev[h] = ctx->ev_idx;
+        ctx->hart_in[h] = ctx->in;
+    }
+    pthread_mutex_init(&ctx->hart_mtx, NULL);
+    pthread_cond_init(&ctx->hart_cv, NULL);
+    for (h = 0u; h < 2u; h++) {
+        arg[h].ctx = ctx;
+        arg[h].app = app;
+        arg[h].hart = h;
+        pthread_create(&th[h], NULL, sim_hart_main, &arg[h]);
+    }
+    for (h = 0u; h < 2u; h++) {
+        pthread_join(th[h], NULL);
+    }
+    pthread_cond_destroy(&ctx->hart_cv);
+    pthread_mutex_destroy(&ctx->hart_mtx);
+
+    ctx->now = (ctx->hart_now[0] > ctx->hart_now[1]) ?
+               ctx->hart_now[0] : ctx->hart_now[1];
+}
+
+uint32_t sim_hart_id(void)
+{
+    return sim_cur->hart;
+}
+
+void sim_report(const sim_ctx_t *ctx, const char *name, FILE *out)
+{
+    double secs = (double)ctx->now / (double)CLINT_CLOCK;
+    double ms = (double)SIM_TICKS_PER_MS;
+
+    fprintf(out, "%s: %.3f s virtuales\n", name, secs);
+    fprintf(out, "  iteraciones/s      : %.0f\n",
+            (double)ctx->loop_iters / secs);
+    fprintf(out, "  vuelta más larga   : %.3f ms\n",
+            (double)ctx->loop_gap_max / ms);
+    if (ctx->loop_iters > 1u) {
+        double n = (double)(ctx->loop_iters - 1u);
+        double mean = (double)ctx->loop_gap_sum / n;
+        double var = ctx->loop_gap_sq / n - mean * mean;
+        double us = ms / 1000.0;
+
+        fprintf(out, "  intervalo de lectura: min %.1f / med %.1f / "
+                "max %.1f us, desv %.2f us\n",
+                (double)ctx->loop_gap_min / us, mean / us,
+                (double)ctx->loop_gap_max / us,
+                (var > 0.0) ? sqrt(var) / us : 0.0);
+    }
+    fprintf(out, "  gpio_write         : %llu (%.1f/s, %llu sin cambio)\n",
+            (unsigned long long)ctx->gpio_writes,
+            (double)ctx->gpio_writes / secs,
+            (unsigned long long)ctx->gpio_writes_same);
+    if (&gpio_out != NULL) {
+        fprintf(out, "  gpio_out lóg./fís. : %u / %u\n",
+                (unsigned)gpio_out_logical(), (unsigned)gpio_out_physical());
+    }
+    fprintf(out, "  IRQ timer          : %llu (%.1f/s, máx %llu ticks)\n",
+            (unsigned long long)ctx->timer_irqs,
+            (double)ctx->timer_irqs / secs,
+            (unsigned long long)ctx->timer_isr_max);
+    fprintf(out, "  IRQ GPIO           : %llu (%.1f/s, máx %llu ticks)\n",
+            (unsigned long long)ctx->gpio_irqs,
+            (double)ctx->gpio_irqs / secs,
+            (unsigned long long)ctx->gpio_isr_max);
+    if (ctx->n_rx != 0u) {
+        fprintf(out, "  IRQ UART rx        : %llu (máx %llu ticks, %llu de "
+                "%zu bytes perdidos)\n",
+                (unsigned long long)ctx->rx_irqs,
+                (unsigned long long)ctx->rx_isr_max,
+                (unsigned long long)ctx->rx_lost, ctx->n_rx);
+    }
+    fprintf(out, "  CPU en ISR         : %.3f%%\n",
+            100.0 * (double)ctx->isr_ticks / (double)ctx->now);
+    fprintf(out, "  CPU activa         : %.3f%% (%.4g ciclos/h, %llu WFI)\n",
+            100.0 * (double)(ctx->now - ctx->wfi_ticks) / (double)ctx->now,
+            (double)(ctx->now - ctx->wfi_ticks) * SIM_CYCLES_PER_TICK *
+            3600.0 / secs, (unsigned long long)ctx->wfi_count);
+    fprintf(out, "  líneas impresas    : %llu (%llu caracteres)\n",
+            (unsigned long long)ctx->lines,
+            (unsigned long long)ctx->uart_chars);
+    if (ctx->ffwd) {
+        fprintf(out, "  avance rápido      : %llu saltos, %.3f%% del tiempo\n",
+                (unsigned long long)ctx->ff_jumps,
+                100.0 * (double)ctx->ff_ticks / (double)ctx->now);
+    }
+    if (ctx->logdec.dropped != 0u) {
+        fprintf(out, "  registros perdidos : %u\n",
+                (unsigned)ctx->logdec.dropped);
+    }
+    if (ctx->lat_n != 0u) {
+        fprintf(out, "  latencia suelta->línea: min %.3f / med %.3f / "
+                "max %.3f ms\n",
+                (double)ctx->lat_min / ms,
+                (double)ctx->lat_sum / (double)ctx->lat_n / ms,
+                (double)ctx->lat_max / ms);
+    }
+    if ((&lacap != NULL) && (lacap.samples != 0u)) {
+        fprintf(out, "  captura            : %u muestras, %u registros, "
+                "%u B\n", (unsigned)lacap.samples,
+                (unsigned)lacap.records, (unsigned)lacap.len);
+        if (lacap.len != 0u) {
+            /* Frente a guardar cada muestra (4 B) o cada cambio como
+             * instante de 32 bits y puerto (8 B). */
+            fprintf(out, "  captura: compresión: x%.0f frente a 4 B/muestra, "
+                    "x%.1f frente a 8 B/cambio\n",
+                    4.0 * (double)lacap.samples / (double)lacap.len,
+                    8.0 * (double)lacap.records / (double)lacap.len);
+        }
+        fprintf(out, "  captura: perdidos  : %u, máx %u ciclos/muestra\n",
+                (unsigned)lacap.lost, (unsigned)lacap.cyc_max);
+    }
+    if ((&console != NULL) && (ctx->n_rx != 0u)) {
+        fprintf(out, "  consola            : %u órdenes, %u bytes perdidos\n",
+                (unsigned)console.lines, (unsigned)console.overruns);
+    }
+    if ((&sched != NULL) && (sched.n_tasks != 0u)) {
+        double us = ms / 1000.0;
+        uint8_t i;
+
+        fprintf(out, "  %-10s %8s %18s %10s %6s %6s\n", "tarea",
+                "trabajos", "ejec. máx/med us", "resp. máx", "solap.",
+                "plazo");
+        for (i = 0u; i < sched.n_tasks; i++) {
+            const sched_stat_t *st = &sched.task[i].st;
+            double mean = (st->runs != 0u) ?
+                          (double)st->run_sum / (double)st->runs : 0.0;
+
+            fprintf(out, "  %-10s %8u %8.1f / %7.1f %10.1f %6u %6u\n",
+                    sched.task[i].name, (unsigned)st->runs,
+                    (double)st->run_max / us, mean / us,
+                    (double)st->resp_max / us, (unsigned)st->overruns,
+                    (unsigned)st->misses);
+        }
+    }
+}
@@ -0,0 +1,247 @@
+/*
+ * Simulador de host con reloj virtual para las variantes main_*.c.
+ *
+ * Sustituye al HAL de la placa (gpio_drv.h, clinc.h, dispatch.h,
+ * riscv_monotonic_clock.h y printf sobre la UART) por una implementación
+ * determinista:
+ *  - El tiempo es un contador virtual de CLINT_CLOCK (10 MHz). Solo avanza
+ *    cuando el programa llama al HAL, con el coste SIM_COST_* de cada
+ *    llamada, de modo que la misma entrada produce siempre la misma salida.
+ *  - El timer_handler instalado se ejecuta en el instante virtual exacto en
+ *    que mtime alcanza mtimecmp (dentro de la llamada al HAL en curso).
+ *  - Las entradas se leen de un guion de eventos (sim_event_t). Un cambio
+ *    en un pin con gpio_irq_enable() dispara el manejador de GPIO.
+ *  - Las ISR no se anidan: lo que llega durante una queda pendiente.
+ *  - printf() se intercepta: cada línea consume el tiempo de transmisión
+ *    a SIM_UART_BAUD y se mide su latencia desde la liberación del botón.
+ *  - riscv_uart_putc() ocupa la UART un carácter sin bloquear; las tramas
+ *    del registro diferido (log.h) se decodifican y cuentan como líneas.
+ *  - sim_run2() ejecuta la variante en dos harts (dos hilos de host) con
+ *    un reloj virtual por hart. Se ejecuta una sola hart cada vez, y la
+ *    que va por delante cede el turno (mutex y condición) al sacar más
+ *    de SIM_HART_QUANTUM ticks a la otra, así que el resultado sigue
+ *    siendo determinista. Cada hart lee las entradas del guion en su
+ *    propio instante; lo que una hart escribe en memoria compartida lo
+ *    ve la otra con un desfase de hasta SIM_HART_QUANTUM. En este modo
+ *    no se modelan interrupciones.
+ *  - cpu_wfi() (idle.h) adelanta el reloj hasta la siguiente IRQ
+ *    habilitada en su fuente (cambio en un pin de gpio_irq_enable() o
+ *    plazo del timer), aunque las IRQ estén deshabilitadas; el tiempo
+ *    dormido no cuenta como ciclos activos en el informe.
+ *  - Avance rápido (ffwd = 1, opción -x): un bucle que solo espera no
+ *    gira; el reloj salta al próximo suceso según los avisos de ffwd.h.
+ *    El resultado es el mismo salvo el instante exacto en que el bucle
+ *    ve cada cambio (al saltar, en el mismo tick; girando, en la vuelta
+ *    siguiente), así que se compara con otra ejecución con -x.
+ *  - golden != NULL: cada gpio_write() y cada línea de la UART se
+ *    escriben con su instante en ticks, para comparar con diff.
+ *  - Recepción de la UART: los bytes de un guion (sim_rx_t) entran en
+ *    una FIFO de SIM_RX_FIFO bytes (los que no caben se pierden) y cada
+ *    llegada pide la IRQ de install_uart_rx_handler(). Solo con una hart.
+ *  - sim_cpu(ticks) cobra trabajo de CPU sin llamadas al HAL (p. ej. la
+ *    consola de console.h) para que cuente en el periodo del bucle.
+ *
+ * Compilación (una variante por ejecutable, desde la raíz del repo):
+ *
+ *   gcc -O2 -Isim -fno-builtin-printf -Dmain=app_main -c \
+ *       main_final_superloop.c -o app.o
+ *   gcc -O2 -Isim -I. -Itools -DSIM_VARIANT='"main_final_superloop"' \
+ *       sim/sim_hal.c sim/sim_main.c tools/log_decode.c log.c app.o \
+ *       -o sim_final_superloop -lm -lpthread
+ *   ./sim_final_superloop [-t segundos] [-v] [-r] [-x] [-f traza]
+ *                         [-o salida] [escenario]
+ *
+ * Los módulos de la raíz que use la variante (oneshot.c, ...) se añaden a
+ * la segunda línea; las opciones -D de la variante van en la primera
+ * (p. ej. -DTIMER_TICKLESS=0 para main_final_interrupt.c).
+ * main_dual_superloop.c se ejecuta en dos harts con -DSIM_HARTS=2 en la
+ * segunda línea.
+ */
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "clinc.h"
+#include "log_decode.h"
+
+/* ------------------------------------------------------------------ */
+/* Modelo de costes (en ticks de 100 ns; núcleo supuesto a 50 MHz)      */
+/* ------------------------------------------------------------------ */
+#define SIM_COST_GPIO_READ     (2u)   /* ~10 ciclos de acceso al bus    */
+#define SIM_COST_GPIO_WRITE    (2u)
+#define SIM_COST_GET_TICKS     (2u)   /* dos lecturas de mtime/mtimeh   */
+#define SIM_COST_ISR_ENTRY     (10u)  /* guardar/restaurar contexto     */
+#define SIM_COST_PRINTF        (400u) /* parseo de formato de vfprintf  */
+#define SIM_CYCLES_PER_TICK    (5u)   /* Para el informe de ciclos.     */
+
+#define SIM_UART_BAUD          (115200u)
+#define SIM_TICKS_PER_CHAR     ((CLINT_CLOCK * 10u) / SIM_UART_BAUD)
+
+#define SIM_TICKS_PER_MS       ((uint64_t)CLINT_CLOCK / 1000u)
+
+/* Adelanto máximo de una hart sobre la otra en sim_run2 (10 us). */
+#ifndef SIM_HART_QUANTUM
+#define SIM_HART_QUANTUM       (100u)
+#endif
+
+/* Módulos que pueden anunciar plazos (FFWD_DUE). */
+#define SIM_FFWD_KEYS          (4u)
+
+/* FIFO de recepción de la UART (bytes). */
+#define SIM_RX_FIFO            (16u)
+
+/* ------------------------------------------------------------------ */
+/* Guion de entradas                                                   */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    uint64_t t;        /* Instante virtual (ticks).                     */
+    uint32_t pins;     /* Valor de las entradas a partir de t.           */
+} sim_event_t;
+
+typedef struct {
+    uint64_t t;        /* Instante de llegada (fin del bit de parada).  */
+    uint8_t  c;
+} sim_rx_t;
+
+/* ------------------------------------------------------------------ */
+/* Contexto de simulación                                              */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    /* Reloj virtual y fin de la simulación. */
+    uint64_t now;
+    uint64_t end;
+    jmp_buf  exit;
+
+    /* CLINT, GPIO y controlador de interrupciones. */
+    void   (*timer_handler)(void);
+    void   (*gpio_handler)(void);
+    uint32_t gpio_irq_mask;
+    uint8_t  gpio_pending;
+    uint64_t mtimecmp;
+    uint64_t gap;
+    uint8_t  timer_armed;
+    uint8_t  timer_irq_on;
+    uint8_t  irq_on;
+    uint8_t  in_isr;
+    uint8_t  rearmed;
+
+    /* Puerto GPIO. */
+    uint32_t dir;
+    uint32_t out;
+    uint32_t in;
+
+    /* UART: ocupada hasta este instante. */
+    uint64_t uart_busy_until;
+    log_decoder_t logdec;
+    char     text[128];             /* Línea de texto plano en curso.  */
+    uint8_t  text_len;
+
+    /* Dos harts (sim_run2): reloj de cada una y relevo. */
+    uint8_t  harts;
+    uint8_t  hart;             /* Hart en ejecución.                    */
+    uint8_t  hart_done[2];
+    uint64_t hart_now[2];
+    size_t   hart_ev[2];       /* Entradas vistas por cada hart.        */
+    uint32_t hart_in[2];
+    jmp_buf  hart_exit[2];
+    pthread_mutex_t hart_mtx;
+    pthread_cond_t  hart_cv;
+
+    /* Guion de entradas. */
+    const sim_event_t *ev;
+    size_t   n_ev;
+    size_t   ev_idx;
+
+    /* UART: recepción. */
+    void   (*uart_rx_handler)(void);
+    const sim_rx_t *rx;
+    size_t   n_rx;
+    size_t   rx_idx;           /* Próximo byte por llegar.              */
+    uint8_t  rx_fifo[SIM_RX_FIFO];
+    uint8_t  rx_head;
+    uint8_t  rx_count;
+    uint8_t  rx_pending;       /* IRQ de recepción pendiente.           */
+    uint64_t rx_lost;          /* Bytes sin sitio en la FIFO.           */
+    uint64_t rx_irqs;
+    uint64_t rx_isr_max;
+
+    /* Estadísticas. */
+    uint64_t loop_iters;       /* gpio_read() desde main (1 por vuelta). */
+    uint64_t loop_last;
+    uint64_t loop_gap_max;     /* Máximo entre dos vueltas del bucle.   */
+    uint64_t loop_gap_min;
+    uint64_t loop_gap_sum;
+    double   loop_gap_sq;      /* Suma de cuadrados (desviación).       */
+    uint64_t gpio_reads;
+    uint64_t gpio_writes;
+    uint64_t gpio_writes_same; /* gpio_write() sin cambio en el puerto.  */
+    uint64_t timer_irqs;
+    uint64_t gpio_irqs;
+    uint64_t isr_ticks;        /* Tiempo total dentro de ISR.           */
+    uint64_t wfi_ticks;        /* Tiempo total dentro de WFI.           */
+    uint64_t wfi_count;
+    uint64_t timer_isr_max;    /* Duración máxima de cada tipo de ISR.  */
+    uint64_t gpio_isr_max;
+    uint64_t lines;
+    uint64_t uart_chars;
+
+    uint64_t t_release;        /* Última liberación aún sin imprimir.   */
+    uint8_t  release_pending;
+    uint64_t lat_n;
+    uint64_t lat_sum;
+    uint64_t lat_min;
+    uint64_t lat_max;
+
+    FILE    *trace;            /* Si no es NULL: volcado de líneas.     */
+    FILE    *golden;           /* Si no es NULL: salidas con instante.  */
+
+    /* Avance rápido (ffwd.h). */
+    uint8_t  ffwd;
+    uint8_t  ff_act;           /* Efectos desde la última vuelta.       */
+    uint8_t  ff_quiet;         /* Vueltas seguidas sin efectos.         */
+    uint8_t  ff_sched;         /* Ha llegado FFWD_IDLE (planificador).  */
+    uint8_t  ff_n;
+    const void *ff_key[SIM_FFWD_KEYS];
+    uint64_t ff_due[SIM_FFWD_KEYS];  /* Plazo anunciado por cada módulo. */
+    uint64_t ff_jumps;
+    uint64_t ff_ticks;         /* Tiempo saltado.                       */
+} sim_ctx_t;
+
+/* Contexto activo (el que usan las funciones del HAL). */
+extern sim_ctx_t *sim_cur;
+
+/* Prepara ctx con el guion ev[0..n_ev) y una duración en ticks. */
+void sim_init(sim_ctx_t *ctx, const sim_event_t *ev, size_t n_ev,
+              uint64_t duration);
+
+/* Ejecuta app() hasta agotar la duración virtual. */
+void sim_run(sim_ctx_t *ctx, int (*app)(void));
+
+/* Como sim_run() con app() en dos harts (sim_hart_id() = 0 y 1). */
+void sim_run2(sim_ctx_t *ctx, int (*app)(void));
+
+/* Hart que llama (0 fuera de sim_run2). */
+uint32_t sim_hart_id(void);
+
+/* WFI simulado (ver cpu_wfi() en idle.h). */
+void sim_wfi(void);
+
+/* Avisos de avance rápido (ver ffwd.h). */
+void sim_ffwd_due(const void *key, uint64_t t);
+void sim_ffwd_idle(uint64_t t);
+
+/* Avanza el reloj virtual 'cost' ticks, atendiendo interrupciones. */
+void sim_advance(uint64_t cost);
+
+/* Trabajo de CPU de 'ticks' sin llamadas al HAL (ver arriba). */
+void sim_cpu(uint32_t ticks);
+
+/* Imprime el informe de la ejecución. */
+void sim_report(const sim_ctx_t *ctx, const char *name, FILE *out);
+
+#endif /* SIM_HAL_H */
@@ -0,0 +1,554 @@
+/*
+ * Programa del simulador: ejecuta la variante enlazada (app_main) con un
+ * escenario de entradas y muestra el informe (ver sim_hal.h).
+ * Con -DSIM_HARTS=2 la variante se ejecuta en dos harts (sim_run2).
+ *
+ * -r añade rebotes sintéticos a cada cambio del escenario: los pines que
+ * cambian alternan entre el nivel nuevo y el anterior SIM_BOUNCE_MIN a
+ * SIM_BOUNCE_MAX veces, con intervalos de 20 a 400 us que crecen hacia
+ * el final (el contacto se va asentando), hasta quedarse en el nivel
+ * nuevo antes de SIM_BOUNCE_SPAN. La serie es pseudoaleatoria con semilla
+ * fija: la misma para todas las variantes.
+ *
+ * -f traza sustituye el escenario por un fichero de texto con un cambio
+ * de entradas por línea: "<instante en us> <pines en hex>", en orden;
+ * las líneas vacías o que empiezan por '#' se ignoran (tools/tracegen.c
+ * genera trazas largas). Sin -t, la simulación dura hasta 1 s después
+ * del último cambio.
+ *
+ * -o salida escribe cada gpio_write() y cada línea de la UART con su
+ * instante en ticks (ver sim_hal.h), para comparar con un fichero de
+ * referencia (diff). -x activa el avance rápido (ffwd.h). Al final se
+ * informa de la velocidad de la reproducción en tiempo real de host.
+ *
+ * -c consola envía líneas por la recepción de la UART (console.h): una
+ * por línea del fichero, "<instante en us> <texto>"; el texto y un '\n'
+ * llegan byte a byte a SIM_UART_BAUD desde ese instante (o desde que
+ * acaba la línea anterior). Las líneas vacías o con '#' se ignoran. Para
+ * ver el efecto en el periodo del bucle, comparar el informe con y sin
+ * -c (intervalo de lectura, tiempos de respuesta del planificador):
+ *
+ *   for i in $(seq 0 99); do echo "$((500000 + i * 50000)) get"; done \
+ *       > consola.txt
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim_hal.h"
+#include "gpio_drv.h"
+
+#ifndef SIM_VARIANT
+#define SIM_VARIANT "app"
+#endif
+
+#ifndef SIM_HARTS
+#define SIM_HARTS  (1)
+#endif
+
+#define MS(x)  ((uint64_t)(x) * SIM_TICKS_PER_MS)
+#define US(x)  ((uint64_t)(x) * (CLINT_CLOCK / 1000000u))
+
+/* Rebotes por cambio (-r) y duración máxima del tren. */
+#define SIM_BOUNCE_MIN   (4u)
+#define SIM_BOUNCE_MAX   (16u)
+#define SIM_BOUNCE_SPAN  US(3000)
+
+/* main() de la variante, renombrada con -Dmain=app_main. */
+int app_main(void);
+
+/* ------------------------------------------------------------------ */
+/* Escenarios de entrada                                               */
+/* ------------------------------------------------------------------ */
+
+/* Uso típico: pulsación corta, pulsación larga (arranca el parpadeo),
+ * medida durante el parpadeo y PBT_1 para detenerlo. */
+static const sim_event_t ev_tipico[] = {
+    { MS(200),  PBT_0_MASK },
+    { MS(500),  0u },
+    { MS(1000), PBT_0_MASK },
+    { MS(2500), 0u },
+    { MS(4000), PBT_0_MASK },
+    { MS(4200), 0u },
+    { MS(5000), PBT_1_MASK },
+    { MS(5100), 0u },
+    { MS(6000), PBT_0_MASK },
+    { MS(6050), 0u },
+};
+
+/* Como 'tipico' y al final PBT_3, que pide el volcado de instr.h. */
+static const sim_event_t ev_volcado[] = {
+    { MS(200),  PBT_0_MASK },
+    { MS(500),  0u },
+    { MS(1000), PBT_0_MASK },
+    { MS(2500), 0u },
+    { MS(4000), PBT_0_MASK },
+    { MS(4200), 0u },
+    { MS(5000), PBT_1_MASK },
+    { MS(5100), 0u },
+    { MS(6000), PBT_0_MASK },
+    { MS(6050), 0u },
+    { MS(7000), PBT_3_MASK },
+    { MS(7100), 0u },
+};
+
+/* Duraciones con fracción de ms (1234567, 333, 2000001, 150000 y
+ * 999999 us), algunas durante el parpadeo; los flancos caen en instantes
+ * arbitrarios respecto al timer. */
+static const sim_event_t ev_precision[] = {
+    { US(200000),  PBT_0_MASK },
+    { US(1434567), 0u },
+    { US(1700123), PBT_0_MASK },
+    { US(1700456), 0u },
+    { US(2100007), PBT_0_MASK },
+    { US(4100008), 0u },
+    { US(4500000), PBT_1_MASK },
+    { US(4600000), 0u },
+    { US(5000050), PBT_0_MASK },
+    { US(5150050), 0u },
+    { US(5500001), PBT_0_MASK },
+    { US(6500000), 0u },
+};
+
+/* Los cuatro botones pulsados escalonados y soltados a la vez: con
+ * indicadores por LED (PWM) da tramas con cuatro duties distintos. */
+static const sim_event_t ev_cuatro[] = {
+    { MS(200),  PBT_0_MASK },
+    { MS(400),  PBT_0_MASK | PBT_1_MASK },
+    { MS(600),  PBT_0_MASK | PBT_1_MASK | PBT_2_MASK },
+    { MS(800),  PBT_0_MASK | PBT_1_MASK | PBT_2_MASK | PBT_3_MASK },
+    { MS(1100), 0u },
+};
+
+/* Ráfaga de pulsaciones cortas de PBT_0 (60 a 900 ms) y PBT_2 al
+ * final, que pide el resumen de pstats.h. */
+static const sim_event_t ev_rafaga[] = {
+    { MS(200),  PBT_0_MASK },
+    { MS(260),  0u },
+    { MS(500),  PBT_0_MASK },
+    { MS(620),  0u },
+    { MS(900),  PBT_0_MASK },
+    { MS(1080), 0u },
+    { MS(1300), PBT_0_MASK },
+    { MS(1550), 0u },
+    { MS(1800), PBT_0_MASK },
+    { MS(2100), 0u },
+    { MS(2400), PBT_0_MASK },
+    { MS(2500), 0u },
+    { MS(2800), PBT_0_MASK },
+    { MS(3200), 0u },
+    { MS(3500), PBT_0_MASK },
+    { MS(3580), 0u },
+    { MS(3800), PBT_0_MASK },
+    { MS(4700), 0u },
+    { MS(5000), PBT_0_MASK },
+    { MS(5140), 0u },
+    { MS(5400), PBT_0_MASK },
+    { MS(5610), 0u },
+    { MS(5900), PBT_0_MASK },
+    { MS(6230), 0u },
+    { MS(6600), PBT_2_MASK },
+    { MS(6700), 0u },
+};
+
+/* Sin ninguna pulsación: coste de base de cada diseño. */
+static const sim_event_t ev_reposo[] = {
+    { 0u, 0u },
+};
+
+typedef struct {
+    const char        *name;
+    const sim_event_t *ev;
+    size_t             n_ev;
+} sim_scenario_t;
+
+#define SCENARIO(n, a)  { n, a, sizeof(a) / sizeof((a)[0]) }
+
+static const sim_scenario_t scenarios[] = {
+    SCENARIO("tipico", ev_tipico),
+    SCENARIO("reposo", ev_reposo),
+    SCENARIO("volcado", ev_volcado),
+    SCENARIO("precision", ev_precision),
+    SCENARIO("cuatro", ev_cuatro),
+    SCENARIO("rafaga", ev_rafaga),
+};
+
+#define N_SCENARIOS  (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/* ------------------------------------------------------------------ */
+/* Rebotes sintéticos                                                  */
+/* ------------------------------------------------------------------ */
+
+static uint32_t bounce_rng = 0x2545F491u;
+
+static uint32_t xorshift32(void)
+{
+    bounce_rng ^= bounce_rng << 13;
+    bounce_rng ^= bounce_rng >> 17;
+    bounce_rng ^= bounce_rng << 5;
+    return bounce_rng;
+}
+
+/* Copia de ev[0..n) con un tren de rebotes delante de cada cambio; el
+ * tren no pasa del siguiente evento. Devuelve el número de eventos. */
+static size_t bounce_expand(const sim_event_t *ev, size_t n,
+                            sim_event_t **out)
+{
+    sim_event_t *o = malloc((n * (2u * SIM_BOUNCE_MAX + 1u)) * sizeof *o);
+    uint32_t prev = 0u;
+    size_t i, k = 0u;
+
+    if (o == NULL) {
+        *out = NULL;
+        return 0u;
+    }
+    for (i = 0u; i < n; i++) {
+        uint32_t chg = ev[i].pins ^ prev;
+        uint64_t limit = (i + 1u < n) ? ev[i + 1u].t : ~(uint64_t)0;
+        uint64_t t = ev[i].t;
+
+        if ((chg != 0u) && (limit - t > SIM_BOUNCE_SPAN)) {
+            uint32_t m = SIM_BOUNCE_MIN +
+                         xorshift32() % (SIM_BOUNCE_MAX - SIM_BOUNCE_MIN + 1u);
+            uint32_t j;
+
+            /* Nivel nuevo / anterior, m veces; el intervalo j-ésimo
+             * crece de 20 us a unos 400 us. */
+            for (j = 0u; j < m; j++) {
+                uint64_t span = US(20u + (380u * (j + 1u)) / m);
+
+                o[k].t = t;
+                o[k++].pins = ev[i].pins;
+                t += US(5) + xorshift32() % span;
+                o[k].t = t;
+                o[k++].pins = prev;
+                t += US(5) + xorshift32() % span;
+                if (t - ev[i].t >= SIM_BOUNCE_SPAN) {
+                    break;
+                }
+            }
+        }
+        o[k].t = t;
+        o[k++].pins = ev[i].pins;
+        prev = ev[i].pins;
+    }
+    *out = o;
+    return k;
+}
+
+/* ------------------------------------------------------------------ */
+/* Trazas de entrada                                                   */
+/* ------------------------------------------------------------------ */
+
+/* Lee una traza (ver arriba); devuelve el número de eventos o 0. */
+static size_t trace_load(const char *path, sim_event_t **out)
+{
+    FILE *f = fopen(path, "r");
+    sim_event_t *ev = NULL;
+    size_t n = 0u, cap = 0u;
+    unsigned line_no = 0u;
+    char line[128];
+
+    *out = NULL;
+    if (f == NULL) {
+        perror(path);
+        return 0u;
+    }
+    while (fgets(line, sizeof line, f) != NULL) {
+        unsigned long long us;
+        unsigned long pins;
+        char *p = line;
+
+        line_no++;
+        while ((*p == ' ') || (*p == '\t')) {
+            p++;
+        }
+        if ((*p == '#') || (*p == '\n') || (*p == '\0')) {
+            continue;
+        }
+        if (sscanf(p, "%llu %lx", &us, &pins) != 2) {
+            fprintf(stderr, "%s:%u: línea no válida\n", path, line_no);
+            break;
+        }
+        if ((n != 0u) && (US(us) < ev[n - 1u].t)) {
+            fprintf(stderr, "%s:%u: instante fuera de orden\n", path,
+                    line_no);
+            break;
+        }
+        if (n == cap) {
+            sim_event_t *grown;
+
+            cap = (cap != 0u) ? (2u * cap) : 1024u;
+            grown = realloc(ev, cap * sizeof *ev);
+            if (grown == NULL) {
+                break;
+            }
+            ev = grown;
+        }
+        ev[n].t = US(us);
+        ev[n].pins = (uint32_t)pins;
+        n++;
+    }
+    if (!feof(f) || (n == 0u)) {
+        fclose(f);
+        free(ev);
+        return 0u;
+    }
+    fclose(f);
+    *out = ev;
+    return n;
+}
+
+/* Lee las líneas de consola (ver arriba) como bytes con su instante de
+ * llegada; devuelve el número de bytes o 0. */
+static size_t console_load(const char *path, sim_rx_t **out)
+{
+    FILE *f = fopen(path, "r");
+    sim_rx_t *rx = NULL;
+    size_t n = 0u, cap = 0u;
+    uint64_t t_free = 0u;
+    unsigned line_no = 0u;
+    char line[128];
+
+    *out = NULL;
+    if (f == NULL) {
+        perror(path);
+        return 0u;
+    }
+    while (fgets(line, sizeof line, f) != NULL) {
+        unsigned long long us;
+        uint64_t t;
+        char *p = line;
+        int skip = 0;
+
+        line_no++;
+        while ((*p == ' ') || (*p == '\t')) {
+            p++;
+        }
+        if ((*p == '#') || (*p == '\n') || (*p == '\0')) {
+            continue;
+        }
+        if (sscanf(p, "%llu %n", &us, &skip) != 1) {
+            fprintf(stderr, "%s:%u: línea no válida\n", path, line_no);
+            break;
+        }
+        p += skip;
+
+        /* Un carácter tras otro, sin solaparse con la línea anterior. */
+        t = (US(us) > t_free) ? US(us) : t_free;
+        for (;; p++) {
+            uint8_t c = (*p == '\0') ? (uint8_t)'\n' : (uint8_t)*p;
+
+            if (n == cap) {
+                sim_rx_t *grown;
+
+                cap = (cap != 0u) ? (2u * cap) : 1024u;
+                grown = realloc(rx, cap * sizeof *rx);
+                if (grown == NULL) {
+                    fclose(f);
+                    free(rx);
+                    return 0u;
+                }
+                rx = grown;
+            }
+            t += SIM_TICKS_PER_CHAR;
+            rx[n].t = t;
+            rx[n].c = c;
+            n++;
+            if (c == '\n') {
+                break;
+            }
+        }
+        t_free = t;
+    }
+    if (!feof(f) || (n == 0u)) {
+        fclose(f);
+        free(rx);
+        return 0u;
+    }
+    fclose(f);
+    *out = rx;
+    return n;
+}
+
+static double wall_secs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Flancos de subida de cualquier botón en ev[0..n). */
+static uint32_t count_presses(const sim_event_t *ev, size_t n)
+{
+    uint32_t prev = 0u, presses = 0u;
+    size_t i;
+
+    for (i = 0u; i < n; i++) {
+        presses += (uint32_t)__builtin_popcount(ev[i].pins & ~prev);
+        prev = ev[i].pins;
+    }
+    return presses;
+}
+
+static void usage(const char *argv0)
+{
+    size_t i;
+
+    fprintf(stderr, "uso: %s [-t segundos] [-v] [-r] [-x] [-f traza] "
+            "[-o salida] [-c consola] [escenario]\n", argv0);
+    fprintf(stderr, "escenarios:");
+    for (i = 0; i < N_SCENARIOS; i++) {
+        fprintf(stderr, " %s", scenarios[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+    static sim_ctx_t ctx;
+    const sim_scenario_t *sc = &scenarios[0];
+    sim_scenario_t file_sc;
+    const sim_event_t *ev;
+    sim_event_t *bounced = NULL;
+    sim_event_t *loaded = NULL;
+    const char *trace_path = NULL;
+    const char *golden_path = NULL;
+    const char *console_path = NULL;
+    sim_rx_t *rx = NULL;
+    size_t n_rx = 0u;
+    FILE *golden = NULL;
+    size_t n_ev;
+    double secs = 0.0;
+    double wall;
+    int verbose = 0;
+    int bounce = 0;
+    int ffwd = 0;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+            secs = atof(argv[++i]);
+            if (secs <= 0.0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "-r") == 0) {
+            bounce = 1;
+        } else if (strcmp(argv[i], "-x") == 0) {
+            ffwd = 1;
+        } else if ((strcmp(argv[i], "-f") == 0) && (i + 1 < argc)) {
+            trace_path = argv[++i];
+        } else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) {
+            golden_path = argv[++i];
+        } else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) {
+            console_path = argv[++i];
+        } else {
+            size_t k;
+
+            sc = NULL;
+            for (k = 0; k < N_SCENARIOS; k++) {
+                if (strcmp(argv[i], scenarios[k].name) == 0) {
+                    sc = &scenarios[k];
+                }
+            }
+            if (sc == NULL) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if (trace_path != NULL) {
+        file_sc.name = trace_path;
+        file_sc.n_ev = trace_load(trace_path, &loaded);
+        file_sc.ev = loaded;
+        if (loaded == NULL) {
+            return 1;
+        }
+        sc = &file_sc;
+        if (secs == 0.0) {
+            secs = (double)loaded[file_sc.n_ev - 1u].t / CLINT_CLOCK + 1.0;
+        }
+    }
+    if (console_path != NULL) {
+        n_rx = console_load(console_path, &rx);
+        if (rx == NULL) {
+            free(loaded);
+            return 1;
+        }
+    }
+    if (secs == 0.0) {
+        secs = 10.0;
+    }
+
+    ev = sc->ev;
+    n_ev = sc->n_ev;
+    if (bounce) {
+        n_ev = bounce_expand(sc->ev, sc->n_ev, &bounced);
+        if (bounced == NULL) {
+            free(loaded);
+            free(rx);
+            return 1;
+        }
+        ev = bounced;
+    }
+
+    if (golden_path != NULL) {
+        golden = fopen(golden_path, "w");
+        if (golden == NULL) {
+            perror(golden_path);
+            free(bounced);
+            free(loaded);
+            free(rx);
+            return 1;
+        }
+    }
+
+    sim_init(&ctx, ev, n_ev, (uint64_t)(secs * CLINT_CLOCK));
+    ctx.trace = verbose ? stdout : NULL;
+    ctx.golden = golden;
+    ctx.ffwd = (uint8_t)ffwd;
+    ctx.rx = rx;
+    ctx.n_rx = n_rx;
+    wall = wall_secs();
+#if SIM_HARTS == 2
+    sim_run2(&ctx, app_main);
+#else
+    sim_run(&ctx, app_main);
+#endif
+    wall = wall_secs() - wall;
+
+    fprintf(stdout, "escenario '%s'%s\n", sc->name,
+            bounce ? " con rebotes" : "");
+    sim_report(&ctx, SIM_VARIANT, stdout);
+    if (ctx.gpio_irqs != 0u) {
+        uint32_t presses = count_presses(sc->ev, sc->n_ev);
+
+        fprintf(stdout, "  IRQ por pulsación  : GPIO %.1f, timer %.1f "
+                "(%u pulsaciones, %zu cambios de entrada)\n",
+                (presses != 0u) ? (double)ctx.gpio_irqs / presses : 0.0,
+                (presses != 0u) ? (double)ctx.timer_irqs / presses : 0.0,
+                (unsigned)presses, n_ev);
+    }
+
+    /* Depende del host: solo al reproducir trazas o con -x, para que la
+     * salida de siempre siga siendo determinista. */
+    if ((trace_path != NULL) || ffwd) {
+        fprintf(stdout, "  reproducción       : %zu cambios en %.3f s de "
+                "host (%.0f cambios/s, x%.0f tiempo real)\n",
+                ctx.ev_idx, wall, (double)ctx.ev_idx / wall,
+                (double)ctx.now / CLINT_CLOCK / wall);
+    }
+    if (golden != NULL) {
+        fclose(golden);
+    }
+    free(loaded);
+    free(bounced);
+    free(rx);
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Lectura sin desgarro de valores de 64 bits en RV32, sin deshabilitar
+ * interrupciones.
+ *
+ * En RV32 leer un uint64_t son dos cargas de 32 bits; si entre ambas
+ * entra una ISR que modifica el valor, se combina la mitad vieja de una
+ * palabra con la nueva de la otra (p. ej. counter_ms al pasar de
+ * 0x1_0000_0000 a 0x0_FFFF_FFFF da 0x1_FFFF_FFFF o 0).
+ *
+ * snap64_read(): lectura alta-baja-alta. Si la palabra alta no cambia
+ * entre las dos lecturas, la baja corresponde a ella; si cambia, se
+ * repite. Vale para:
+ *  - mtime/mtimeh (contador hardware);
+ *  - variables de 64 bits que actualiza una ISR que no puede ser
+ *    interrumpida por quien lee (p. ej. counter_ms desde main).
+ * No requiere nada del escritor.
+ *
+ * seq64_t: contador de secuencia (seqlock) para cuando el escritor sí
+ * puede ser interrumpido por el lector o está en otro hart. El escritor
+ * deja 'seq' impar mientras escribe; el lector repite si lo ve impar o si
+ * cambió. El lector no debe interrumpir al escritor en el mismo hart (se
+ * quedaría esperando): escribir desde la ISR y leer desde main, o entre
+ * ISR que no se anidan.
+ *
+ * SNAP64_HOOK() se ejecuta entre las cargas de 32 bits; por defecto no
+ * hace nada (tools/snap64_stress.c lo usa para disparar el timer justo
+ * entre las dos mitades en el simulador).
+ */
+#ifndef SNAP64_H
+#define SNAP64_H
+
+#include "riscv_types.h"
+
+#ifndef SNAP64_HOOK
+#define SNAP64_HOOK()  ((void)0)
+#endif
+
+#if defined(__riscv)
+#define SNAP64_FENCE_W()  __asm__ volatile ("fence w,w" ::: "memory")
+#define SNAP64_FENCE_R()  __asm__ volatile ("fence r,r" ::: "memory")
+#else
+#define SNAP64_FENCE_W()  __atomic_thread_fence(__ATOMIC_RELEASE)
+#define SNAP64_FENCE_R()  __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#endif
+
+/* Mitades de un uint64_t en memoria (little-endian). */
+typedef uint32_t __attribute__((may_alias)) snap64_word_t;
+
+#define SNAP64_LO(p)  (((const volatile snap64_word_t *)(p))[0])
+#define SNAP64_HI(p)  (((const volatile snap64_word_t *)(p))[1])
+
+/* ------------------------------------------------------------------ */
+/* Alta-baja-alta                                                      */
+/* ------------------------------------------------------------------ */
+static inline uint64_t snap64_read(const volatile uint64_t *p)
+{
+#if defined(__riscv) && (__riscv_xlen == 64)
+    return *p;
+#else
+    uint32_t hi, lo, hi2;
+
+    hi = SNAP64_HI(p);
+    SNAP64_HOOK();
+    for (;;) {
+        lo = SNAP64_LO(p);
+        SNAP64_HOOK();
+        hi2 = SNAP64_HI(p);
+        if (hi2 == hi) {
+            return ((uint64_t)hi << 32) | lo;
+        }
+        hi = hi2;
+        SNAP64_HOOK();
+    }
+#endif
+}
+
+/* ------------------------------------------------------------------ */
+/* Contador de secuencia                                               */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    volatile uint32_t seq;        /* Impar: escritura en curso.          */
+    volatile uint64_t val;
+} seq64_t;
+
+static inline void seq64_write(seq64_t *s, uint64_t v)
+{
+    s->seq = s->seq + 1u;
+    SNAP64_FENCE_W();
+    s->val = v;
+    SNAP64_FENCE_W();
+    s->seq = s->seq + 1u;
+}
+
+static inline uint64_t seq64_read(const seq64_t *s)
+{
+    uint32_t s0, lo, hi;
+
+    do {
+        s0 = s->seq;
+        SNAP64_FENCE_R();
+        lo = SNAP64_LO(&s->val);
+        SNAP64_HOOK();
+        hi = SNAP64_HI(&s->val);
+        SNAP64_FENCE_R();
+    } while ((s0 & 1u) || (s0 != s->seq));
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+#endif /* SNAP64_H */
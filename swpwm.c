@@ -0,0 +1,266 @@
+#include "riscv_types.h"
+#include "gpio_drv.h"
+
+#include "clinc.h"
+#include "riscv_monotonic_clock.h"
+
+#include "gpio_out.h"
+#include "oneshot.h"
+#include "swpwm.h"
+
+/* Nivel percibido -> duty: round(255 * (n / 255)^2.2). */
+static const uint8_t swpwm_gamma[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+      3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,
+     11,  11,  11,  12,  12,  13,  13,  13,  14,  14,  15,  15,
+     16,  16,  17,  17,  18,  18,  19,  19,  20,  20,  21,  22,
+     22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,
+     39,  39,  40,  41,  42,  43,  43,  44,  45,  46,  47,  48,
+     49,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,
+     60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,
+     87,  88,  89,  90,  91,  93,  94,  95,  97,  98,  99, 100,
+    102, 103, 105, 106, 107, 109, 110, 111, 113, 114, 116, 117,
+    119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154,
+    156, 158, 159, 161, 163, 165, 166, 168, 170, 172, 173, 175,
+    177, 179, 181, 182, 184, 186, 188, 190, 192, 194, 196, 197,
+    199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246,
+    248, 251, 253, 255
+};
+
+/* Punto de cambio: desplazamiento en la trama y valor de los canales. */
+typedef struct {
+    uint32_t at;
+    uint32_t out;
+} swpwm_point_t;
+
+typedef struct {
+    uint32_t mask[SWPWM_CHANNELS];
+    uint32_t all;                 /* Bits de todos los canales.          */
+    uint32_t step;                /* Ticks por unidad de duty.           */
+    uint32_t period;
+
+    uint8_t  duty[SWPWM_CHANNELS];
+    uint16_t level_fx[SWPWM_CHANNELS];  /* Nivel en 8.8.                 */
+    int32_t  fade_step[SWPWM_CHANNELS]; /* Incremento por trama (8.8).   */
+    uint16_t fade_left[SWPWM_CHANNELS]; /* Tramas que quedan de rampa.   */
+    uint8_t  fade_to[SWPWM_CHANNELS];
+    uint8_t  fading;              /* Bit c: rampa en curso en el canal c. */
+
+    swpwm_point_t pt[SWPWM_CHANNELS + 1u];
+    uint8_t  n_pt;
+    uint8_t  idx;                 /* Siguiente punto a escribir.         */
+    uint8_t  dirty;               /* Hay que reconstruir la lista.       */
+    uint8_t  running;             /* Timer armado.                       */
+    uint64_t frame_start;
+
+    uint32_t irqs;
+    uint32_t writes;
+} swpwm_t;
+
+static swpwm_t pwm;
+
+/* Lista ordenada de puntos de la trama a partir de los duties. */
+static void swpwm_build(void)
+{
+    uint32_t out = 0u;
+    uint8_t n = 1u;
+    uint8_t c, i, j;
+
+    /* Inicio de trama: encender todo canal con duty > 0. */
+    for (c = 0u; c < SWPWM_CHANNELS; c++) {
+        if (pwm.duty[c] != 0u) {
+            out |= pwm.mask[c];
+        }
+    }
+    pwm.pt[0].at = 0u;
+    pwm.pt[0].out = out;
+
+    /* Apagados: inserción ordenada (como mucho 4); aquí 'out' guarda de
+     * momento la máscara de los canales que se apagan en ese punto. */
+    for (c = 0u; c < SWPWM_CHANNELS; c++) {
+        uint8_t d = pwm.duty[c];
+        uint32_t at = pwm.step * d;
+
+        if ((d == 0u) || (d == 255u)) {
+            continue;
+        }
+        for (i = 1u; (i < n) && (pwm.pt[i].at < at); i++) {
+        }
+        if ((i < n) && (pwm.pt[i].at == at)) {
+            pwm.pt[i].out |= pwm.mask[c];
+            continue;
+        }
+        for (j = n; j > i; j--) {
+            pwm.pt[j] = pwm.pt[j - 1u];
+        }
+        pwm.pt[i].at = at;
+        pwm.pt[i].out = pwm.mask[c];
+        n++;
+    }
+
+    /* Máscaras de apagado -> valor del puerto tras cada punto. */
+    for (i = 1u; i < n; i++) {
+        out &= ~pwm.pt[i].out;
+        pwm.pt[i].out = out;
+    }
+
+    pwm.n_pt = n;
+    pwm.dirty = 0u;
+}
+
+/* Avanza un paso las rampas en curso. */
+static void swpwm_fade_step(void)
+{
+    uint8_t c;
+
+    for (c = 0u; c < SWPWM_CHANNELS; c++) {
+        uint8_t duty;
+
+        if (!(pwm.fading & (1u << c))) {
+            continue;
+        }
+        if (--pwm.fade_left[c] == 0u) {
+            pwm.level_fx[c] = (uint16_t)(pwm.fade_to[c] << 8);
+            pwm.fading &= (uint8_t)~(1u << c);
+        } else {
+            pwm.level_fx[c] =
+                (uint16_t)((int32_t)pwm.level_fx[c] + pwm.fade_step[c]);
+        }
+        duty = swpwm_gamma[pwm.level_fx[c] >> 8];
+        if (duty != pwm.duty[c]) {
+            pwm.duty[c] = duty;
+            pwm.dirty = 1u;
+        }
+    }
+}
+
+void swpwm_isr(void)
+{
+    pwm.irqs++;
+
+    /* Solo los bits de los canales; como mucho una escritura por punto. */
+    gpio_out_assign(pwm.all, pwm.pt[pwm.idx].out);
+    gpio_out_flush();
+    pwm.writes++;
+    pwm.idx++;
+
+    if (pwm.idx == pwm.n_pt) {
+        /* Fin de la lista: preparar la trama siguiente. */
+        pwm.frame_start += pwm.period;
+        pwm.idx = 0u;
+        if (pwm.fading != 0u) {
+            swpwm_fade_step();
+        }
+        if (pwm.dirty) {
+            swpwm_build();
+        } else if ((pwm.n_pt == 1u) && (pwm.fading == 0u)) {
+            /* Salida fija y sin rampas: nada que hacer hasta otra orden. */
+            pwm.running = 0u;
+            oneshot_disarm();
+            return;
+        }
+    }
+
+    oneshot_arm_at(pwm.frame_start + pwm.pt[pwm.idx].at);
+}
+
+/* Tras cambiar el estado (con la IRQ del timer parada): si el motor
+ * estaba parado, arranca una trama nueva ya; si no, sigue. */
+static void swpwm_kick(void)
+{
+    if (!pwm.running) {
+        pwm.running = 1u;
+        pwm.frame_start = get_ticks_from_reset();
+        pwm.idx = 0u;
+        swpwm_build();
+        oneshot_arm_at(pwm.frame_start);
+    } else {
+        enable_timer_clinc_irq();
+    }
+}
+
+void swpwm_init(uint32_t period, const uint32_t mask[SWPWM_CHANNELS])
+{
+    uint8_t c;
+
+    oneshot_disarm();
+    pwm.all = 0u;
+    pwm.period = period;
+    pwm.step = period >> 8;
+    for (c = 0u; c < SWPWM_CHANNELS; c++) {
+        pwm.mask[c] = mask[c];
+        pwm.all |= mask[c];
+        pwm.duty[c] = 0u;
+        pwm.level_fx[c] = 0u;
+        pwm.fade_left[c] = 0u;
+    }
+    pwm.fading = 0u;
+    pwm.running = 0u;
+    pwm.irqs = 0u;
+    pwm.writes = 0u;
+
+    /* Una trama para dejar el puerto apagado; luego se desarma. */
+    disable_timer_clinc_irq();
+    swpwm_kick();
+}
+
+void swpwm_set_duty(uint8_t ch, uint8_t duty)
+{
+    disable_timer_clinc_irq();
+    pwm.fading &= (uint8_t)~(1u << ch);
+    if (pwm.duty[ch] != duty) {
+        pwm.duty[ch] = duty;
+        pwm.dirty = 1u;
+    }
+    swpwm_kick();
+}
+
+void swpwm_set_level(uint8_t ch, uint8_t level)
+{
+    disable_timer_clinc_irq();
+    pwm.level_fx[ch] = (uint16_t)(level << 8);
+    pwm.fading &= (uint8_t)~(1u << ch);
+    if (pwm.duty[ch] != swpwm_gamma[level]) {
+        pwm.duty[ch] = swpwm_gamma[level];
+        pwm.dirty = 1u;
+    }
+    swpwm_kick();
+}
+
+void swpwm_fade(uint8_t ch, uint8_t level, uint16_t frames)
+{
+    if (frames == 0u) {
+        swpwm_set_level(ch, level);
+        return;
+    }
+
+    disable_timer_clinc_irq();
+    pwm.fade_to[ch] = level;
+    pwm.fade_left[ch] = frames;
+    pwm.fade_step[ch] =
+        (((int32_t)level << 8) - (int32_t)pwm.level_fx[ch]) / frames;
+    pwm.fading |= (uint8_t)(1u << ch);
+    swpwm_kick();
+}
+
+uint8_t swpwm_level(uint8_t ch)
+{
+    return (uint8_t)(pwm.level_fx[ch] >> 8);
+}
+
+uint32_t swpwm_irqs(void)
+{
+    return pwm.irqs;
+}
+
+uint32_t swpwm_writes(void)
+{
+    return pwm.writes;
+}
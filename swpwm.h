@@ -0,0 +1,61 @@
+/*
+ * PWM por software para los LEDs, con el timer del CLINT en one-shot.
+ *
+ * En cada trama de PWM (periodo fijo) cada canal se enciende al inicio y
+ * se apaga en el punto duty/256 de la trama. Al empezar la trama se
+ * construye la lista ordenada de puntos de cambio (instante, valor del
+ * puerto) fusionando los canales con el mismo duty; la ISR escribe el
+ * puerto una vez en cada punto y programa el siguiente. Con N duties
+ * distintos hay como mucho N + 1 IRQ por trama, no una por tick.
+ *
+ * duty 0 = apagado y 255 = encendido fijo (sin punto de apagado). Si en
+ * una trama no hay ningún cambio y no hay rampas en curso, el timer se
+ * desarma hasta la siguiente llamada a swpwm_set_*()/swpwm_fade().
+ *
+ * Niveles y rampas: swpwm_set_level() y swpwm_fade() usan un nivel de
+ * brillo percibido (0..255) que se convierte en duty con una tabla de
+ * corrección gamma 2,2. La rampa avanza un paso por trama.
+ *
+ * Puerto: en cada punto la ISR cambia solo los bits de los canales en la
+ * sombra de gpio_out.h (gpio_out_assign) y la vuelca (gpio_out_flush), así
+ * que el resto de salidas conserva lo que les haya puesto cualquier otro
+ * contexto a través de gpio_out.h. gpio_out_init() debe haberse llamado
+ * antes de swpwm_init(); escribir el puerto sin pasar por la sombra
+ * seguiría perdiéndose en el siguiente punto.
+ *
+ * swpwm_isr() se instala con install_local_timer_handler() y es la única
+ * usuaria del timer. Las funciones swpwm_set_*() y swpwm_fade() se
+ * llaman desde main: paran la IRQ del timer mientras cambian el estado.
+ */
+#ifndef SWPWM_H
+#define SWPWM_H
+
+#include "riscv_types.h"
+
+#define SWPWM_CHANNELS  (4u)
+
+/* Prepara el motor con 'period' ticks por trama; mask[c] es el bit del
+ * canal c. Todo apagado. */
+void swpwm_init(uint32_t period, const uint32_t mask[SWPWM_CHANNELS]);
+
+/* Duty lineal (fracción de la trama) en 1/256. */
+void swpwm_set_duty(uint8_t ch, uint8_t duty);
+
+/* Nivel de brillo percibido (con gamma). */
+void swpwm_set_level(uint8_t ch, uint8_t level);
+
+/* Rampa desde el nivel actual hasta 'level' en 'frames' tramas. */
+void swpwm_fade(uint8_t ch, uint8_t level, uint16_t frames);
+
+/* Nivel actual de un canal. */
+uint8_t swpwm_level(uint8_t ch);
+
+/* Manejador del timer. */
+void swpwm_isr(void);
+
+/* Estadísticas: IRQ atendidas y puntos aplicados (como mucho una
+ * escritura del puerto cada uno). */
+uint32_t swpwm_irqs(void);
+uint32_t swpwm_writes(void);
+
+#endif /* SWPWM_H */
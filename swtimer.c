@@ -0,0 +1,116 @@
+#include "riscv_types.h"
+
+#include "swtimer.h"
+
+#define SWTIMER_MASK  (SWTIMER_SLOTS - 1u)
+
+static void swtimer_link(swtimer_t **head, swtimer_t *t)
+{
+    t->next = *head;
+    if (t->next != NULL) {
+        t->next->pprev = &t->next;
+    }
+    t->pprev = head;
+    *head = t;
+}
+
+static void swtimer_unlink(swtimer_t *t)
+{
+    *t->pprev = t->next;
+    if (t->next != NULL) {
+        t->next->pprev = t->pprev;
+    }
+    t->pprev = NULL;
+}
+
+void swtimer_wheel_init(swtimer_wheel_t *w, uint32_t now)
+{
+    uint32_t i;
+
+    for (i = 0u; i < SWTIMER_SLOTS; i++) {
+        w->slot[i] = NULL;
+    }
+    w->work = NULL;
+    w->now = now;
+    w->active = 0u;
+}
+
+void swtimer_init(swtimer_t *t, void (*fn)(void *arg), void *arg)
+{
+    t->next = NULL;
+    t->pprev = NULL;
+    t->expires = 0u;
+    t->period = 0u;
+    t->fn = fn;
+    t->arg = arg;
+}
+
+void swtimer_start(swtimer_wheel_t *w, swtimer_t *t,
+                   uint32_t delay, uint32_t period)
+{
+    if (t->pprev != NULL) {
+        swtimer_unlink(t);
+    } else {
+        w->active++;
+    }
+    if (delay == 0u) {
+        delay = 1u;
+    }
+    t->expires = w->now + delay;
+    t->period = period;
+    swtimer_link(&w->slot[t->expires & SWTIMER_MASK], t);
+}
+
+void swtimer_stop(swtimer_wheel_t *w, swtimer_t *t)
+{
+    if (t->pprev != NULL) {
+        swtimer_unlink(t);
+        w->active--;
+    }
+}
+
+void swtimer_tick(swtimer_wheel_t *w)
+{
+    swtimer_t **slot;
+    swtimer_t *t;
+
+    w->now++;
+    slot = &w->slot[w->now & SWTIMER_MASK];
+    if (*slot == NULL) {
+        return;
+    }
+
+    /* La ranura pasa a la lista de trabajo; lo que no vence en este
+     * paso vuelve a ella. Un callback puede parar cualquier nodo de la
+     * lista de trabajo: se consume siempre por la cabeza. */
+    w->work = *slot;
+    w->work->pprev = &w->work;
+    *slot = NULL;
+
+    while ((t = w->work) != NULL) {
+        swtimer_unlink(t);
+        if (t->expires != w->now) {
+            swtimer_link(slot, t);
+            continue;
+        }
+
+        if (t->period != 0u) {
+            t->expires = w->now + t->period;
+            swtimer_link(&w->slot[t->expires & SWTIMER_MASK], t);
+        } else {
+            w->active--;
+        }
+        t->fn(t->arg);
+    }
+}
+
+void swtimer_advance_to(swtimer_wheel_t *w, uint32_t now)
+{
+    while ((int32_t)(now - w->now) > 0) {
+        if (w->active == 0u) {
+            w->now = now;
+            return;
+        }
+        swtimer_tick(w);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * Temporizadores software sobre una rueda de tiempos con hash.
+ *
+ * El tiempo se cuenta en "pasos" (p. ej. 1 ms). Cada temporizador vive
+ * en la ranura expires % SWTIMER_SLOTS de una lista doble intrusiva:
+ *  - swtimer_start() y swtimer_stop() son O(1);
+ *  - swtimer_tick() solo recorre la ranura del paso actual, así que con
+ *    los temporizadores repartidos entre ranuras el coste por paso no
+ *    depende de cuántos haya. Los que caen en la ranura pero vencen en
+ *    otra vuelta de la rueda se dejan donde están.
+ *
+ * Se puede mover desde la ISR de un timer periódico (swtimer_tick() en
+ * cada IRQ) o desde el bucle principal (swtimer_advance_to() con el paso
+ * actual; los pasos sin temporizadores activos se saltan de golpe).
+ *
+ * Los callbacks se ejecutan en el contexto que mueve la rueda y pueden
+ * arrancar o parar cualquier temporizador, incluido el propio. Las
+ * llamadas desde otro contexto deben hacerse con la IRQ que mueve la
+ * rueda deshabilitada (p. ej. disable_timer_clinc_irq()).
+ *
+ * Medida frente al recorrido lineal: tools/swtimer_bench.c.
+ */
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include "riscv_types.h"
+
+/* Número de ranuras: potencia de 2. Conviene que cubra los plazos
+ * habituales (256 pasos de 1 ms = 256 ms). */
+#ifndef SWTIMER_SLOTS
+#define SWTIMER_SLOTS  (256u)
+#endif
+
+#if (SWTIMER_SLOTS & (SWTIMER_SLOTS - 1u)) != 0
+#error "SWTIMER_SLOTS debe ser potencia de 2"
+#endif
+
+typedef struct swtimer swtimer_t;
+
+struct swtimer {
+    swtimer_t  *next;
+    swtimer_t **pprev;          /* NULL: parado.                         */
+    uint32_t    expires;        /* Paso en que vence.                    */
+    uint32_t    period;         /* 0: una vez; si no, pasos entre vencim. */
+    void      (*fn)(void *arg);
+    void       *arg;
+};
+
+typedef struct {
+    swtimer_t *slot[SWTIMER_SLOTS];
+    swtimer_t *work;            /* Ranura en proceso (swtimer_tick).     */
+    uint32_t   now;             /* Paso actual.                          */
+    uint32_t   active;          /* Temporizadores arrancados.            */
+} swtimer_wheel_t;
+
+void swtimer_wheel_init(swtimer_wheel_t *w, uint32_t now);
+
+void swtimer_init(swtimer_t *t, void (*fn)(void *arg), void *arg);
+
+/* Vence dentro de 'delay' pasos (mínimo 1) y después cada 'period'
+ * pasos si period != 0. Si ya estaba arrancado, se reprograma. */
+void swtimer_start(swtimer_wheel_t *w, swtimer_t *t,
+                   uint32_t delay, uint32_t period);
+
+void swtimer_stop(swtimer_wheel_t *w, swtimer_t *t);
+
+static inline int swtimer_active(const swtimer_t *t)
+{
+    return t->pprev != NULL;
+}
+
+/* Avanza un paso y ejecuta lo que vence en él. */
+void swtimer_tick(swtimer_wheel_t *w);
+
+/* Avanza hasta el paso 'now' (sin retroceder). */
+void swtimer_advance_to(swtimer_wheel_t *w, uint32_t now);
+
+#endif /* SWTIMER_H */
@@ -0,0 +1,135 @@
+/*
+ * Conversión entre ticks del CLINT y ms/us sin división de 64 bits.
+ *
+ * En RV32, 'x / TICKS_PER_MS' con x de 64 bits es una llamada a
+ * __udivdi3 (cientos de ciclos). Aquí cada división por una constante se
+ * sustituye por una multiplicación "alta" (64x64 -> 64 bits superiores)
+ * por un recíproco precalculado, con el método de Granlund y Montgomery
+ * ("Division by invariant integers using multiplication", 1994, fig. 4.1):
+ *
+ *   l   = ceil(log2(d))
+ *   m'  = floor(2^64 * (2^l - d) / d) + 1
+ *   t   = mulhi(m', x)
+ *   q   = (t + ((x - t) >> min(l, 1))) >> max(l - 1, 0)
+ *
+ * que da q = floor(x / d) exacto para todo x de 64 bits y todo divisor
+ * 1 <= d < 2^32. El recíproco se calcula en tiempo de compilación con
+ * aritmética de 64 bits (válido también en RV32).
+ *
+ * La razón CLINT_CLOCK : 1000 (o 10^6) se reduce por su máximo común
+ * divisor, así que sirve cualquier CLINT_CLOCK < 2^32: con 10 MHz
+ * ticks_to_ms() es una sola división por 10000; con 32768 Hz es
+ * x * 125 / 4096. El resultado es exacto (truncado) siempre que quepa en
+ * 64 bits.
+ *
+ * Comprobación de equivalencia y medida frente a la división:
+ * tools/tc_check.c.
+ */
+#ifndef TIME_CONV_H
+#define TIME_CONV_H
+
+#include "riscv_types.h"
+#include "clinc.h"
+
+/* ------------------------------------------------------------------ */
+/* Constantes de reducción (en tiempo de compilación)                  */
+/* ------------------------------------------------------------------ */
+
+/* Mayor potencia de 2 que divide a f, limitada a 2^k. */
+#define TC_P2(f, k) \
+    (1ull << ((__builtin_ctzll(f) < (k)) ? __builtin_ctzll(f) : (k)))
+
+/* Mayor potencia de 5 que divide a f, limitada a 5^k (k <= 6). */
+#define TC_P5(f, k)                                        \
+    ((((k) >= 6) && (((f) % 15625u) == 0u)) ? 15625ull :   \
+     (((k) >= 5) && (((f) % 3125u) == 0u))  ? 3125ull  :   \
+     (((k) >= 4) && (((f) % 625u) == 0u))   ? 625ull   :   \
+     (((k) >= 3) && (((f) % 125u) == 0u))   ? 125ull   :   \
+     (((k) >= 2) && (((f) % 25u) == 0u))    ? 25ull    :   \
+     (((k) >= 1) && (((f) % 5u) == 0u))     ? 5ull     : 1ull)
+
+/* mcd(f, 10^k). */
+#define TC_GCD10(f, k)  (TC_P2(f, k) * TC_P5(f, k))
+
+/* ms = ticks * TC_MS_NUM / TC_MS_DEN;  us = ticks * TC_US_NUM / TC_US_DEN */
+#define TC_MS_NUM  (1000ull / TC_GCD10(CLINT_CLOCK, 3))
+#define TC_MS_DEN  ((uint64_t)CLINT_CLOCK / TC_GCD10(CLINT_CLOCK, 3))
+#define TC_US_NUM  (1000000ull / TC_GCD10(CLINT_CLOCK, 6))
+#define TC_US_DEN  ((uint64_t)CLINT_CLOCK / TC_GCD10(CLINT_CLOCK, 6))
+
+/* ------------------------------------------------------------------ */
+/* Recíproco de un divisor constante d (1 <= d < 2^32)                 */
+/* ------------------------------------------------------------------ */
+#define TC_L(d)    (((d) <= 1u) ? 0 : (64 - __builtin_clzll((d) - 1u)))
+#define TC_A(d)    ((1ull << TC_L(d)) - (d))
+#define TC_M(d)                                                   \
+    ((((TC_A(d) << 32) / (d)) << 32) +                            \
+     ((((TC_A(d) << 32) % (d)) << 32) / (d)) + 1u)
+#define TC_SH1(d)  ((TC_L(d) < 1) ? TC_L(d) : 1)
+#define TC_SH2(d)  ((TC_L(d) > 1) ? (TC_L(d) - 1) : 0)
+
+#if (CLINT_CLOCK == 0) || ((CLINT_CLOCK / 0x100000000ull) != 0)
+#error "time_conv.h: CLINT_CLOCK debe estar entre 1 y 2^32 - 1"
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Primitivas                                                          */
+/* ------------------------------------------------------------------ */
+
+/* 64 bits superiores de a * b. */
+static inline uint64_t tc_mulhi(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#else
+    /* RV32: cuatro productos 32x32 (mul/mulhu). */
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo;
+    uint64_t p1 = a_lo * b_hi;
+    uint64_t p2 = a_hi * b_lo;
+    uint64_t p3 = a_hi * b_hi;
+    uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+
+    return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+/* floor(x / d) con d constante; se pliega entero en compilación. */
+#define TC_DIV(x, d)                                                  \
+    __extension__ ({                                                  \
+        uint64_t tc_x_ = (x);                                         \
+        uint64_t tc_t_ = tc_mulhi(TC_M(d), tc_x_);                    \
+        (tc_t_ + ((tc_x_ - tc_t_) >> TC_SH1(d))) >> TC_SH2(d);        \
+    })
+
+/* floor(x * num / den) sin desbordar el producto intermedio. */
+#define TC_SCALE(x, num, den)                                         \
+    __extension__ ({                                                  \
+        uint64_t tc_v_ = (x);                                         \
+        uint64_t tc_q_ = TC_DIV(tc_v_, (den));                        \
+        ((num) == 1u) ? tc_q_ :                                       \
+            (tc_q_ * (num) +                                          \
+             TC_DIV((tc_v_ - tc_q_ * (den)) * (num), (den)));         \
+    })
+
+/* ------------------------------------------------------------------ */
+/* Conversiones                                                        */
+/* ------------------------------------------------------------------ */
+static inline uint64_t ticks_to_ms(uint64_t ticks)
+{
+    return TC_SCALE(ticks, TC_MS_NUM, TC_MS_DEN);
+}
+
+static inline uint64_t ticks_to_us(uint64_t ticks)
+{
+    return TC_SCALE(ticks, TC_US_NUM, TC_US_DEN);
+}
+
+/* floor(ms * CLINT_CLOCK / 1000). */
+static inline uint64_t ms_to_ticks(uint64_t ms)
+{
+    return TC_SCALE(ms, TC_MS_DEN, TC_MS_NUM);
+}
+
+#endif /* TIME_CONV_H */
@@ -0,0 +1,197 @@
+/*
+ * amo_stress: prueba de esfuerzo de amo.h y gpio_out.h en el simulador
+ * (sim/).
+ *
+ * La ISR del timer, cada GAP ticks, suma 1 a un contador compartido,
+ * conmuta el bit 8 y asigna el bit 9 de una máscara compartida, y
+ * conmuta LED_1 con gpio_out_toggle() + gpio_out_flush(). main hace lo
+ * mismo sobre otros bits (bit 0, bits 4-7 y LED_0) sin parar
+ * interrupciones, y después de cada vuelta comprueba que no se ha
+ * perdido ninguna actualización. En la RMW ingenua (carga, escritura)
+ * AMO_HOOK() avanza el reloj virtual entre la carga y la escritura, de
+ * modo que la IRQ cae en todas las fases posibles; entre vueltas se
+ * espera un número pseudoaleatorio de ticks.
+ *
+ * Con AMO_ENABLE = 1 (por defecto en el host) amo.h usa los __atomic de
+ * GCC en lugar de amoor.w/amoxor.w/...; con -DAMO_ENABLE=0 se prueba la
+ * ruta de respaldo (RMW con la IRQ parada; aquí disable_irq/enable_irq).
+ *
+ *   gcc -O2 -Isim -I. -Itools tools/amo_stress.c sim/sim_hal.c \
+ *       tools/log_decode.c log.c gpio_out.c -o amo_stress -lm -lpthread
+ *   amo_stress [segundos]
+ *
+ * Devuelve 0 si amo.h no ha perdido ninguna actualización.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim_hal.h"
+
+#include "clinc.h"
+#include "dispatch.h"
+#include "gpio_drv.h"
+
+#define AMO_HOOK()          sim_advance(1u)
+#define AMO_IRQ_SAVE()      (disable_irq(), 0u)
+#define AMO_IRQ_RESTORE(s)  ((void)(s), enable_irq())
+#include "amo.h"
+#include "gpio_out.h"
+
+#define GAP        (23u)                /* Ticks entre IRQ.               */
+
+#define MAIN_BIT   (1u << 0)
+#define MAIN_FIELD (0xFu << 4)
+#define ISR_BIT    (1u << 8)
+#define ISR_FLAG   (1u << 9)
+
+enum { M_NAIVE, M_AMO, M_N };
+
+static const char *const method_name[M_N] = {
+    "ingenua (carga, escritura)", "amo.h"
+};
+
+static amo_count_t       counter;
+static amo_mask_t        mask;
+static volatile uint32_t isr_n;
+
+static uint8_t  method;
+static uint64_t loops;
+static uint64_t lost_count;             /* Sumas perdidas.                */
+static uint64_t lost_mask;              /* Vueltas con bits incorrectos.  */
+static uint64_t lost_port;              /* Puerto distinto de la sombra.  */
+
+static uint32_t rng = 0x12345678u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void timer_isr(void)
+{
+    uint32_t n = isr_n + 1u;
+
+    (void)amo_count_inc(&counter);
+    (void)amo_mask_toggle(&mask, ISR_BIT);
+    (void)amo_mask_assign(&mask, ISR_FLAG, (n & 1u) ? ISR_FLAG : 0u);
+    gpio_out_toggle(LED_1_MASK);
+    gpio_out_flush();
+    isr_n = n;
+}
+
+/* RMW en dos accesos: la IRQ puede caer entre la carga y la escritura. */
+static void naive_add(volatile uint32_t *p, uint32_t v)
+{
+    uint32_t old = *p;
+
+    AMO_HOOK();
+    *p = old + v;
+}
+
+static void naive_xor(volatile uint32_t *p, uint32_t v)
+{
+    uint32_t old = *p;
+
+    AMO_HOOK();
+    *p = old ^ v;
+}
+
+static void naive_assign(volatile uint32_t *p, uint32_t m, uint32_t bits)
+{
+    uint32_t old = *p;
+
+    AMO_HOOK();
+    *p = (old & ~m) | (bits & m);
+}
+
+static int stress_app(void)
+{
+    uint32_t main_n = 0u;
+
+    counter.v = 0u;
+    mask.v = 0u;
+    isr_n = 0u;
+    gpio_set_direction(LED_0_MASK | LED_1_MASK);
+    gpio_out_init(0u);
+
+    install_local_timer_handler(timer_isr);
+    local_timer_set_gap(GAP);
+    enable_timer_clinc_irq();
+    enable_irq();
+
+    for (;;) {
+        uint32_t exp_c, exp_m, k;
+
+        if (method == M_NAIVE) {
+            naive_add(&counter.v, 1u);
+            naive_xor(&mask.v, MAIN_BIT);
+            naive_assign(&mask.v, MAIN_FIELD, main_n << 4);
+        } else {
+            (void)amo_count_inc(&counter);
+            (void)amo_mask_toggle(&mask, MAIN_BIT);
+            (void)amo_mask_assign(&mask, MAIN_FIELD, main_n << 4);
+        }
+        gpio_out_toggle(LED_0_MASK);
+        gpio_out_flush();
+        main_n++;
+
+        /* Sin llamadas al HAL hasta el final: la ISR no entra aquí. */
+        k = isr_n;
+        exp_c = main_n + k;
+        exp_m = ((main_n & 1u) ? MAIN_BIT : 0u) |
+                (((main_n - 1u) << 4) & MAIN_FIELD) |
+                ((k & 1u) ? (ISR_BIT | ISR_FLAG) : 0u);
+        loops++;
+
+        if (counter.v != exp_c) {
+            lost_count += exp_c - counter.v;
+            counter.v = exp_c;
+        }
+        if (mask.v != exp_m) {
+            lost_mask++;
+            mask.v = exp_m;
+        }
+        if ((sim_cur->out != gpio_out_get()) ||
+            (gpio_out_get() != (((main_n & 1u) ? LED_0_MASK : 0u) |
+                                ((k & 1u) ? LED_1_MASK : 0u)))) {
+            lost_port++;
+        }
+
+        sim_advance(1u + (xorshift32() & 7u));
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static sim_ctx_t ctx;
+    static const sim_event_t none[] = { { 0u, 0u } };
+    double secs = (argc > 1) ? atof(argv[1]) : 2.0;
+    int bad = 0;
+
+    fprintf(stdout, "AMO_ENABLE = %d\n", AMO_ENABLE);
+    for (method = 0u; method < M_N; method++) {
+        loops = 0u;
+        lost_count = 0u;
+        lost_mask = 0u;
+        lost_port = 0u;
+        sim_init(&ctx, none, 1u, (uint64_t)(secs * CLINT_CLOCK));
+        sim_run(&ctx, stress_app);
+
+        fprintf(stdout, "%-26s: %llu vueltas, %llu IRQ, %llu sumas "
+                "perdidas, %llu máscaras mal, %llu puerto mal\n",
+                method_name[method], (unsigned long long)loops,
+                (unsigned long long)ctx.timer_irqs,
+                (unsigned long long)lost_count,
+                (unsigned long long)lost_mask,
+                (unsigned long long)lost_port);
+        if ((method != M_NAIVE) &&
+            ((lost_count | lost_mask | lost_port) != 0u)) {
+            bad = 1;
+        }
+    }
+    return bad;
+}
@@ -0,0 +1,207 @@
+/*
+ * btn_bench: RAM y coste por vuelta del estado de medición de los
+ * botones con btnstore.h (estructura de arrays) frente al btn_state_t
+ * anterior de main_inicial_superloop.c (array de estructuras), con 4, 16
+ * y 32 botones.
+ *
+ *   gcc -O2 -Isim -I. tools/btn_bench.c debounce.c -o btn_bench
+ *   gcc -O2 -Isim -I. -DBTNSTORE_TS_BITS=16 tools/btn_bench.c \
+ *       debounce.c -o btn_bench16
+ *   btn_bench; btn_bench16
+ *
+ * Cada vuelta hace lo que haría el super-loop con el estado: una muestra
+ * del antirrebote (debounce.h), la pulsación o liberación de cada flanco
+ * y la búsqueda de los botones mantenidos más de 1 s (pulsación larga
+ * sin esperar a soltar). Las entradas son las ráfagas pseudoaleatorias
+ * de tools/debounce_bench.c; ambos métodos reciben la misma secuencia
+ * y, con resolución de 1 tick, deben dar el mismo resultado.
+ *
+ * La RAM es la de una variable con ese número de botones (la de 32 con
+ * solo los primeros desplazamientos, redondeada a la alineación de la
+ * estructura). Los ciclos son del TSC en x86 (si no, solo ns); en la
+ * placa, el estado anterior ocupa además más líneas de caché.
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "debounce.h"
+
+#undef BTNSTORE_BUTTONS
+#define BTNSTORE_BUTTONS  (32u)
+#include "btnstore.h"
+
+#define N_ITERS        (20000000u)
+#define LONG_TICKS     (1000u)       /* Pulsación larga, en vueltas.     */
+
+/* Versión anterior: estado por botón. */
+typedef struct {
+    uint8_t  waiting_release;
+    uint64_t t_press;
+} btn_state_t;
+
+static btn_state_t legacy[32];
+static btnstore_t  store;
+static debounce_t  deb;
+
+static uint32_t legacy_iter(uint32_t raw, unsigned n, uint64_t now)
+{
+    uint32_t edges = debounce_sample(&deb, raw);
+    uint32_t held = 0u;
+    uint32_t m;
+    unsigned i;
+
+    for (m = edges; m != 0u; m &= m - 1u) {
+        uint8_t b = (uint8_t)__builtin_ctz(m);
+
+        if ((deb.rise >> b) & 1u) {
+            legacy[b].t_press = now;
+            legacy[b].waiting_release = 1;
+        } else if (legacy[b].waiting_release) {
+            held += (uint32_t)(now - legacy[b].t_press);
+            legacy[b].waiting_release = 0;
+        }
+    }
+    for (i = 0; i < n; i++) {
+        if (legacy[i].waiting_release &&
+            (now - legacy[i].t_press) >= LONG_TICKS) {
+            held |= 1UL << i;
+        }
+    }
+    return held;
+}
+
+static uint32_t store_iter(uint32_t raw, uint64_t now)
+{
+    uint32_t edges = debounce_sample(&deb, raw);
+    uint32_t held = 0u;
+    uint32_t m;
+
+    for (m = edges; m != 0u; m &= m - 1u) {
+        uint8_t b = (uint8_t)__builtin_ctz(m);
+
+        if ((deb.rise >> b) & 1u) {
+            btnstore_press(&store, b, now);
+        } else if (btnstore_waiting(&store, b)) {
+            held += (uint32_t)btnstore_release(&store, b, now);
+        }
+    }
+    return held | btnstore_held_mask(&store, now, LONG_TICKS);
+}
+
+static uint32_t rng = 0x12345678u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t inputs[1u << 16];
+
+static void make_inputs(uint32_t mask)
+{
+    uint32_t level = 0u;
+    unsigned i;
+
+    /* Cambios de nivel raros con rebotes cortos alrededor. */
+    for (i = 0; i < (1u << 16); i++) {
+        uint32_t r = xorshift32();
+
+        if ((r & 0xFFu) == 0u) {
+            level ^= xorshift32() & mask;
+        }
+        inputs[i] = level ^ (((r >> 8) & 0x7u) == 0u ? (xorshift32() & mask)
+                                                     : 0u);
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0u;
+#endif
+}
+
+/* Bytes de un btnstore_t de n botones. */
+static size_t store_bytes(unsigned n)
+{
+    size_t a = _Alignof(btnstore_t);
+    size_t b = offsetof(btnstore_t, t) + n * sizeof(btnstore_ts_t);
+
+    return (b + a - 1u) / a * a;
+}
+
+static volatile uint32_t sink;
+
+int main(void)
+{
+    static const unsigned counts[] = { 4u, 16u, 32u };
+    unsigned c;
+
+    printf("desplazamientos de %u bits, unidad %u ticks, rango %llu "
+           "ticks\n", (unsigned)BTNSTORE_TS_BITS,
+           1u << BTNSTORE_TS_SHIFT,
+           (unsigned long long)BTNSTORE_TS_RANGE);
+    printf("botones  RAM anterior  RAM btnstore    "
+           "anterior (ns  ciclos)    btnstore (ns  ciclos)\n");
+    for (c = 0; c < sizeof counts / sizeof counts[0]; c++) {
+        unsigned n = counts[c];
+        uint32_t mask = (n == 32u) ? 0xFFFFFFFFu : ((1u << n) - 1u);
+        size_t old_b = n * sizeof(btn_state_t);
+        size_t new_b = store_bytes(n);
+        uint32_t acc_old = 0u, acc_new = 0u;
+        double t0, t1, t2, t3;
+        uint64_t k0, k1, k2, k3;
+        uint32_t i;
+
+        make_inputs(mask);
+        for (i = 0; i < 32u; i++) {
+            legacy[i] = (btn_state_t){ 0 };
+        }
+
+        debounce_init(&deb, 0u);
+        t0 = now_ns();
+        k0 = now_cycles();
+        for (i = 0; i < N_ITERS; i++) {
+            acc_old += legacy_iter(inputs[i & 0xFFFFu], n, i);
+        }
+        k1 = now_cycles();
+        t1 = now_ns();
+
+        debounce_init(&deb, 0u);
+        btnstore_init(&store, 0u);
+        t2 = now_ns();
+        k2 = now_cycles();
+        for (i = 0; i < N_ITERS; i++) {
+            acc_new += store_iter(inputs[i & 0xFFFFu], i);
+        }
+        k3 = now_cycles();
+        t3 = now_ns();
+        sink = acc_old + acc_new;
+
+        printf("%7u  %5zu (%4.1f/b)  %5zu (%4.1f/b)    %8.2f  %6.1f"
+               "    %8.2f  %6.1f\n", n,
+               old_b, (double)old_b / n, new_b, (double)new_b / n,
+               (t1 - t0) / N_ITERS, (double)(k1 - k0) / N_ITERS,
+               (t3 - t2) / N_ITERS, (double)(k3 - k2) / N_ITERS);
+        if (BTNSTORE_TS_SHIFT == 0u && acc_old != acc_new) {
+            printf("  resultados distintos: %08x %08x\n",
+                   (unsigned)acc_old, (unsigned)acc_new);
+            return 1;
+        }
+    }
+    return 0;
+}
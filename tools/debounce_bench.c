@@ -0,0 +1,134 @@
+/*
+ * debounce_bench: coste por muestra del antirrebote de debounce.h frente
+ * al bucle por botón de la versión anterior de main_inicial_superloop.c
+ * (btn_state_t con last_raw/last_change por botón), con 2, 4, 16 y 32
+ * botones conectados.
+ *
+ *   gcc -O2 -Isim -I. tools/debounce_bench.c debounce.c -o debounce_bench
+ *   debounce_bench
+ *
+ * Las entradas son ráfagas de rebote pseudoaleatorias en los bits
+ * conectados; ambos métodos reciben la misma secuencia.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "debounce.h"
+
+#define N_SAMPLES      (20000000u)
+#define DEBOUNCE_TCK   (4u)          /* Ventana en muestras.            */
+
+/* Versión anterior: estado por botón y bucle O(N). */
+typedef struct {
+    uint8_t  stable;
+    uint8_t  last_raw;
+    uint64_t last_change;
+    uint8_t  waiting_release;
+    uint64_t t_press;
+} btn_state_t;
+
+static btn_state_t legacy[32];
+
+static uint32_t legacy_sample(uint32_t raw, unsigned n, uint64_t now)
+{
+    uint32_t edges = 0u;
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        uint8_t bit = (raw >> i) & 1u;
+
+        if (bit != legacy[i].last_raw) {
+            legacy[i].last_raw = bit;
+            legacy[i].last_change = now;
+        }
+        if ((now - legacy[i].last_change) >= DEBOUNCE_TCK) {
+            if (bit != legacy[i].stable) {
+                legacy[i].stable = bit;
+                edges |= (1u << i);
+                if (bit) {
+                    legacy[i].t_press = now;
+                    legacy[i].waiting_release = 1;
+                } else {
+                    legacy[i].waiting_release = 0;
+                }
+            }
+        }
+    }
+    return edges;
+}
+
+static uint32_t rng = 0x12345678u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t inputs[1u << 16];
+
+static void make_inputs(uint32_t mask)
+{
+    uint32_t level = 0u;
+    unsigned i;
+
+    /* Cambios de nivel raros con rebotes cortos alrededor. */
+    for (i = 0; i < (1u << 16); i++) {
+        uint32_t r = xorshift32();
+
+        if ((r & 0xFFu) == 0u) {
+            level ^= xorshift32() & mask;
+        }
+        inputs[i] = level ^ (((r >> 8) & 0x7u) == 0u ? (xorshift32() & mask)
+                                                     : 0u);
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static volatile uint32_t sink;
+
+int main(void)
+{
+    static const unsigned counts[] = { 2u, 4u, 16u, 32u };
+    unsigned c;
+
+    printf("botones  vertical (ns/muestra)  por botón (ns/muestra)\n");
+    for (c = 0; c < sizeof counts / sizeof counts[0]; c++) {
+        unsigned n = counts[c];
+        uint32_t mask = (n == 32u) ? 0xFFFFFFFFu : ((1u << n) - 1u);
+        debounce_t d;
+        uint32_t acc = 0u;
+        double t0, t1, t2;
+        uint32_t i;
+
+        make_inputs(mask);
+        debounce_init(&d, 0u);
+        for (i = 0; i < 32u; i++) {
+            legacy[i] = (btn_state_t){ 0 };
+        }
+
+        t0 = now_ns();
+        for (i = 0; i < N_SAMPLES; i++) {
+            acc += debounce_sample(&d, inputs[i & 0xFFFFu]);
+        }
+        t1 = now_ns();
+        for (i = 0; i < N_SAMPLES; i++) {
+            acc += legacy_sample(inputs[i & 0xFFFFu], n, i);
+        }
+        t2 = now_ns();
+        sink = acc;
+
+        printf("%7u  %22.2f  %22.2f\n", n,
+               (t1 - t0) / N_SAMPLES, (t2 - t1) / N_SAMPLES);
+    }
+    return 0;
+}
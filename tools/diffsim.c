@@ -0,0 +1,635 @@
+/*
+ * diffsim: simulación diferencial de las variantes main_*.c.
+ *
+ * Cada variante se compila, con el simulador y todos los módulos, como
+ * una biblioteca compartida; diffsim las carga a la vez (RTLD_LOCAL:
+ * cada una con sus propias variables globales, su propio HAL simulado y
+ * su propio sim_cur), las ejecuta en paralelo (un hilo por variante)
+ * con las mismas trazas de entrada y compara lo que hacen:
+ *
+ *   for v in main_*.c; do
+ *     gcc -O2 -fPIC -shared -Wl,-Bsymbolic -Isim -I. -Itools \
+ *         -fno-builtin-printf -Dmain=app_main $v sim/sim_hal.c \
+ *         tools/log_decode.c log.c debounce.c fsm.c fmt.c gpio_out.c \
+ *         idle.c instr.c lacap.c oneshot.c pstats.c sched.c swpwm.c \
+ *         swtimer.c -o ${v%.c}.so -lm -lpthread
+ *   done
+ *   gcc -O2 -Isim -Itools tools/diffsim.c -o diffsim -ldl -lpthread
+ *   ./diffsim [-n trazas] [-s semilla] [-R referencia] ./main_*.so
+ *
+ * main_inicial_superloop.c va con LED_PWM = 0 (por defecto): el fundido
+ * PWM mientras se mantiene un botón es propio de esa variante y taparía
+ * el resto de diferencias.
+ *
+ * Antes de cada traza se restaura la copia del segmento de datos
+ * escribible de la biblioteca tomada al cargarla, así que cada ejecución
+ * empieza desde el estado inicial del programa. main_dual_superloop se
+ * ejecuta en dos harts (sim_run2). Todas con avance rápido (ffwd.h).
+ *
+ * Trazas: de 1 a 4 acciones separadas por 100 a 700 ms. Cada acción es
+ * una pulsación de PBT_0 (corta, larga o de 997 a 1003 ms, alrededor del
+ * umbral de 1 s), de PBT_1 (corta o mantenida durante el parpadeo), de
+ * PBT_1 con PBT_0 pulsado o de los dos a la vez. Una de cada cuatro
+ * trazas lleva rebotes en cada flanco. La traza sigue 1,6 s después del
+ * último cambio.
+ *
+ * Comparación con la variante de referencia (main_final_superloop por
+ * defecto): la secuencia de estados de los LEDs, cada cambio en su
+ * instante con una tolerancia de DIFF_TOL_LED_MS, y la secuencia de
+ * duraciones impresas (el número ante "ms" o "us" de cada línea, en ms)
+ * con tolerancia DIFF_TOL_DUR_MS. De cada variante que difiere se
+ * informa del número de trazas y de la primera, reducida quitando cambios
+ * de entrada mientras la diferencia se mantenga.
+ */
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <link.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim_hal.h"
+#include "gpio_drv.h"
+
+#define DIFF_MAX_VARIANTS  (16u)
+#define DIFF_MAX_EV        (256u)
+#define DIFF_MAX_LED       (64u)
+#define DIFF_MAX_DUR       (16u)
+#define DIFF_BATCH         (256u)
+
+#define DIFF_TOL_LED_MS    (15u)
+#define DIFF_TOL_DUR_MS    (5u)
+#define DIFF_TAIL_MS       (1600u)
+
+#define LED_MASK  (LED_0_MASK | LED_1_MASK | LED_2_MASK | LED_3_MASK)
+
+#define MS(x)  ((uint64_t)(x) * SIM_TICKS_PER_MS)
+#define US(x)  ((uint64_t)(x) * (CLINT_CLOCK / 1000000u))
+
+/* ------------------------------------------------------------------ */
+/* Trazas y resultados                                                 */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    sim_event_t ev[DIFF_MAX_EV];
+    size_t      n;
+} trace_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint32_t v;
+} led_ev_t;
+
+typedef struct {
+    led_ev_t led[DIFF_MAX_LED];
+    uint32_t n_led;
+    uint32_t dur[DIFF_MAX_DUR];
+    uint32_t n_dur;
+    uint8_t  overflow;          /* Más cambios de los que caben.         */
+} result_t;
+
+/* ------------------------------------------------------------------ */
+/* Variantes                                                           */
+/* ------------------------------------------------------------------ */
+typedef struct {
+    char      name[64];
+    void     *dl;
+    uintptr_t base;             /* Dirección de carga (link_map).        */
+    void    (*sim_init)(sim_ctx_t *, const sim_event_t *, size_t,
+                        uint64_t);
+    void    (*sim_run)(sim_ctx_t *, int (*)(void));
+    int     (*app)(void);
+    sim_ctx_t ctx;
+
+    /* Segmento de datos escribible y su copia inicial. */
+    uint8_t  *rw;
+    size_t    rw_len;
+    uint8_t  *snap;
+
+    /* Lote en curso. */
+    const trace_t *batch;
+    size_t    batch_n;
+    result_t *res;
+    double    busy;             /* Segundos de CPU de su hilo.           */
+
+    /* Diferencias con la referencia. */
+    uint64_t  n_diff;
+    trace_t   first;
+} variant_t;
+
+static variant_t variants[DIFF_MAX_VARIANTS];
+static size_t n_variants;
+
+/* Busca el segmento PT_LOAD escribible de la biblioteca con base 'arg',
+ * sin la parte de solo lectura tras la reubicación (PT_GNU_RELRO). */
+static int find_rw(struct dl_phdr_info *info, size_t size, void *arg)
+{
+    variant_t *v = arg;
+    uintptr_t lo = 0u, hi = 0u, relro_end = 0u;
+    int i;
+
+    (void)size;
+    if (info->dlpi_addr != v->base) {
+        return 0;
+    }
+    for (i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *ph = &info->dlpi_phdr[i];
+
+        if ((ph->p_type == PT_LOAD) && (ph->p_flags & PF_W)) {
+            lo = info->dlpi_addr + ph->p_vaddr;
+            hi = lo + ph->p_memsz;
+        } else if (ph->p_type == PT_GNU_RELRO) {
+            relro_end = info->dlpi_addr + ph->p_vaddr + ph->p_memsz;
+        }
+    }
+    if ((relro_end > lo) && (relro_end < hi)) {
+        lo = relro_end;
+    }
+    v->rw = (uint8_t *)lo;
+    v->rw_len = hi - lo;
+    return 1;
+}
+
+static int variant_load(variant_t *v, const char *path)
+{
+    const char *base = strrchr(path, '/');
+    struct link_map *lm;
+    char *dot;
+
+    snprintf(v->name, sizeof v->name, "%s", (base != NULL) ? base + 1 : path);
+    dot = strstr(v->name, ".so");
+    if (dot != NULL) {
+        *dot = '\0';
+    }
+
+    v->dl = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (v->dl == NULL) {
+        fprintf(stderr, "diffsim: %s\n", dlerror());
+        return 0;
+    }
+    v->sim_init = (void (*)(sim_ctx_t *, const sim_event_t *, size_t,
+                            uint64_t))dlsym(v->dl, "sim_init");
+    v->sim_run = (void (*)(sim_ctx_t *, int (*)(void)))
+                 dlsym(v->dl, strstr(v->name, "dual") ? "sim_run2" :
+                                                        "sim_run");
+    v->app = (int (*)(void))dlsym(v->dl, "app_main");
+    if ((v->sim_init == NULL) || (v->sim_run == NULL) || (v->app == NULL)) {
+        fprintf(stderr, "diffsim: %s: faltan símbolos del simulador\n",
+                path);
+        return 0;
+    }
+
+    if (dlinfo(v->dl, RTLD_DI_LINKMAP, &lm) != 0) {
+        fprintf(stderr, "diffsim: %s\n", dlerror());
+        return 0;
+    }
+    v->base = lm->l_addr;
+    dl_iterate_phdr(find_rw, v);
+    v->snap = malloc(v->rw_len);
+    if ((v->rw == NULL) || (v->snap == NULL)) {
+        fprintf(stderr, "diffsim: %s: sin segmento de datos\n", path);
+        return 0;
+    }
+    memcpy(v->snap, v->rw, v->rw_len);
+    return 1;
+}
+
+/* Duración de una línea: el número ante " ms" o " us", en ms. */
+static int line_duration(const char *line, uint32_t *ms)
+{
+    const char *p;
+
+    for (p = line; *p != '\0'; p++) {
+        const char *q = p;
+        unsigned long n = 0u;
+
+        if ((*p < '0') || (*p > '9') || ((p > line) && (p[-1] >= '0') &&
+                                         (p[-1] <= '9'))) {
+            continue;
+        }
+        while ((*q >= '0') && (*q <= '9')) {
+            n = n * 10u + (unsigned long)(*q++ - '0');
+        }
+        if (strncmp(q, " ms", 3) == 0) {
+            *ms = (uint32_t)n;
+            return 1;
+        }
+        if (strncmp(q, " us", 3) == 0) {
+            *ms = (uint32_t)((n + 500u) / 1000u);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Salida de sim (golden, ver sim_hal.h) -> resultado. */
+static void parse_golden(const char *buf, result_t *r)
+{
+    uint32_t leds = 0u;
+    const char *p = buf;
+
+    memset(r, 0, sizeof *r);
+    while (*p != '\0') {
+        const char *eol = strchr(p, '\n');
+        unsigned long long t;
+        char kind[8];
+        int off = 0;
+
+        if (sscanf(p, "%llu %7s %n", &t, kind, &off) == 2) {
+            uint32_t t_ms = (uint32_t)(t / SIM_TICKS_PER_MS);
+
+            if (strcmp(kind, "gpio") == 0) {
+                uint32_t v = (uint32_t)strtoul(p + off, NULL, 16) & LED_MASK;
+
+                if (v != leds) {
+                    leds = v;
+                    if (r->n_led < DIFF_MAX_LED) {
+                        r->led[r->n_led].t_ms = t_ms;
+                        r->led[r->n_led++].v = v;
+                    } else {
+                        r->overflow = 1u;
+                    }
+                }
+            } else if (strcmp(kind, "uart") == 0) {
+                uint32_t ms;
+
+                if (line_duration(p + off, &ms)) {
+                    if (r->n_dur < DIFF_MAX_DUR) {
+                        r->dur[r->n_dur++] = ms;
+                    } else {
+                        r->overflow = 1u;
+                    }
+                }
+            }
+        }
+        if (eol == NULL) {
+            break;
+        }
+        p = eol + 1;
+    }
+}
+
+static void variant_run(variant_t *v, const trace_t *tr, result_t *r)
+{
+    char *buf = NULL;
+    size_t len = 0u;
+    FILE *golden;
+    uint64_t end = tr->ev[tr->n - 1u].t + MS(DIFF_TAIL_MS);
+
+    memcpy(v->rw, v->snap, v->rw_len);
+    golden = open_memstream(&buf, &len);
+    v->sim_init(&v->ctx, tr->ev, tr->n, end);
+    v->ctx.golden = golden;
+    v->ctx.ffwd = 1u;
+    v->sim_run(&v->ctx, v->app);
+    fclose(golden);
+    parse_golden(buf, r);
+    free(buf);
+}
+
+static uint32_t absdiff(uint32_t a, uint32_t b)
+{
+    return (a > b) ? (a - b) : (b - a);
+}
+
+static int result_same(const result_t *a, const result_t *b)
+{
+    uint32_t i;
+
+    if ((a->n_led != b->n_led) || (a->n_dur != b->n_dur) ||
+        (a->overflow != b->overflow)) {
+        return 0;
+    }
+    for (i = 0u; i < a->n_led; i++) {
+        if ((a->led[i].v != b->led[i].v) ||
+            (absdiff(a->led[i].t_ms, b->led[i].t_ms) > DIFF_TOL_LED_MS)) {
+            return 0;
+        }
+    }
+    for (i = 0u; i < a->n_dur; i++) {
+        if (absdiff(a->dur[i], b->dur[i]) > DIFF_TOL_DUR_MS) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static double clock_secs(clockid_t id)
+{
+    struct timespec ts;
+
+    clock_gettime(id, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void *variant_thread(void *arg)
+{
+    variant_t *v = arg;
+    double t0 = clock_secs(CLOCK_THREAD_CPUTIME_ID);
+    size_t i;
+
+    for (i = 0u; i < v->batch_n; i++) {
+        variant_run(v, &v->batch[i], &v->res[i]);
+    }
+    v->busy += clock_secs(CLOCK_THREAD_CPUTIME_ID) - t0;
+    return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/* Generación de trazas                                                */
+/* ------------------------------------------------------------------ */
+static uint32_t rng = 1u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t uniform(uint32_t lo, uint32_t hi)
+{
+    return lo + xorshift32() % (hi - lo + 1u);
+}
+
+static void push(trace_t *tr, uint64_t t_us, uint32_t pins)
+{
+    if (tr->n < DIFF_MAX_EV) {
+        tr->ev[tr->n].t = US(t_us);
+        tr->ev[tr->n++].pins = pins;
+    }
+}
+
+/* Duración de una pulsación de PBT_0 en ms. */
+static uint32_t press_ms(void)
+{
+    switch (xorshift32() % 3u) {
+    case 0u:
+        return uniform(997u, 1003u);
+    case 1u:
+        return uniform(30u, 990u);
+    default:
+        return uniform(1004u, 2500u);
+    }
+}
+
+/* Tren de rebotes antes de cada cambio de clean[0..n). */
+static void add_bounce(trace_t *tr, const trace_t *clean)
+{
+    uint32_t prev = 0u;
+    size_t i;
+
+    tr->n = 0u;
+    for (i = 0u; i < clean->n; i++) {
+        uint64_t t_us = clean->ev[i].t / US(1);
+        uint32_t k, m = uniform(2u, 6u);
+
+        for (k = 0u; k < m; k++) {
+            push(tr, t_us, clean->ev[i].pins);
+            t_us += uniform(20u, 150u);
+            push(tr, t_us, prev);
+            t_us += uniform(20u, 150u);
+        }
+        push(tr, t_us, clean->ev[i].pins);
+        prev = clean->ev[i].pins;
+    }
+}
+
+static void trace_random(trace_t *tr)
+{
+    static trace_t clean;
+    uint64_t t = (uint64_t)uniform(50u, 300u) * 1000u;
+    uint32_t k, n_act = uniform(1u, 4u);
+
+    clean.n = 0u;
+    for (k = 0u; k < n_act; k++) {
+        uint64_t d = press_ms();
+        uint64_t a, b;
+
+        t += uniform(0u, 999u);
+        switch (xorshift32() % 6u) {
+        case 0u:
+        case 1u:
+            push(&clean, t, PBT_0_MASK);
+            push(&clean, t + d * 1000u, 0u);
+            break;
+        case 2u:
+            d = uniform(30u, 300u);
+            push(&clean, t, PBT_1_MASK);
+            push(&clean, t + d * 1000u, 0u);
+            break;
+        case 3u:
+            d = uniform(600u, 1500u);
+            push(&clean, t, PBT_1_MASK);
+            push(&clean, t + d * 1000u, 0u);
+            break;
+        case 4u:
+            d = uniform(300u, 2000u);
+            a = uniform(50u, (uint32_t)d / 2u);
+            b = uniform(20u, (uint32_t)d / 2u - 10u);
+            push(&clean, t, PBT_0_MASK);
+            push(&clean, t + a * 1000u, PBT_0_MASK | PBT_1_MASK);
+            push(&clean, t + (a + b) * 1000u, PBT_0_MASK);
+            push(&clean, t + d * 1000u, 0u);
+            break;
+        default:
+            push(&clean, t, PBT_0_MASK | PBT_1_MASK);
+            push(&clean, t + d * 1000u, 0u);
+            break;
+        }
+        t += d * 1000u + (uint64_t)uniform(100u, 700u) * 1000u;
+    }
+
+    if ((xorshift32() & 3u) == 0u) {
+        add_bounce(tr, &clean);
+    } else {
+        *tr = clean;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Reducción e informe                                                 */
+/* ------------------------------------------------------------------ */
+static int diverges(variant_t *v, variant_t *ref, const trace_t *tr)
+{
+    static result_t rv, rr;
+
+    if (tr->n == 0u) {
+        return 0;
+    }
+    variant_run(v, tr, &rv);
+    variant_run(ref, tr, &rr);
+    return !result_same(&rv, &rr);
+}
+
+/* Quita cambios de entrada, uno a uno, mientras la diferencia siga. */
+static void shrink(variant_t *v, variant_t *ref, trace_t *tr)
+{
+    static trace_t cand;
+    int changed = 1;
+
+    while (changed) {
+        size_t i;
+
+        changed = 0;
+        for (i = tr->n; i-- > 0u;) {
+            cand.n = 0u;
+            memcpy(cand.ev, tr->ev, i * sizeof tr->ev[0]);
+            memcpy(&cand.ev[i], &tr->ev[i + 1u],
+                   (tr->n - i - 1u) * sizeof tr->ev[0]);
+            cand.n = tr->n - 1u;
+            if (diverges(v, ref, &cand)) {
+                *tr = cand;
+                changed = 1;
+            }
+        }
+    }
+}
+
+static void print_result(const char *who, const result_t *r)
+{
+    uint32_t i;
+
+    printf("    %-22s LED:", who);
+    for (i = 0u; i < r->n_led; i++) {
+        printf(" %u ms=%x", (unsigned)r->led[i].t_ms,
+               (unsigned)(r->led[i].v >> 16));
+    }
+    printf("%s\n", r->overflow ? " ..." : "");
+    printf("    %-22s duraciones:", "");
+    for (i = 0u; i < r->n_dur; i++) {
+        printf(" %u", (unsigned)r->dur[i]);
+    }
+    printf("\n");
+}
+
+static void report_divergence(variant_t *v, variant_t *ref)
+{
+    static result_t rv, rr;
+    trace_t *tr = &v->first;
+    size_t i;
+
+    shrink(v, ref, tr);
+    variant_run(v, tr, &rv);
+    variant_run(ref, tr, &rr);
+
+    printf("\n%s: traza mínima (%zu cambios)\n", v->name, tr->n);
+    for (i = 0u; i < tr->n; i++) {
+        printf("    %10.3f ms  %s%s\n",
+               (double)tr->ev[i].t / (double)SIM_TICKS_PER_MS,
+               (tr->ev[i].pins & PBT_0_MASK) ? "PBT_0 " : "",
+               (tr->ev[i].pins & PBT_1_MASK) ? "PBT_1" :
+               ((tr->ev[i].pins & PBT_0_MASK) ? "" : "-"));
+    }
+    print_result(ref->name, &rr);
+    print_result(v->name, &rv);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "uso: %s [-n trazas] [-s semilla] [-R referencia] "
+            "variante.so...\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    static trace_t batch[DIFF_BATCH];
+    static result_t res[DIFF_MAX_VARIANTS][DIFF_BATCH];
+    const char *ref_name = "main_final_superloop";
+    variant_t *ref = NULL;
+    unsigned long n_traces = 100u;
+    unsigned long done = 0u;
+    double t0, wall;
+    size_t k;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+            n_traces = strtoul(argv[++i], NULL, 0);
+        } else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+            rng = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (rng == 0u) {
+                rng = 1u;
+            }
+        } else if ((strcmp(argv[i], "-R") == 0) && (i + 1 < argc)) {
+            ref_name = argv[++i];
+        } else if (n_variants < DIFF_MAX_VARIANTS) {
+            if (!variant_load(&variants[n_variants], argv[i])) {
+                return 1;
+            }
+            if (strcmp(variants[n_variants].name, ref_name) == 0) {
+                ref = &variants[n_variants];
+            }
+            n_variants++;
+        }
+    }
+    if ((n_variants < 2u) || (ref == NULL)) {
+        usage(argv[0]);
+        fprintf(stderr, "diffsim: hacen falta la referencia (%s) y al "
+                "menos otra variante\n", ref_name);
+        return 1;
+    }
+
+    printf("diffsim: %zu variantes, %lu trazas, referencia %s\n",
+           n_variants, n_traces, ref->name);
+
+    t0 = clock_secs(CLOCK_MONOTONIC);
+    while (done < n_traces) {
+        size_t n = ((n_traces - done) < DIFF_BATCH) ?
+                   (size_t)(n_traces - done) : DIFF_BATCH;
+        pthread_t th[DIFF_MAX_VARIANTS];
+        size_t j;
+
+        for (j = 0u; j < n; j++) {
+            trace_random(&batch[j]);
+        }
+        for (k = 0u; k < n_variants; k++) {
+            variants[k].batch = batch;
+            variants[k].batch_n = n;
+            variants[k].res = res[k];
+            pthread_create(&th[k], NULL, variant_thread, &variants[k]);
+        }
+        for (k = 0u; k < n_variants; k++) {
+            pthread_join(th[k], NULL);
+        }
+
+        for (k = 0u; k < n_variants; k++) {
+            variant_t *v = &variants[k];
+
+            if (v == ref) {
+                continue;
+            }
+            for (j = 0u; j < n; j++) {
+                if (!result_same(&res[k][j], &res[ref - variants][j])) {
+                    if (v->n_diff == 0u) {
+                        v->first = batch[j];
+                    }
+                    v->n_diff++;
+                }
+            }
+        }
+        done += n;
+    }
+    wall = clock_secs(CLOCK_MONOTONIC) - t0;
+
+    printf("  %-28s %10s %12s\n", "variante", "difieren", "trazas/s");
+    for (k = 0u; k < n_variants; k++) {
+        const variant_t *v = &variants[k];
+
+        printf("  %-28s %10llu %12.0f%s\n", v->name,
+               (unsigned long long)v->n_diff,
+               (v->busy > 0.0) ? (double)n_traces / v->busy : 0.0,
+               (v == ref) ? "  (referencia)" : "");
+    }
+    printf("  %lu trazas x %zu variantes en %.2f s: %.0f trazas/min\n",
+           n_traces, n_variants, wall, (double)n_traces * 60.0 / wall);
+
+    for (k = 0u; k < n_variants; k++) {
+        if (variants[k].n_diff != 0u) {
+            report_divergence(&variants[k], ref);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * fmt_bench: comprueba fmt.h frente a snprintf y compara el coste por
+ * llamada con los mensajes de log_fmt.h.
+ *
+ *   gcc -O2 -Isim -I. tools/fmt_bench.c fmt.c -o fmt_bench
+ *   fmt_bench [n_aleatorios]
+ *
+ * Casos límite (0, 9, 10, potencias de 10 +-1, 2^32 +-1, 2^64 - 1) y
+ * n_aleatorios valores (por defecto 10^7) con longitud en bits uniforme,
+ * de 32 y de 64 bits. Después, ns por mensaje para cada formato de
+ * log_fmt.h (fmt_line frente a snprintf) y para "%llu" (fmt_u64 frente
+ * a snprintf).
+ *
+ * Tamaño de código: 'size fmt.o'. Que no hay división de 64 bits se ve
+ * compilando para 32 bits (gcc -m32 -ffreestanding -Os -Isim -I. -c
+ * fmt.c; nm fmt.o: sin __udivdi3 ni __umoddi3).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fmt.h"
+#include "log_fmt.h"
+
+#define LOG_FMT_STR(id, fmt)  fmt,
+
+static const char *const log_fmt[LOG_N_FORMATS] = {
+    LOG_FORMATS(LOG_FMT_STR)
+};
+
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+static uint64_t xorshift64(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+/* Valor con longitud en bits uniforme entre 1 y 'bits'. */
+static uint64_t rand_bits(unsigned bits)
+{
+    unsigned k = 1u + (unsigned)(xorshift64() % bits);
+
+    return (k == 64u) ? xorshift64() : (xorshift64() & ((1ull << k) - 1u));
+}
+
+static int check_u64(uint64_t v)
+{
+    char a[32], b[32];
+    char *end = fmt_u64(a, v);
+
+    *end = '\0';
+    snprintf(b, sizeof b, "%llu", (unsigned long long)v);
+    if (strcmp(a, b) != 0) {
+        fprintf(stdout, "  fmt_u64(%s) = %s\n", b, a);
+        return 1;
+    }
+    if ((v >> 32) == 0u) {
+        end = fmt_u32(a, (uint32_t)v);
+        *end = '\0';
+        if (strcmp(a, b) != 0) {
+            fprintf(stdout, "  fmt_u32(%s) = %s\n", b, a);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t arg_ms[4] = { 50u, 300u, 1500u, 86400000u };
+    uint64_t n = (argc > 1) ? strtoull(argv[1], NULL, 10) : 10000000ull;
+    uint64_t i, p10 = 1u, bad = 0u;
+    volatile uint32_t sink = 0u;
+    uint32_t reps = 2000000u;
+    char buf[128];
+    double t0, t_fmt, t_printf;
+    uint8_t id;
+
+    /* Casos límite. */
+    bad += (uint64_t)check_u64(0u);
+    bad += (uint64_t)check_u64(~0ull);
+    bad += (uint64_t)check_u64(0xFFFFFFFFull);
+    bad += (uint64_t)check_u64(0x100000000ull);
+    for (i = 0u; i < 20u; i++) {
+        bad += (uint64_t)check_u64(p10 - 1u);
+        bad += (uint64_t)check_u64(p10);
+        bad += (uint64_t)check_u64(p10 + 1u);
+        p10 *= 10u;
+    }
+    /* Aleatorios. */
+    for (i = 0u; i < n; i++) {
+        bad += (uint64_t)check_u64(rand_bits(32u));
+        bad += (uint64_t)check_u64(rand_bits(64u));
+    }
+    fprintf(stdout, "equivalencia: %llu valores, %llu errores\n",
+            (unsigned long long)(2u * n + 64u), (unsigned long long)bad);
+
+    /* Coste por mensaje. */
+    fprintf(stdout, "%-32s %10s %10s\n", "formato", "fmt (ns)",
+            "snprintf");
+    for (id = 0u; id < LOG_N_FORMATS; id++) {
+        const char *f = log_fmt[id];
+        char name[40];
+        uint32_t k;
+
+        t0 = now_ns();
+        for (k = 0u; k < reps; k++) {
+            char *end = fmt_line(buf, sizeof buf, f, arg_ms[k & 3u], k);
+
+            sink += (uint32_t)(end - buf) + (uint8_t)buf[0];
+        }
+        t_fmt = (now_ns() - t0) / reps;
+
+        t0 = now_ns();
+        for (k = 0u; k < reps; k++) {
+            sink += (uint32_t)snprintf(buf, sizeof buf, f,
+                                       (unsigned)arg_ms[k & 3u],
+                                       (unsigned)k) + (uint8_t)buf[0];
+        }
+        t_printf = (now_ns() - t0) / reps;
+
+        /* Nombre: el formato sin el salto de línea. */
+        snprintf(name, sizeof name, "%.*s", (int)strcspn(f, "\r\n"), f);
+        fprintf(stdout, "%-32s %10.1f %10.1f\n", name, t_fmt, t_printf);
+    }
+
+    /* uint64_t: "%llu" frente a fmt_u64 (ticks de 64 bits). */
+    {
+        uint64_t v[256];
+        uint32_t k;
+
+        for (k = 0u; k < 256u; k++) {
+            v[k] = rand_bits(64u);
+        }
+        t0 = now_ns();
+        for (k = 0u; k < reps; k++) {
+            char *end = fmt_u64(buf, v[k & 255u]);
+
+            sink += (uint32_t)(end - buf) + (uint8_t)buf[0];
+        }
+        t_fmt = (now_ns() - t0) / reps;
+        t0 = now_ns();
+        for (k = 0u; k < reps; k++) {
+            sink += (uint32_t)snprintf(buf, sizeof buf, "%llu",
+                                       (unsigned long long)v[k & 255u]) +
+                    (uint8_t)buf[0];
+        }
+        t_printf = (now_ns() - t0) / reps;
+        fprintf(stdout, "%-32s %10.1f %10.1f\n", "%llu (64 bits)", t_fmt,
+                t_printf);
+    }
+
+    (void)sink;
+    fprintf(stdout, "%s\n", (bad == 0u) ? "OK" : "FALLO");
+    return (bad == 0u) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/*
+ * fsm_bench: coste por vuelta del bucle de main_final_superloop.c en el
+ * host, con la tabla de fsm.h (FSM_TABLE=1) o la versión escrita a mano
+ * (FSM_TABLE=0). El simulador no sirve para esto: solo cobra las llamadas
+ * al HAL, que son las mismas en las dos versiones.
+ *
+ *   gcc -O2 -Isim -I. -DFSM_TABLE=1 -DSCHED=0 -Dmain=app_main \
+ *       tools/fsm_bench.c main_final_superloop.c fsm.c log.c \
+ *       -o fsm_bench_tabla
+ *   gcc -O2 -Isim -I. -DFSM_TABLE=0 -Dmain=app_main tools/fsm_bench.c \
+ *       main_final_superloop.c log.c gpio_out.c -o fsm_bench_mano
+ *   fsm_bench_tabla; fsm_bench_mano
+ *
+ * El HAL es mínimo: el reloj avanza BENCH_TICKS por vuelta y las entradas
+ * repiten el guion 'tipico' del simulador. El resultado incluye el coste
+ * de las funciones del HAL, igual en ambos casos. La tabla se mide en el
+ * super-loop (SCHED=0): con el planificador, el muestreo ya no va en
+ * cada vuelta.
+ *
+ * Ojo: la versión a mano escribe los LEDs por gpio_out.h (sombra del
+ * puerto, con sus AMO, y gpio_out_flush) y la tabla escribe el puerto
+ * con gpio_write, así que la comparación ya no es de igual a igual: la
+ * diferencia incluye el coste de la sombra, no solo el de la tabla.
+ */
+#include <setjmp.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "gpio_drv.h"
+#include "riscv_monotonic_clock.h"
+#include "riscv_uart.h"
+#include "clinc.h"
+
+#undef main
+
+#ifndef FSM_TABLE
+#define FSM_TABLE  (1)
+#endif
+
+#define N_ITERS      (50000000u)
+#define BENCH_TICKS  (5u)           /* 0,5 us por vuelta a 10 MHz.     */
+#define MS(x)        ((uint64_t)(x) * (CLINT_CLOCK / 1000u))
+
+int app_main(void);
+
+/* Guion de entradas (se repite cada 7 s). */
+static const struct {
+    uint64_t t;
+    uint32_t pins;
+} script[] = {
+    { MS(200),  PBT_0_MASK },
+    { MS(500),  0u },
+    { MS(1000), PBT_0_MASK },
+    { MS(2500), 0u },
+    { MS(4000), PBT_0_MASK },
+    { MS(4200), 0u },
+    { MS(5000), PBT_1_MASK },
+    { MS(5100), 0u },
+    { MS(6000), PBT_0_MASK },
+    { MS(6050), 0u },
+};
+
+#define N_SCRIPT  (sizeof(script) / sizeof(script[0]))
+#define PERIOD    MS(7000)
+
+static uint64_t ticks;
+static uint64_t t_base;
+static unsigned idx;
+static uint32_t pins;
+static uint32_t iters;
+static uint32_t writes;
+static jmp_buf  done;
+
+/* ------------------------------------------------------------------ */
+/* HAL mínimo                                                          */
+/* ------------------------------------------------------------------ */
+void gpio_set_direction(uint32_t direction)
+{
+    (void)direction;
+}
+
+void gpio_write(uint32_t output)
+{
+    (void)output;
+    writes++;
+}
+
+uint32_t gpio_read(void)
+{
+    if (++iters > N_ITERS) {
+        longjmp(done, 1);
+    }
+    while ((t_base + script[idx].t) <= ticks) {
+        pins = script[idx].pins;
+        if (++idx == N_SCRIPT) {
+            idx = 0u;
+            t_base += PERIOD;
+        }
+    }
+    return pins;
+}
+
+void gpio_irq_enable(uint32_t mask)
+{
+    (void)mask;
+}
+
+void gpio_irq_disable(uint32_t mask)
+{
+    (void)mask;
+}
+
+uint64_t get_ticks_from_reset(void)
+{
+    ticks += BENCH_TICKS;
+    return ticks;
+}
+
+int riscv_uart_tx_ready(void)
+{
+    return 1;
+}
+
+void riscv_uart_putc(uint8_t c)
+{
+    (void)c;
+}
+
+/* ------------------------------------------------------------------ */
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+int main(void)
+{
+    double t0, t1;
+
+    t0 = now_ns();
+    if (setjmp(done) == 0) {
+        (void)app_main();
+    }
+    t1 = now_ns();
+
+    printf("%s: %u vueltas, %.2f ns/vuelta, %u gpio_write\n",
+           FSM_TABLE ? "tabla" : "a mano", (unsigned)N_ITERS,
+           (t1 - t0) / N_ITERS, (unsigned)writes);
+    return 0;
+}
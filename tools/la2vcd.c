@@ -0,0 +1,189 @@
+/*
+ * la2vcd: convierte un volcado del analizador lógico (lacap.h) en un
+ * fichero VCD para GTKWave, PulseView, ...
+ *
+ *   gcc -O2 -Isim -I. tools/la2vcd.c -o la2vcd
+ *   logdec < captura.bin | la2vcd > captura.vcd
+ *   sim_final_interrupt -v rafaga | la2vcd > captura.vcd
+ *
+ * Lee líneas de texto y usa las que contienen "[cap] " (sirve tanto la
+ * salida de logdec como la traza del simulador, con su marca de tiempo
+ * delante); el resto se ignora. Si hay varios volcados, convierte el
+ * último completo. Una señal por cada bit que cambia en la captura o
+ * está a 1 al principio: pbt0-3 (bits 4-7), led0-3 (bits 16-19) y gpioN
+ * para los demás. Unidad de tiempo: un tick de mtime (100 ns a 10 MHz).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "riscv_types.h"
+#include "clinc.h"
+
+#define LA_MAX_BYTES  (65536u)
+
+typedef struct {
+    uint32_t period;                    /* Ticks por muestra.            */
+    uint32_t len;                       /* Bytes anunciados.             */
+    uint64_t t0;                        /* Primera muestra, en ticks.    */
+    uint32_t v0;
+    uint32_t samples;
+    uint32_t lost;
+    uint32_t got;                       /* Bytes recibidos.              */
+    uint8_t  buf[LA_MAX_BYTES];
+} la_dump_t;
+
+static la_dump_t cur;
+static la_dump_t done;
+static int have_done = 0;
+
+/* Una línea de texto; devuelve 0 si no es del volcado o no se entiende. */
+static int parse_line(const char *line)
+{
+    const char *p = strstr(line, "[cap] ");
+    unsigned a, b;
+
+    if (p == NULL) {
+        return 0;
+    }
+    if (sscanf(p, "[cap] periodo %u ticks, %u bytes", &a, &b) == 2) {
+        memset(&cur, 0, sizeof cur);
+        cur.period = a;
+        cur.len = (b <= LA_MAX_BYTES) ? b : LA_MAX_BYTES;
+    } else if (sscanf(p, "[cap] inicio %u ms + %u ticks", &a, &b) == 2) {
+        cur.t0 = (uint64_t)a * (CLINT_CLOCK / 1000u) + b;
+    } else if (sscanf(p, "[cap] puerto %u, %u muestras", &a, &b) == 2) {
+        cur.v0 = a;
+        cur.samples = b;
+    } else if (sscanf(p, "[cap] fin: %u perdidos", &a) == 1) {
+        cur.lost = a;
+        done = cur;
+        have_done = 1;
+    } else if (sscanf(p, "[cap] %u: %u", &a, &b) == 2) {
+        unsigned i;
+
+        for (i = 0u; (i < 4u) && ((a + i) < cur.len); i++) {
+            cur.buf[a + i] = (uint8_t)(b >> (8u * i));
+        }
+        if ((a + 4u) > cur.got) {
+            cur.got = a + 4u;
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+/* LEB128 sin signo; devuelve 0 si el campo queda incompleto. */
+static int get_leb(const la_dump_t *d, uint32_t *off, uint32_t *v)
+{
+    uint32_t r = 0u;
+    unsigned shift = 0u;
+
+    while (*off < d->len) {
+        uint8_t c = d->buf[(*off)++];
+
+        r |= (uint32_t)(c & 0x7Fu) << shift;
+        if ((c & 0x80u) == 0u) {
+            *v = r;
+            return 1;
+        }
+        shift += 7u;
+        if (shift > 28u) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static void signal_name(unsigned bit, char *name, size_t size)
+{
+    if ((bit >= 4u) && (bit <= 7u)) {
+        snprintf(name, size, "pbt%u", bit - 4u);
+    } else if ((bit >= 16u) && (bit <= 19u)) {
+        snprintf(name, size, "led%u", bit - 16u);
+    } else {
+        snprintf(name, size, "gpio%u", bit);
+    }
+}
+
+static void vcd_write(const la_dump_t *d, FILE *out)
+{
+    uint32_t used = d->v0;
+    uint32_t off = 0u, run, x, v;
+    uint64_t idx = 0u;
+    unsigned bit;
+
+    /* Bits que cambian en algún registro. */
+    while (get_leb(d, &off, &run) && get_leb(d, &off, &x)) {
+        used |= x;
+    }
+
+    fprintf(out, "$date %llu ticks $end\n", (unsigned long long)d->t0);
+    fprintf(out, "$timescale 100 ns $end\n");
+    fprintf(out, "$scope module gpio $end\n");
+    for (bit = 0u; bit < 32u; bit++) {
+        if (used & (1u << bit)) {
+            char name[16];
+
+            signal_name(bit, name, sizeof name);
+            fprintf(out, "$var wire 1 %c %s $end\n", '!' + bit, name);
+        }
+    }
+    fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+    fprintf(out, "#%llu\n$dumpvars\n", (unsigned long long)d->t0);
+    for (bit = 0u; bit < 32u; bit++) {
+        if (used & (1u << bit)) {
+            fprintf(out, "%u%c\n", (d->v0 >> bit) & 1u, '!' + bit);
+        }
+    }
+    fprintf(out, "$end\n");
+
+    v = d->v0;
+    off = 0u;
+    while (get_leb(d, &off, &run) && get_leb(d, &off, &x)) {
+        idx += run;
+        if (x == 0u) {
+            continue;
+        }
+        v ^= x;
+        fprintf(out, "#%llu\n",
+                (unsigned long long)(d->t0 + idx * d->period));
+        for (bit = 0u; bit < 32u; bit++) {
+            if (x & (1u << bit)) {
+                fprintf(out, "%u%c\n", (v >> bit) & 1u, '!' + bit);
+            }
+        }
+    }
+    fprintf(out, "#%llu\n", (unsigned long long)(d->t0 +
+            (uint64_t)d->samples * d->period));
+
+    if (off != d->len) {
+        fprintf(stderr, "la2vcd: registro incompleto en el byte %u\n",
+                (unsigned)off);
+    }
+    if (d->lost != 0u) {
+        fprintf(stderr, "la2vcd: %u cambios perdidos (búfer lleno)\n",
+                (unsigned)d->lost);
+    }
+}
+
+int main(void)
+{
+    char line[256];
+
+    while (fgets(line, sizeof line, stdin) != NULL) {
+        (void)parse_line(line);
+    }
+    if (!have_done) {
+        fprintf(stderr, "la2vcd: no hay ningún volcado completo\n");
+        return 1;
+    }
+    if (done.got < done.len) {
+        fprintf(stderr, "la2vcd: faltan datos (%u de %u bytes)\n",
+                (unsigned)done.got, (unsigned)done.len);
+    }
+    vcd_write(&done, stdout);
+    return 0;
+}
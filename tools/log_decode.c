@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "log_decode.h"
+#include "log_fmt.h"
+
+#define LOG_FMT_STR(id, fmt)  fmt,
+
+static const char *const log_fmt[LOG_N_FORMATS] = {
+    LOG_FORMATS(LOG_FMT_STR)
+};
+
+void log_decoder_init(log_decoder_t *d)
+{
+    memset(d, 0, sizeof *d);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int log_emit(log_decoder_t *d, char *line, size_t size)
+{
+    uint32_t a0 = (d->nargs > 0u) ? get_u32(&d->raw[0]) : 0u;
+    uint32_t a1 = (d->nargs > 1u) ? get_u32(&d->raw[4]) : 0u;
+    int n;
+
+    d->state = 0u;
+    if (d->id == LOG_DROPPED) {
+        d->dropped += a0;
+    }
+    n = snprintf(line, size, log_fmt[d->id], (unsigned)a0, (unsigned)a1);
+    if (n < 0) {
+        return 0;
+    }
+    return ((size_t)n < size) ? n : (int)(size - 1u);
+}
+
+int log_decode_byte(log_decoder_t *d, uint8_t b, char *line, size_t size)
+{
+    switch (d->state) {
+    case 0u:
+        if (b == LOG_SYNC) {
+            d->state = 1u;
+        }
+        return 0;
+
+    case 1u:
+        if (b >= LOG_N_FORMATS) {
+            d->bad++;
+            d->state = 0u;
+            return 0;
+        }
+        d->id = b;
+        d->state = 2u;
+        return 0;
+
+    case 2u:
+        if (b > LOG_MAX_ARGS) {
+            d->bad++;
+            d->state = 0u;
+            return 0;
+        }
+        d->nargs = b;
+        d->pos = 0u;
+        d->state = 3u;
+        if (b == 0u) {
+            return log_emit(d, line, size);
+        }
+        return 0;
+
+    default:
+        d->raw[d->pos++] = b;
+        if (d->pos == 4u * d->nargs) {
+            return log_emit(d, line, size);
+        }
+        return 0;
+    }
+}
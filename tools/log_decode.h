@@ -0,0 +1,27 @@
+/*
+ * Decodificador de host de las tramas del registro diferido (log.h).
+ * Lo usan tools/logdec.c y el simulador (sim/).
+ */
+#ifndef LOG_DECODE_H
+#define LOG_DECODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t  state;       /* 0: buscando LOG_SYNC; 1: id; 2: nargs; 3: args */
+    uint8_t  id;
+    uint8_t  nargs;
+    uint8_t  pos;
+    uint8_t  raw[4u * 2u];
+    uint32_t bad;         /* Tramas con id o nargs no válidos.          */
+    uint32_t dropped;     /* Suma de los avisos LOG_DROPPED.            */
+} log_decoder_t;
+
+void log_decoder_init(log_decoder_t *d);
+
+/* Procesa un byte. Si completa un registro, escribe su texto en line
+ * (terminado en '\0') y devuelve su longitud; si no, devuelve 0. */
+int log_decode_byte(log_decoder_t *d, uint8_t b, char *line, size_t size);
+
+#endif /* LOG_DECODE_H */
@@ -0,0 +1,30 @@
+/*
+ * logdec: convierte en texto las tramas binarias del registro diferido
+ * (log.h) capturadas de la UART.
+ *
+ *   gcc -O2 -I. tools/logdec.c tools/log_decode.c -o logdec
+ *   logdec < captura.bin
+ */
+#include <stdio.h>
+
+#include "log_decode.h"
+
+int main(void)
+{
+    log_decoder_t d;
+    char line[128];
+    int c;
+
+    log_decoder_init(&d);
+    while ((c = getchar()) != EOF) {
+        if (log_decode_byte(&d, (uint8_t)c, line, sizeof line) > 0) {
+            fputs(line, stdout);
+        }
+    }
+
+    if ((d.bad != 0u) || (d.dropped != 0u)) {
+        fprintf(stderr, "logdec: %u tramas no válidas, %u registros "
+                "perdidos\n", (unsigned)d.bad, (unsigned)d.dropped);
+    }
+    return 0;
+}
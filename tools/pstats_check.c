@@ -0,0 +1,155 @@
+/*
+ * pstats_check: compara pstats.c con los valores exactos (muestras
+ * guardadas y ordenadas, media y desviación en double) para varias
+ * distribuciones de duración de pulsación, y mide el coste por muestra.
+ *
+ *   gcc -O2 -I. -Isim -Itools tools/pstats_check.c pstats.c \
+ *       -o pstats_check -lm
+ *   pstats_check [muestras]
+ *
+ * Devuelve 0 si todas las medias y desviaciones están a 1 ms o menos y
+ * los cuantiles P² dentro del 6 % del valor exacto + 2 ms. En las colas
+ * (p99 con colas largas) P² en double también se desvía un 4-5 % según
+ * la semilla; la versión en coma fija sigue a la de double a pocos ms.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "pstats.h"
+
+#define N_DIST  (4u)
+
+static const char *const dist_name[N_DIST] = {
+    "uniforme 50..2000", "lognormal (med 300)", "bimodal 120/1500",
+    "exponencial (med 400)"
+};
+
+static uint32_t rng = 0x2545F491u;
+
+static double urand(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return ((double)rng + 0.5) / 4294967296.0;
+}
+
+static double nrand(void)
+{
+    return sqrt(-2.0 * log(urand())) * cos(6.283185307179586 * urand());
+}
+
+static uint32_t sample(uint8_t d)
+{
+    double v;
+
+    if (d == 0u) {
+        v = 50.0 + 1950.0 * urand();
+    } else if (d == 1u) {
+        v = 300.0 * exp(0.6 * nrand());
+    } else if (d == 2u) {
+        v = (urand() < 0.8) ? (120.0 + 25.0 * nrand()) :
+                              (1500.0 + 200.0 * nrand());
+    } else {
+        v = -400.0 * log(urand());
+    }
+    return (v < 0.0) ? 0u : (uint32_t)v;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Cuantil exacto por rango más cercano. */
+static uint32_t exact_q(const uint32_t *v, uint32_t n, double p)
+{
+    uint32_t r = (uint32_t)ceil(p * n);
+
+    return v[(r == 0u) ? 0u : (r - 1u)];
+}
+
+int main(int argc, char **argv)
+{
+    static const double pq[PSTATS_N_Q] = { 0.50, 0.95, 0.99 };
+    uint32_t n = (argc > 1) ? (uint32_t)atoi(argv[1]) : 10000u;
+    uint32_t *v = malloc(sizeof(uint32_t) * n);
+    int bad = 0;
+    uint8_t d, j;
+    uint32_t i;
+
+    if ((v == NULL) || (n < 2u)) {
+        return 2;
+    }
+
+    fprintf(stdout, "RAM: %u bytes por botón, %u muestras por botón\n",
+            (unsigned)sizeof(pstats_t), (unsigned)n);
+
+    pstats_reset();
+    for (d = 0u; d < N_DIST; d++) {
+        double sum = 0.0, sq = 0.0, mean, sd;
+
+        for (i = 0u; i < n; i++) {
+            v[i] = sample(d);
+            pstats_add(d, v[i]);
+            sum += v[i];
+        }
+        mean = sum / n;
+        for (i = 0u; i < n; i++) {
+            sq += (v[i] - mean) * (v[i] - mean);
+        }
+        sd = sqrt(sq / (n - 1u));
+        qsort(v, n, sizeof(uint32_t), cmp_u32);
+
+        fprintf(stdout, "%s\n", dist_name[d]);
+        fprintf(stdout, "  n %u min %u/%u max %u/%u\n",
+                (unsigned)pstats_get(d)->n,
+                (unsigned)pstats_get(d)->min, (unsigned)v[0],
+                (unsigned)pstats_get(d)->max, (unsigned)v[n - 1u]);
+        fprintf(stdout, "  media %u (exacta %.1f)  desv %u (exacta %.1f)\n",
+                (unsigned)pstats_mean(d), mean,
+                (unsigned)pstats_stddev(d), sd);
+        if ((fabs(pstats_mean(d) - mean) > 1.0) ||
+            (fabs(pstats_stddev(d) - sd) > 1.0)) {
+            bad = 1;
+        }
+        for (j = 0u; j < PSTATS_N_Q; j++) {
+            uint32_t est = pstats_quantile(d, j);
+            uint32_t ex = exact_q(v, n, pq[j]);
+            double err = (double)est - (double)ex;
+
+            fprintf(stdout, "  p%-2u %5u (exacto %5u, error %+6.1f ms, "
+                    "%+.2f%%)\n", (unsigned)(pq[j] * 100.0 + 0.5),
+                    (unsigned)est, (unsigned)ex, err,
+                    100.0 * err / (double)ex);
+            if (fabs(err) > 0.06 * (double)ex + 2.0) {
+                bad = 1;
+            }
+        }
+    }
+
+    /* Coste por muestra (host). */
+    {
+        struct timespec t0, t1;
+        uint32_t reps = 2000000u;
+        double ns;
+
+        pstats_reset();
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (i = 0u; i < reps; i++) {
+            pstats_add((uint8_t)(i & 3u), v[(i * 2654435761u) % n]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        ns = ((double)(t1.tv_sec - t0.tv_sec) * 1e9 +
+              (double)(t1.tv_nsec - t0.tv_nsec)) / reps;
+        fprintf(stdout, "coste: %.1f ns por muestra (host)\n", ns);
+    }
+
+    free(v);
+    fprintf(stdout, "%s\n", bad ? "FALLO" : "OK");
+    return bad;
+}
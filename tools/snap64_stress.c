@@ -0,0 +1,144 @@
+/*
+ * snap64_stress: prueba de esfuerzo de snap64.h en el simulador (sim/).
+ *
+ * La ISR del timer resta STEP a un contador de 64 bits (y lo publica
+ * también en un seq64_t) cada GAP ticks; STEP hace que la palabra baja
+ * desborde cada pocas IRQ. main lee sin parar con tres métodos; entre
+ * cada carga de 32 bits SNAP64_HOOK() avanza el reloj virtual, de modo
+ * que la IRQ cae en todas las fases posibles de la lectura, también
+ * justo entre las dos mitades.
+ *
+ * Entre lecturas se espera un número pseudoaleatorio de ticks para que
+ * la IRQ no caiga siempre en la misma fase.
+ *
+ * Una lectura es válida si es C0 - k * STEP con k entre el número de IRQ
+ * antes y después de leer. La lectura ingenua (baja y luego alta) debe
+ * dar lecturas rotas; snap64_read() y seq64_read(), ninguna.
+ *
+ *   gcc -O2 -Isim -I. -Itools tools/snap64_stress.c sim/sim_hal.c \
+ *       tools/log_decode.c log.c -o snap64_stress -lm -lpthread
+ *   snap64_stress [segundos]
+ *
+ * Devuelve 0 si ni snap64_read() ni seq64_read() han dado lecturas rotas.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim_hal.h"
+
+#include "clinc.h"
+#include "dispatch.h"
+
+#define SNAP64_HOOK()  sim_advance(1u)
+#include "snap64.h"
+
+#define C0     (0xFFFFFFF000000000ull)
+#define STEP   (0x0000000040000003ull)
+#define GAP    (23u)                    /* Ticks entre IRQ.               */
+
+enum { M_NAIVE, M_SNAP64, M_SEQ64, M_N };
+
+static const char *const method_name[M_N] = {
+    "ingenua (baja, alta)", "snap64_read", "seq64_read"
+};
+
+static volatile uint64_t counter;
+static seq64_t           counter_seq;
+static volatile uint32_t isr_n;
+
+static uint8_t  method;
+static uint64_t reads;
+static uint64_t hit;                    /* Lecturas con IRQ en medio.    */
+static uint64_t torn;
+
+static uint32_t rng = 0x12345678u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void timer_isr(void)
+{
+    uint64_t v = counter - STEP;
+
+    counter = v;
+    seq64_write(&counter_seq, v);
+    isr_n++;
+}
+
+static uint64_t read_naive(const volatile uint64_t *p)
+{
+    uint32_t lo, hi;
+
+    lo = SNAP64_LO(p);
+    SNAP64_HOOK();
+    hi = SNAP64_HI(p);
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static int stress_app(void)
+{
+    counter = C0;
+    seq64_write(&counter_seq, C0);
+    isr_n = 0u;
+
+    install_local_timer_handler(timer_isr);
+    local_timer_set_gap(GAP);
+    enable_timer_clinc_irq();
+    enable_irq();
+
+    for (;;) {
+        uint32_t k0 = isr_n;
+        uint64_t v, d;
+        uint32_t k1;
+
+        if (method == M_NAIVE) {
+            v = read_naive(&counter);
+        } else if (method == M_SNAP64) {
+            v = snap64_read(&counter);
+        } else {
+            v = seq64_read(&counter_seq);
+        }
+        k1 = isr_n;
+
+        d = C0 - v;
+        reads++;
+        if (k1 != k0) {
+            hit++;
+        }
+        if (((d % STEP) != 0u) || ((d / STEP) < k0) || ((d / STEP) > k1)) {
+            torn++;
+        }
+        sim_advance(1u + (xorshift32() & 7u));
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static sim_ctx_t ctx;
+    static const sim_event_t none[] = { { 0u, 0u } };
+    double secs = (argc > 1) ? atof(argv[1]) : 2.0;
+    int bad = 0;
+
+    for (method = 0u; method < M_N; method++) {
+        reads = 0u;
+        hit = 0u;
+        torn = 0u;
+        sim_init(&ctx, none, 1u, (uint64_t)(secs * CLINT_CLOCK));
+        sim_run(&ctx, stress_app);
+
+        fprintf(stdout, "%-20s: %llu lecturas, %llu con IRQ en medio, "
+                "%llu rotas\n",
+                method_name[method], (unsigned long long)reads,
+                (unsigned long long)hit, (unsigned long long)torn);
+        if ((method != M_NAIVE) && (torn != 0u)) {
+            bad = 1;
+        }
+    }
+    return bad;
+}
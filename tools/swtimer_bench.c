@@ -0,0 +1,131 @@
+/*
+ * swtimer_bench: coste por paso de la rueda de swtimer.h frente al
+ * recorrido lineal de plazos (un if por temporizador y vuelta, como
+ * blink_last/blink_accum en las variantes), con 1, 16 y 256
+ * temporizadores periódicos activos.
+ *
+ *   gcc -O2 -Isim -I. tools/swtimer_bench.c swtimer.c -o swtimer_bench
+ *   swtimer_bench
+ *
+ * Los periodos son pseudoaleatorios y los mismos en ambos métodos, en dos
+ * rangos: 1..1000 pasos (muchos vencimientos: incluye el coste de los
+ * callbacks) y 10^6..2*10^6 (casi ninguno: solo la gestión por paso). Se
+ * comprueba que los dos métodos ejecutan los mismos callbacks.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "swtimer.h"
+
+#define N_TICKS    (4000000u)
+#define MAX_TIMERS (256u)
+
+static uint32_t rng = 0x12345678u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint32_t period[MAX_TIMERS];
+static uint64_t fired;
+
+static void on_expire(void *arg)
+{
+    (void)arg;
+    fired++;
+}
+
+/* Recorrido lineal: un plazo por temporizador. */
+static uint32_t deadline[MAX_TIMERS];
+
+static void linear_tick(uint32_t now, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        if (deadline[i] == now) {
+            deadline[i] = now + period[i];
+            on_expire(NULL);
+        }
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Mide n temporizadores con periodos p_min..p_min+p_span-1; devuelve 1
+ * si los dos métodos no coinciden. */
+static int bench(unsigned n, uint32_t p_min, uint32_t p_span)
+{
+    static swtimer_wheel_t wheel;
+    static swtimer_t tmr[MAX_TIMERS];
+    uint64_t fired_wheel, fired_linear;
+    double t0, t1, t2;
+    uint32_t k;
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        period[i] = p_min + (xorshift32() % p_span);
+    }
+
+    swtimer_wheel_init(&wheel, 0u);
+    for (i = 0; i < n; i++) {
+        swtimer_init(&tmr[i], on_expire, NULL);
+        swtimer_start(&wheel, &tmr[i], period[i], period[i]);
+        deadline[i] = period[i];
+    }
+
+    fired = 0u;
+    t0 = now_ns();
+    for (k = 0; k < N_TICKS; k++) {
+        swtimer_tick(&wheel);
+    }
+    t1 = now_ns();
+    fired_wheel = fired;
+
+    fired = 0u;
+    for (k = 1; k <= N_TICKS; k++) {
+        linear_tick(k, n);
+    }
+    t2 = now_ns();
+    fired_linear = fired;
+
+    printf("%6u  %15.2f  %16.2f  %llu\n", n,
+           (t1 - t0) / N_TICKS, (t2 - t1) / N_TICKS,
+           (unsigned long long)fired_wheel);
+    if (fired_wheel != fired_linear) {
+        printf("  distinto número de vencimientos: %llu / %llu\n",
+               (unsigned long long)fired_wheel,
+               (unsigned long long)fired_linear);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const unsigned counts[] = { 1u, 16u, 256u };
+    static const uint32_t p_min[] = { 1u, 1000000u };
+    static const uint32_t p_span[] = { 1000u, 1000000u };
+    unsigned c, r;
+    int bad = 0;
+
+    for (r = 0; r < 2u; r++) {
+        printf("periodos %u..%u pasos\n", (unsigned)p_min[r],
+               (unsigned)(p_min[r] + p_span[r] - 1u));
+        printf("timers  rueda (ns/paso)  lineal (ns/paso)  vencimientos\n");
+        for (c = 0; c < sizeof counts / sizeof counts[0]; c++) {
+            bad |= bench(counts[c], p_min[r], p_span[r]);
+        }
+    }
+    return bad;
+}
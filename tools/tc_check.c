@@ -0,0 +1,163 @@
+/*
+ * tc_check: comprueba time_conv.h frente a la división exacta y mide el
+ * coste por llamada frente a la división de 64 bits.
+ *
+ *   gcc -O2 -Isim -I. tools/tc_check.c -o tc_check
+ *   gcc -O2 -Isim -I. -DCLINT_CLOCK=32768U tools/tc_check.c -o tc_check
+ *   tc_check [n_aleatorios]
+ *
+ * Casos límite (0, múltiplos de d +-1, potencias de 2 +-1, 2^64 - k) y
+ * n_aleatorios valores (por defecto 10^8) con longitud en bits uniforme.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "time_conv.h"
+
+typedef unsigned __int128 u128;
+
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+static uint64_t xorshift64(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static unsigned long long n_checked = 0;
+static unsigned long long n_bad = 0;
+
+/* Compara con floor(x * num / den) en 128 bits, si cabe en 64. */
+static void check_one(const char *what, uint64_t x, uint64_t got,
+                      uint64_t num, uint64_t den)
+{
+    u128 ref = ((u128)x * num) / den;
+
+    if (ref >> 64) {
+        return;
+    }
+    n_checked++;
+    if ((uint64_t)ref != got) {
+        if (n_bad < 10u) {
+            printf("FALLO %s(%llu) = %llu, esperado %llu\n", what,
+                   (unsigned long long)x, (unsigned long long)got,
+                   (unsigned long long)(uint64_t)ref);
+        }
+        n_bad++;
+    }
+}
+
+static void check(uint64_t x)
+{
+    check_one("ticks_to_ms", x, ticks_to_ms(x), 1000u, CLINT_CLOCK);
+    check_one("ticks_to_us", x, ticks_to_us(x), 1000000u, CLINT_CLOCK);
+    check_one("ms_to_ticks", x, ms_to_ticks(x), CLINT_CLOCK, 1000u);
+}
+
+static void check_edges(void)
+{
+    static const uint64_t d[] = {
+        TC_MS_DEN, TC_US_DEN, TC_MS_NUM, CLINT_CLOCK, 1000u, 1000000u,
+    };
+    unsigned i, b;
+    int k;
+
+    for (i = 0; i < sizeof d / sizeof d[0]; i++) {
+        for (k = 0; k < 4096; k++) {
+            uint64_t m = d[i] * (uint64_t)k;
+
+            check(m - 1u);
+            check(m);
+            check(m + 1u);
+        }
+        /* Múltiplos cerca del máximo. */
+        for (k = 0; k < 4096; k++) {
+            uint64_t m = (UINT64_MAX / d[i] - (uint64_t)k) * d[i];
+
+            check(m - 1u);
+            check(m);
+            check(m + d[i] - 1u);
+        }
+    }
+    for (b = 0; b < 64; b++) {
+        uint64_t p = 1ull << b;
+
+        check(p - 1u);
+        check(p);
+        check(p + 1u);
+    }
+    for (k = 0; k < 65536; k++) {
+        check(UINT64_MAX - (uint64_t)k);
+    }
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Medida: el divisor llega como volatile para que el compilador no la
+ * transforme en multiplicación (así es como compila RV32 la división de
+ * 64 bits hoy). */
+static volatile uint64_t sink;
+
+static void bench(void)
+{
+    enum { N = 20000000 };
+    volatile uint64_t vnum = TC_MS_NUM;
+    volatile uint64_t vden = TC_MS_DEN;
+    uint64_t num = vnum;
+    uint64_t den = vden;
+    uint64_t x = 0x123456789ull;
+    uint64_t acc = 0;
+    double t0, t1, t2;
+    int i;
+
+    t0 = now_ns();
+    for (i = 0; i < N; i++) {
+        acc += (x / den) * num + ((x % den) * num) / den;
+        x += 0x9E3779B97F4Bull;
+    }
+    t1 = now_ns();
+    for (i = 0; i < N; i++) {
+        acc += ticks_to_ms(x);
+        x += 0x9E3779B97F4Bull;
+    }
+    t2 = now_ns();
+    sink = acc;
+
+    printf("división 64 bits : %.2f ns/llamada\n", (t1 - t0) / N);
+    printf("ticks_to_ms      : %.2f ns/llamada\n", (t2 - t1) / N);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long n = 100000000ull;
+    unsigned long long i;
+
+    if (argc > 1) {
+        n = strtoull(argv[1], NULL, 0);
+    }
+
+    printf("CLINT_CLOCK = %u Hz: ms = t*%llu/%llu, us = t*%llu/%llu\n",
+           (unsigned)CLINT_CLOCK,
+           (unsigned long long)TC_MS_NUM, (unsigned long long)TC_MS_DEN,
+           (unsigned long long)TC_US_NUM, (unsigned long long)TC_US_DEN);
+
+    check_edges();
+    for (i = 0; i < n; i++) {
+        uint64_t x = xorshift64();
+
+        check(x >> (xorshift64() & 63u));
+    }
+    printf("%llu comprobaciones, %llu fallos\n", n_checked, n_bad);
+
+    bench();
+    return (n_bad == 0u) ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+/*
+ * tracegen: genera una traza de entradas para el simulador (sim_main.c,
+ * opción -f) con pulsaciones pseudoaleatorias durante el tiempo pedido.
+ *
+ *   gcc -O2 -Isim -I. tools/tracegen.c -o tracegen
+ *   tracegen [segundos] [semilla] > hora.txt
+ *   sim_final_superloop -x -f hora.txt -o salida.txt
+ *
+ * Por defecto, una hora con semilla 1. Entre pulsaciones pasan de 1 a
+ * 60 s. Cada una es de PBT_0 (corta, de 50 a 900 ms, o larga, de 1 a
+ * 3 s, que arranca el parpadeo) o, una de cada cuatro, de PBT_1 (100 ms,
+ * lo detiene). Sin rebotes: los añade el simulador con -r.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "riscv_types.h"
+#include "gpio_drv.h"
+
+static uint32_t rng = 1u;
+
+static uint32_t xorshift32(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Entero uniforme en [lo, hi]. */
+static uint32_t uniform(uint32_t lo, uint32_t hi)
+{
+    return lo + xorshift32() % (hi - lo + 1u);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t end_us = 3600ull * 1000000u;
+    uint64_t t = 0u;
+    unsigned n = 0u;
+
+    if (argc > 1) {
+        end_us = (uint64_t)(atof(argv[1]) * 1e6);
+    }
+    if (argc > 2) {
+        rng = (uint32_t)strtoul(argv[2], NULL, 0);
+        if (rng == 0u) {
+            rng = 1u;
+        }
+    }
+
+    printf("# tracegen: %.0f s, semilla %u\n", (double)end_us * 1e-6,
+           (unsigned)rng);
+    printf("# instante (us) y pines (hex)\n");
+    for (;;) {
+        uint32_t mask, hold_ms;
+
+        t += (uint64_t)uniform(1000u, 60000u) * 1000u;
+        if ((xorshift32() & 3u) == 0u) {
+            mask = PBT_1_MASK;
+            hold_ms = 100u;
+        } else {
+            mask = PBT_0_MASK;
+            hold_ms = (xorshift32() & 1u) ? uniform(50u, 900u) :
+                                            uniform(1000u, 3000u);
+        }
+        if ((t + (uint64_t)hold_ms * 1000u) >= end_us) {
+            break;
+        }
+        printf("%llu %x\n", (unsigned long long)t, (unsigned)mask);
+        t += (uint64_t)hold_ms * 1000u;
+        printf("%llu 0\n", (unsigned long long)t);
+        n++;
+    }
+    fprintf(stderr, "tracegen: %u pulsaciones\n", n);
+    return 0;
+}